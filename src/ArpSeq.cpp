@@ -20,9 +20,11 @@
 #include "vgLib-2.0/constants.h"
 // 
 #include "vgLib-2.0/components/VoxglitchComponents.hpp"
+#include "vgLib-2.0/widgets/RetainedLayer.hpp"
 #include "vgLib-2.0/dsp/Quantizer.hpp"
 #include "vgLib-2.0/dsp/SlewLimiter.hpp"
 #include "vgLib-2.0/dsp/SampleAndHold.hpp"
+#include "vgLib-2.0/dsp/ClockTracker.hpp"
 #include "vgLib-2.0/dsp/ClockModifier.hpp"
 #include "vgLib-2.0/dsp/ClockDivider.hpp"
 #include "vgLib-2.0/sequencer/VoltageSequencerHistory.hpp"
@@ -46,6 +46,7 @@ struct ArpSeq : Module
     Quantizer transpose_quantizer;
     SampleAndHold sample_and_hold;
     ClockDivider clock_divider;
+    ClockTracker clock_tracker;
     ClockModifier clock_modifier;
     ArpSequencer arp_sequencer;
     SlewLimiter mod_1_slew_limiter;
@@ -73,7 +74,6 @@ struct ArpSeq : Module
     float shape_attenuverter_range = 5.0;
 
     // double gate_length_ms = 0.01;
-    double time_before = 0.0;
     double time_now = 0.0;
     double time_of_last_clock = 0.0;
     double time_between_clocks_ms = 0.0;
@@ -381,7 +381,6 @@ struct ArpSeq : Module
 
     void process(const ProcessArgs &args) override
     {
-        time_before = time_now;
         time_now += args.sampleTime;
         gate_timer -= args.sampleTime;
 
@@ -441,15 +440,24 @@ struct ArpSeq : Module
         if ((gate_timer <= 0.0) && (gate_lock == false))
             outputs[GATE_OUTPUT].setVoltage(0.0);
 
-        bool clock_triggered = isClockTriggered(time_now);
+        bool clock_triggered = isClockTriggered(time_now, args.sampleTime);
 
         //
-        // Compute the time between clock input pulses
-        // and store it in time_between_clocks_ms
+        // Compute the time between steps and store it in time_between_clocks_ms.
+        // Once the clock tracker has settled on a period, that's used instead
+        // of the last measured interval, so jitter in the clock input doesn't
+        // change the gate lengths.
         //
         if (clock_triggered)
         {
-            time_between_clocks_ms = time_now - time_of_last_clock;
+            if (clock_tracker.getPeriod() > 0.0)
+            {
+                time_between_clocks_ms = getStepDuration();
+            }
+            else
+            {
+                time_between_clocks_ms = time_now - time_of_last_clock;
+            }
             time_of_last_clock = time_now;
         }
 
@@ -751,6 +759,7 @@ struct ArpSeq : Module
         }
 
         arp_sequencer.reset();
+        clock_tracker.resync();
 
         // Set up a (reverse) counter so that the clock input will ignore
         // incoming clock pulses for 1 millisecond after a reset input. This
@@ -1113,16 +1122,32 @@ struct ArpSeq : Module
         return CYCLE_KNOBS + ((page * MAX_SEQUENCER_STEPS) + step_position);
     }
 
-    bool isClockTriggered(double time_now)
+    // The time between steps, worked out from the tracked clock period and
+    // the rate, which divides or multiplies the clock the same way as the
+    // ClockModifier.
+    double getStepDuration()
+    {
+        double period = clock_tracker.getPeriod();
+        int rate_index = rate_model.getRateIndex();
+
+        if (rate_index < 0)
+            return (period * std::max(1, -rate_index));
+
+        return (period / (rate_index + 1));
+    }
+
+    bool isClockTriggered(double time_now, float sample_time)
     {
         // Get the clock and rate control voltage values
         float clock_cv = inputs[CLOCK_INPUT].getVoltage();
         bool step_triggered = step_trigger.process(clock_cv, constants::gate_low_trigger, constants::gate_high_trigger);
         int rate_index = rate_model.getRateIndex();
 
+        clock_tracker.process(sample_time, step_triggered);
+
         if (step_triggered)
         {
-            return (clock_modifier.clock(time_now, rate_index));
+            return (clock_modifier.clock(time_now, rate_index, clock_tracker.getPeriod()));
         }
 
         // Handle clock multiplication
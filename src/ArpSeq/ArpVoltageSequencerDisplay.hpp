@@ -19,6 +19,8 @@ struct ArpVoltageSequencerDisplay : ArpSequencerDisplay
     int previous_control_sequence_column = 0;
     int control_sequence_column = 0;
 
+    RetainedLayer *pattern_layer;
+
     ArpVoltageSequencerDisplay(VoltageSequencer *current_sequencer, SequencerDisplayConfig *cfg)
     {
         this->config = cfg;
@@ -30,6 +32,9 @@ struct ArpVoltageSequencerDisplay : ArpSequencerDisplay
         tooltip = new DigitalSequencerTooltip(cfg);
         
         box.size = Vec(config->draw_area_width, config->draw_area_height);
+
+        pattern_layer = new RetainedLayer(box.size, [this](NVGcontext *vg) { drawPattern(vg); });
+        addChild(pattern_layer);
     }
 
     void drawLayer(const DrawArgs &args, int layer) override
@@ -37,8 +42,6 @@ struct ArpVoltageSequencerDisplay : ArpSequencerDisplay
         if (layer == 1)
         {
             const auto vg = args.vg;
-            float value = 0.0;
-            NVGcolor bar_color;
 
             // Save the drawing context to restore later
             nvgSave(vg);
@@ -48,53 +51,22 @@ struct ArpVoltageSequencerDisplay : ArpSequencerDisplay
                 // Get a pointer to the Voltage Sequencer
                 VoltageSequencer *sequencer = current_sequencer;
 
-                if (sequencer->polarity == VoltageSequencer::BIPOLAR) 
-                {
-                    value = (2.0 * value) - 1.0;
-                    value = clamp(value, 0.0, 1.0);
-                }
+                // The pattern is only drawn again when it changes
+                pattern_layer->update(patternKey());
+                pattern_layer->drawRetained(args);
 
-                //
-                // Display the pattern
-                //
+                // The playhead's column is painted again on top of the cached
+                // pattern, clipped to the column so that the 0-indicator stays
+                // exactly as it was.
+                int column = sequencer->getPlaybackPosition();
 
-                for (int column = 0; column < config->max_sequencer_steps; column++)
+                if (column >= 0 && column < config->max_sequencer_steps)
                 {
-                    value = sequencer->getValue(column);
-
-                    // Draw the background bar
-                    bar_color = bar_background_color;
-                    drawColumnLayer(vg, column, bar_color);
-
-
-                    if (column == sequencer->getPlaybackPosition())
-                    {
-                        bar_color = bar_current_color;
-                    }
-                    else
-                    {
-                        bar_color = bar_default_color;
-                    }
-
-                    // Now draw the rectangle for the bar
-                    // if (value != 0 || sequencer->polarity == VoltageSequencer::BIPOLAR) 
-                    //{
-                        drawColumn(vg, column, value, bar_color);
-                    // }
-                }
-
-                // Draw a horizontal 0-indicator by bi-polar sequencers
-                if (sequencer->polarity == VoltageSequencer::BIPOLAR)
-                {
-                    // This calculation for y takes advance of the fact that all
-                    // ranges that would have the 0-guide visible are symmetric, so
-                    // it will need updating if non-symmetric ranges are added.
-                    double y = config->draw_area_height / 2.0;
-
-                    nvgBeginPath(vg);
-                    nvgRect(vg, 0, y, config->draw_area_width, 1.0);
-                    nvgFillColor(vg, nvgRGBA(0, 0, 0, 90));
-                    nvgFill(vg);
+                    nvgSave(vg);
+                    nvgIntersectScissor(vg, (column * config->bar_width) + (column * config->bar_horizontal_padding), 0, config->bar_width, config->draw_area_height);
+                    drawStep(vg, column, bar_current_color);
+                    drawZeroIndicator(vg);
+                    nvgRestore(vg);
                 }
 
                 // Draw the tooltip
@@ -132,6 +104,76 @@ struct ArpVoltageSequencerDisplay : ArpSequencerDisplay
         }
     }
 
+    // Everything that the cached pattern depends on
+    RetainedLayerKey patternKey()
+    {
+        RetainedLayerKey key;
+
+        for (int column = 0; column < config->max_sequencer_steps; column++)
+        {
+            key.add(current_sequencer->getValue(column));
+        }
+
+        key.add(current_sequencer->getWindowStart());
+        key.add(current_sequencer->getWindowEnd());
+        key.add(current_sequencer->polarity);
+
+        return(key);
+    }
+
+    //
+    // void drawPattern(NVGcontext *vg)
+    //
+    // Draws the pattern without the playhead.  This is what pattern_layer
+    // keeps in its framebuffer.
+    //
+    void drawPattern(NVGcontext *vg)
+    {
+        if (! module) return;
+
+        //
+        // Display the pattern
+        //
+
+        for (int column = 0; column < config->max_sequencer_steps; column++)
+        {
+            drawStep(vg, column, bar_default_color);
+        }
+
+        drawZeroIndicator(vg);
+    }
+
+    void drawStep(NVGcontext *vg, unsigned int column, NVGcolor bar_color)
+    {
+        float value = current_sequencer->getValue(column);
+
+        // Draw the background bar
+        drawColumnLayer(vg, column, bar_background_color);
+
+        // Now draw the rectangle for the bar
+        // if (value != 0 || sequencer->polarity == VoltageSequencer::BIPOLAR) 
+        //{
+            drawColumn(vg, column, value, bar_color);
+        // }
+    }
+
+    void drawZeroIndicator(NVGcontext *vg)
+    {
+        // Draw a horizontal 0-indicator by bi-polar sequencers
+        if (current_sequencer->polarity == VoltageSequencer::BIPOLAR)
+        {
+            // This calculation for y takes advance of the fact that all
+            // ranges that would have the 0-guide visible are symmetric, so
+            // it will need updating if non-symmetric ranges are added.
+            double y = config->draw_area_height / 2.0;
+
+            nvgBeginPath(vg);
+            nvgRect(vg, 0, y, config->draw_area_width, 1.0);
+            nvgFillColor(vg, nvgRGBA(0, 0, 0, 90));
+            nvgFill(vg);
+        }
+    }
+
     void drawColumn(NVGcontext *vg, unsigned int column, float value, NVGcolor color)
     {
         double height = 0.0;
@@ -24,9 +24,10 @@ struct Autobreak : VoxglitchSamplerModule
   // due to changes in the pattern knob or the CV input.  This flag is set
   // to true when the user is actively editing the current pattern.
 
-  double time_counter = 0.0;
+  // The clock input is in eighth notes.  Until two clocks have arrived, the
+  // loop plays at 160 BPM.
+  ClockTracker clock_tracker;
   double bpm = 160;
-  double timer_before = 0;
   bool clock_triggered = false;
   bool ratchet_triggered = false;
 
@@ -39,6 +40,11 @@ struct Autobreak : VoxglitchSamplerModule
   Sample samples[NUMBER_OF_SAMPLES];
   std::string loaded_filenames[NUMBER_OF_SAMPLES] = {""};
 
+  // How many beats long each sample is.  0 uses the beats detected when the
+  // sample was loaded, falling back to 8.  Patches from before beat detection
+  // load as 8.
+  unsigned int beats_per_loop = 0;
+
   dsp::SchmittTrigger resetTrigger;
   dsp::SchmittTrigger clockTrigger;
   dsp::SchmittTrigger ratchetTrigger;
@@ -90,6 +96,12 @@ struct Autobreak : VoxglitchSamplerModule
     configOutput(AUDIO_OUTPUT_RIGHT, "Right Audio Output");
     #endif
 
+    // The playback rate comes from the beat grid found when a sample loads
+    for(unsigned int i = 0; i < NUMBER_OF_SAMPLES; i++)
+    {
+      samples[i].analyze_on_load = true;
+    }
+
     std::fill_n(loaded_filenames, NUMBER_OF_SAMPLES, "[ EMPTY ]");
   }
 
@@ -106,6 +118,8 @@ struct Autobreak : VoxglitchSamplerModule
       json_object_set_new(json_root, ("loaded_sample_path_" + std::to_string(i+1)).c_str(), json_string(samples[i].path.c_str()));
     }
 
+    json_object_set_new(json_root, "beats_per_loop", json_integer(beats_per_loop));
+
     return json_root;
   }
 
@@ -125,6 +139,23 @@ struct Autobreak : VoxglitchSamplerModule
         loaded_filenames[i] = samples[i].filename;
       }
     }
+
+    json_t *beats_per_loop_json = json_object_get(json_root, "beats_per_loop");
+    beats_per_loop = beats_per_loop_json ? json_integer_value(beats_per_loop_json) : 8;
+  }
+
+  // See AutobreakStudio::getBeatsPerLoop
+  unsigned int getBeatsPerLoop(Sample *sample)
+  {
+    if(beats_per_loop > 0) return beats_per_loop;
+    if(sample->analysis.beats > 0) return sample->analysis.beats;
+    return 8;
+  }
+
+  float getLoopOffset(Sample *sample)
+  {
+    if(beats_per_loop > 0 || sample->analysis.beats == 0) return 0.0;
+    return sample->analysis.beat_offset;
   }
 
   float calculate_inputs(int input_index, int knob_index, int attenuator_index, float scale)
@@ -157,19 +188,12 @@ struct Autobreak : VoxglitchSamplerModule
     // Handle BPM detection
     //
 
-    time_counter += 1.0 / args.sampleRate;
+    bool clock_trigger = clockTrigger.process(inputs[CLOCK_INPUT].getVoltage(), constants::gate_low_trigger, constants::gate_high_trigger);
 
-    if (clockTrigger.process(inputs[CLOCK_INPUT].getVoltage(), constants::gate_low_trigger, constants::gate_high_trigger))
-    {
-      if(timer_before != 0)
-      {
-        double elapsed_time = time_counter - timer_before;
-        if(elapsed_time > 0) bpm = 30.0 / elapsed_time;
-      }
+    clock_tracker.process(args.sampleTime, clock_trigger);
+    if(clock_tracker.getPeriod() > 0) bpm = clock_tracker.getBPM(2.0);
 
-      timer_before = time_counter;
-      clock_triggered = true;
-    }
+    if (clock_trigger) clock_triggered = true;
 
     if (ratchetTrigger.process(inputs[RATCHET_INPUT].getVoltage(), constants::gate_low_trigger, constants::gate_high_trigger))
     {
@@ -195,9 +219,9 @@ struct Autobreak : VoxglitchSamplerModule
 
     if (selected_sample->loaded && (selected_sample->size() > 0))
     {
-      // 60.0 is for conversion from minutes to seconds
-      // 8.0 is for 8 beats (2 bars) of loops, which is a typical drum loop length
-      float samples_to_play_per_loop = ((60.0 / bpm) * args.sampleRate) * 8.0;
+      // 60.0 is for conversion from minutes to seconds.  Loops are usually
+      // 8 beats (2 bars), but the sample's beat grid knows better.
+      float samples_to_play_per_loop = ((60.0 / bpm) * args.sampleRate) * getBeatsPerLoop(selected_sample);
 
       actual_playback_position = clamp(actual_playback_position, 0.0, selected_sample->size() - 1);
 
@@ -266,7 +290,8 @@ struct Autobreak : VoxglitchSamplerModule
       }
 
       // Map the theoretical playback position to the actual sample playback position
-      actual_playback_position = ((float) theoretical_playback_position / samples_to_play_per_loop) * selected_sample->size();
+      actual_playback_position = (((float) theoretical_playback_position / samples_to_play_per_loop) * selected_sample->size()) + getLoopOffset(selected_sample);
+      if(actual_playback_position >= selected_sample->size()) actual_playback_position -= selected_sample->size();
     }
   }
 };
@@ -69,5 +69,19 @@ struct AutobreakWidget : VoxglitchSamplerModuleWidget
 		SampleInterpolationMenuItem *sample_interpolation_menu_item = createMenuItem<SampleInterpolationMenuItem>("Interpolation", RIGHT_ARROW);
 		sample_interpolation_menu_item->module = module;
 		menu->addChild(sample_interpolation_menu_item);
+
+		menu->addChild(createIndexSubmenuItem("Beats per loop",
+			{"Detect", "4", "8", "16"},
+			[=]() {
+				for (int i = 1; i < 4; i++)
+				{
+					if (module->beats_per_loop == (2u << i)) return i;
+				}
+				return 0;
+			},
+			[=](int index) {
+				module->beats_per_loop = (index == 0) ? 0 : (2u << index);
+			}
+		));
 	}
 };
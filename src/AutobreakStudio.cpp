@@ -13,12 +13,18 @@
 
 #include "vgLib-2.0/constants.h"
 #include "vgLib-2.0/sample.hpp"
+#include "vgLib-2.0/SamplePlayer.hpp"
+#include "vgLib-2.0/TimeStretcher.hpp"
+#include "vgLib-2.0/DualReadHead.hpp"
 #include "vgLib-2.0/panelHelper.hpp"
 #include "vgLib-2.0/dsp/DeclickFilter.hpp"
 #include "vgLib-2.0/dsp/StereoPan.hpp"
+#include "vgLib-2.0/dsp/ClockTracker.hpp"
 // 
 #include "vgLib-2.0/components/VoxglitchComponents.hpp"
+#include "vgLib-2.0/widgets/RetainedLayer.hpp"
 #include "vgLib-2.0/sequencer/VoltageSequencerHistory.hpp"
+#include "vgLib-2.0/Telemetry.hpp"
 #include "vgLib-2.0/widgets/WaveformModel.hpp"
 #include "vgLib-2.0/widgets/WaveformWidget.hpp"
 
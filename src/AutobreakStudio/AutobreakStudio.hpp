@@ -25,9 +25,10 @@ struct AutobreakStudio : VoxglitchSamplerModule
     // due to changes in the pattern knob or the CV input.  This flag is set
     // to true when the user is actively editing the current pattern.
 
-    double time_counter = 0.0;
+    // The clock input is in eighth notes.  The tracker smooths out jitter in
+    // the clock so that it doesn't wobble the playback speed.
+    ClockTracker clock_tracker;
     double bpm = 0.0;
-    double timer_before = 0;
     bool clock_triggered = false;
     bool ratchet_triggered = false;
     unsigned int ratchet_counter = 0;
@@ -56,8 +57,29 @@ struct AutobreakStudio : VoxglitchSamplerModule
     // float waveform_playback_percentage = 0.0;
 
     Sample samples[NUMBER_OF_SAMPLES];
+    BackgroundSampleLoad sample_loads[NUMBER_OF_SAMPLES];   // Decodes the samples off of the UI thread
     std::string loaded_filenames[NUMBER_OF_SAMPLES] = {""};
 
+    // When on, position jumps land on the nearest transient in the sample
+    // instead of exactly on the 16 step grid
+    bool snap_jumps_to_transients = false;
+
+    // How many beats long each sample is.  0 uses the beats detected when
+    // the sample was loaded, falling back to 8 if none were found.  Patches
+    // from before beat detection load as 8.
+    unsigned int beats_per_loop = 0;
+
+    // When on, the loop is time-stretched to the clock's tempo and keeps its
+    // original pitch.  When off, it's sped up or slowed down, which changes
+    // the pitch along with the tempo.
+    bool time_stretch = false;
+    TimeStretcher time_stretcher;
+
+    // Without time-stretching, the sample is read by two read heads so that
+    // position jumps crossfade over jump_crossfade seconds instead of clicking
+    DualReadHead read_heads;
+    float jump_crossfade = 0.005f;
+
     dsp::SchmittTrigger resetTrigger;
     dsp::SchmittTrigger clockTrigger;
     dsp::SchmittTrigger ratchetTrigger;
@@ -150,6 +172,10 @@ struct AutobreakStudio : VoxglitchSamplerModule
             waveform_model[i].sample = &samples[i];
             waveform_model[i].visible = false;
             waveform_model[i].playhead_position = 0;
+
+            // The beat grid and transients are used for the playback rate
+            // and for snapping jumps
+            samples[i].analyze_on_load = true;
         }
         waveform_model[0].visible = true;
 
@@ -195,6 +221,11 @@ struct AutobreakStudio : VoxglitchSamplerModule
         // Save which memory is selected
         json_object_set(json_root, "selected_memory_index", json_integer(selected_memory_index));
 
+        json_object_set_new(json_root, "snap_jumps_to_transients", json_boolean(snap_jumps_to_transients));
+        json_object_set_new(json_root, "beats_per_loop", json_integer(beats_per_loop));
+        json_object_set_new(json_root, "time_stretch", json_boolean(time_stretch));
+        json_object_set_new(json_root, "jump_crossfade", json_real(jump_crossfade));
+
         return json_root;
     }
 
@@ -224,7 +255,7 @@ struct AutobreakStudio : VoxglitchSamplerModule
             json_t *loaded_sample_path = json_object_get(json_root, ("loaded_sample_path_" + std::to_string(i + 1)).c_str());
             if (loaded_sample_path)
             {
-                samples[i].load(json_string_value(loaded_sample_path));
+                sample_loads[i].load(&samples[i], json_string_value(loaded_sample_path));
                 loaded_filenames[i] = samples[i].filename;
             }
         }
@@ -257,6 +288,21 @@ struct AutobreakStudio : VoxglitchSamplerModule
         json_t *selected_memory_index_json = json_object_get(json_root, "selected_memory_index");
         if (selected_memory_index_json)
             selectMemory(json_integer_value(selected_memory_index_json));
+
+        json_t *snap_jumps_to_transients_json = json_object_get(json_root, "snap_jumps_to_transients");
+        if (snap_jumps_to_transients_json)
+            snap_jumps_to_transients = json_boolean_value(snap_jumps_to_transients_json);
+
+        json_t *beats_per_loop_json = json_object_get(json_root, "beats_per_loop");
+        beats_per_loop = beats_per_loop_json ? json_integer_value(beats_per_loop_json) : 8;
+
+        json_t *time_stretch_json = json_object_get(json_root, "time_stretch");
+        if (time_stretch_json)
+            time_stretch = json_boolean_value(time_stretch_json);
+
+        json_t *jump_crossfade_json = json_object_get(json_root, "jump_crossfade");
+        if (jump_crossfade_json)
+            jump_crossfade = json_number_value(jump_crossfade_json);
     }
 
     void loadSequencer(json_t *memory_slot_json, AutobreakVoltageSequencer *sequencer, std::string sequencer_name)
@@ -382,6 +428,59 @@ struct AutobreakStudio : VoxglitchSamplerModule
         }
     }
 
+    //
+    // getBeatsPerLoop and getLoopOffset
+    //
+    // The loop is _beats_per_loop_ beats long, and starts at the first beat of
+    // the sample's beat grid, which may be a little way in.  Both come from
+    // the sample's analysis unless beats_per_loop has been set by hand.
+    //
+    unsigned int getBeatsPerLoop(Sample *sample)
+    {
+        if (beats_per_loop > 0) return beats_per_loop;
+        if (sample->analysis.beats > 0) return sample->analysis.beats;
+        return 8;
+    }
+
+    float getLoopOffset(Sample *sample)
+    {
+        if (beats_per_loop > 0 || sample->analysis.beats == 0) return 0.0;
+        return sample->analysis.beat_offset;
+    }
+
+    // Maps a position in the theoretical loop to a frame in the sample
+    float getSamplePosition(float theoretical_position, float samples_to_play_per_loop, Sample *sample)
+    {
+        float position = ((theoretical_position / samples_to_play_per_loop) * sample->size()) + getLoopOffset(sample);
+        if (position >= sample->size()) position -= sample->size();
+        return position;
+    }
+
+    //
+    // getJumpPosition
+    //
+    // Returns the theoretical playback position of one of the 16 jump
+    // locations.  With snap_jumps_to_transients on, it moves to the nearest
+    // transient within half a location of the grid, if there is one.
+    //
+    float getJumpPosition(int breakbeat_location, float samples_to_play_per_loop, Sample *sample)
+    {
+        float location_length = samples_to_play_per_loop / 16.0f;
+        float position = breakbeat_location * location_length;
+
+        if (snap_jumps_to_transients && sample->size() > 0)
+        {
+            // The transients are in sample frames, which are stretched over the loop
+            double scale = (double) sample->size() / samples_to_play_per_loop;
+            double snapped = sample->slices.snap(getSamplePosition(position, samples_to_play_per_loop, sample), (location_length / 2.0) * scale);
+
+            position = (snapped - getLoopOffset(sample)) / scale;
+            if (position < 0) position += samples_to_play_per_loop;
+        }
+
+        return position;
+    }
+
     /*
 
     ______
@@ -400,6 +499,11 @@ struct AutobreakStudio : VoxglitchSamplerModule
 
     void process(const ProcessArgs &args) override
     {
+        // Pick up any samples that have finished loading
+        for (unsigned int i = 0; i < NUMBER_OF_SAMPLES; i++)
+        {
+            sample_loads[i].adopt(&samples[i]);
+        }
 
         // Process clear button
         if (clearButtonTrigger.process(params[CLEAR_BUTTON].getValue()))
@@ -536,8 +640,8 @@ struct AutobreakStudio : VoxglitchSamplerModule
                 // Don't step the sequencers ahead until next incoming clock trigger
                 do_not_step_sequencers = true;
 
-                // Don't compute new BPM until there's reasonable amounts of data
-                timer_before = 0.0;
+                // Don't measure the time since the reset as a clock period
+                clock_tracker.resync();
             }
         }
 
@@ -564,19 +668,8 @@ struct AutobreakStudio : VoxglitchSamplerModule
         //
         // Handle BPM detection
         //
-        time_counter += args.sampleTime;
-        if (clock_trigger)
-        {
-            if (timer_before != 0)
-            {
-                // Compute BPM based on incoming clock
-                double elapsed_time = time_counter - timer_before;
-                if (elapsed_time > 0)
-                    bpm = 30.0 / elapsed_time;
-            }
-
-            timer_before = time_counter;
-        }
+        clock_tracker.process(args.sampleTime, clock_trigger);
+        bpm = clock_tracker.getBPM(2.0);
 
         // If BPM hasn't been determined yet, wait until it has to start
         // running the engine.
@@ -622,9 +715,9 @@ struct AutobreakStudio : VoxglitchSamplerModule
             ratchet_counter = 0;
         }
 
-        // 60.0 is for conversion from minutes to seconds
-        // 8.0 is for 8 beats (2 bars) of loops, which is a typical drum loop length
-        float samples_to_play_per_loop = ((60.0 / bpm) * args.sampleRate) * 8.0;
+        // 60.0 is for conversion from minutes to seconds.  Loops are usually
+        // 8 beats (2 bars), but the sample's beat grid knows better.
+        float samples_to_play_per_loop = ((60.0 / bpm) * args.sampleRate) * getBeatsPerLoop(selected_sample);
 
         //
         // Calculate playback position and output sample audio
@@ -639,7 +732,15 @@ struct AutobreakStudio : VoxglitchSamplerModule
             waveform_model[selected_sample_slot].updatePlayheadPosition(actual_playback_position);
 
             // Read the sample
-            selected_sample->read((int)actual_playback_position, &left_output, &right_output);
+            if (time_stretch)
+            {
+                time_stretcher.process(selected_sample, actual_playback_position, selected_sample->getSampleRate() / args.sampleRate, &left_output, &right_output);
+            }
+            else
+            {
+                read_heads.setCrossfadeFrames(jump_crossfade * args.sampleRate);
+                read_heads.process(selected_sample, actual_playback_position, interpolation, &left_output, &right_output);
+            }
 
             // Apply volume to output values
             left_output = getVolume() * left_output;
@@ -692,7 +793,7 @@ struct AutobreakStudio : VoxglitchSamplerModule
 
             if (breakbeat_location != -1)
             {
-                theoretical_playback_position = breakbeat_location * (samples_to_play_per_loop / 16.0f);
+                theoretical_playback_position = getJumpPosition(breakbeat_location, samples_to_play_per_loop, selected_sample);
             }
 
             ratchet_counter = 0;
@@ -707,7 +808,7 @@ struct AutobreakStudio : VoxglitchSamplerModule
 
                 if (breakbeat_location != -1)
                 {
-                    theoretical_playback_position = breakbeat_location * (samples_to_play_per_loop / 16.0f);
+                    theoretical_playback_position = getJumpPosition(breakbeat_location, samples_to_play_per_loop, selected_sample);
                 }
                 ratchet_triggered = false;
             }
@@ -717,20 +818,19 @@ struct AutobreakStudio : VoxglitchSamplerModule
         if (do_not_step_sequencers == true)
             do_not_step_sequencers = false;
 
-        // Loop the theoretical_playback_position
+        // Loop the theoretical_playback_position.  The read heads (or the time
+        // stretcher) see the jump in position and crossfade it.
         if (theoretical_playback_position >= samples_to_play_per_loop)
         {
             theoretical_playback_position = 0;
-            declick_filter.trigger();
         }
         else if (theoretical_playback_position < 0)
         {
             theoretical_playback_position = samples_to_play_per_loop;
-            declick_filter.trigger();
         }
 
         // Map the theoretical playback position to the actual sample playback position
-        actual_playback_position = ((float)theoretical_playback_position / samples_to_play_per_loop) * selected_sample->size();
+        actual_playback_position = getSamplePosition(theoretical_playback_position, samples_to_play_per_loop, selected_sample);
 
         // Output the sequencer values
         outputs[POSITION_CV_OUTPUT].setVoltage(position_sequencer->getValue() * 10.0);
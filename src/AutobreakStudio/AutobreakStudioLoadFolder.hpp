@@ -44,7 +44,7 @@ struct AutobreakStudioLoadFolder : MenuItem
                 {
                     if (i < 8)
                     {
-                        module->samples[i].load(filename);
+                        module->sample_loads[i].load(&module->samples[i], filename);
                         module->loaded_filenames[i] = module->samples[i].filename;
                         module->setRoot(filename);
                         i++;
@@ -29,7 +29,7 @@ struct AutobreakStudioLoadSample : MenuItem
 	{
 		if (filename != "")
 		{
-			module->samples[sample_number].load(filename);
+			module->sample_loads[sample_number].load(&module->samples[sample_number], filename);
 			module->loaded_filenames[sample_number] = module->samples[sample_number].filename;
 			module->setRoot(filename);
 		}
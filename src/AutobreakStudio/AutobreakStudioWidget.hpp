@@ -211,5 +211,36 @@ struct AutobreakStudioWidget : VoxglitchSamplerModuleWidget
 		SampleInterpolationMenuItem *sample_interpolation_menu_item = createMenuItem<SampleInterpolationMenuItem>("Interpolation", RIGHT_ARROW);
 		sample_interpolation_menu_item->module = module;
 		menu->addChild(sample_interpolation_menu_item);
+
+		menu->addChild(createBoolPtrMenuItem("Snap jumps to transients", "", &module->snap_jumps_to_transients));
+		menu->addChild(createBoolPtrMenuItem("Time-stretch (keep pitch)", "", &module->time_stretch));
+
+		menu->addChild(createIndexSubmenuItem("Jump crossfade",
+			{"1 ms", "2 ms", "5 ms", "10 ms", "20 ms"},
+			[=]() {
+				for (int i = 0; i < NUMBER_OF_JUMP_CROSSFADES; i++)
+				{
+					if (module->jump_crossfade == jump_crossfades[i]) return i;
+				}
+				return 2;
+			},
+			[=](int index) {
+				module->jump_crossfade = jump_crossfades[index];
+			}
+		));
+
+		menu->addChild(createIndexSubmenuItem("Beats per loop",
+			{"Detect", "4", "8", "16"},
+			[=]() {
+				for (int i = 1; i < 4; i++)
+				{
+					if (module->beats_per_loop == (2u << i)) return i;
+				}
+				return 0;
+			},
+			[=](int index) {
+				module->beats_per_loop = (index == 0) ? 0 : (2u << index);
+			}
+		));
 	}
 };
@@ -14,6 +14,8 @@ struct VoltageSequencerDisplayABS : SequencerDisplayABS
     int control_sequence_column = 0;
     unsigned int sequencer_type = 0;
 
+    RetainedLayer *pattern_layer;
+
     VoltageSequencerDisplayABS(AutobreakVoltageSequencer **sequencer_instance, unsigned int sequencer_type)
     {
         this->sequencer_ptr_ptr = sequencer_instance;
@@ -24,6 +26,9 @@ struct VoltageSequencerDisplayABS : SequencerDisplayABS
         // which is why 16 is being added to the draw height to define the
         // bounding box.
         box.size = Vec(DRAW_AREA_WIDTH, DRAW_AREA_HEIGHT + 16);
+
+        pattern_layer = new RetainedLayer(Vec(DRAW_AREA_WIDTH, DRAW_AREA_HEIGHT), [this](NVGcontext *vg) { drawPattern(vg); });
+        addChild(pattern_layer);
     }
 
     void drawLayer(const DrawArgs &args, int layer) override
@@ -31,8 +36,6 @@ struct VoltageSequencerDisplayABS : SequencerDisplayABS
         if (layer == 1)
         {
             const auto vg = args.vg;
-            double value;
-            NVGcolor bar_color;
 
             // Save the drawing context to restore later
             nvgSave(vg);
@@ -42,47 +45,22 @@ struct VoltageSequencerDisplayABS : SequencerDisplayABS
                 // Get a pointer to the Voltage Sequencer
                 AutobreakVoltageSequencer *sequencer = *sequencer_ptr_ptr;
 
-                //
-                // Display the pattern
-                //
-                for (unsigned int i = 0; i < MAX_SEQUENCER_STEPS; i++)
-                {
-                    value = sequencer->getValue(i);
-
-                    // Draw grey background bar
-                    if (i < sequencer->getLength())
-                    {
-                        bar_color = brightness(bright_background_color, settings::rackBrightness);
-                    }
-                    else
-                    {
-                        bar_color = brightness(dark_background_color, settings::rackBrightness);
-                    }
-
-                    drawBar(vg, i, BAR_HEIGHT, DRAW_AREA_HEIGHT, bar_color); // background
-
-                    if (i == sequencer->getPlaybackPosition())
-                    {
-                        bar_color = current_step_highlight_color;
-                    }
-                    else if (i < sequencer->getLength())
-                    {
-                        bar_color = lesser_step_highlight_color;
-                    }
-                    else
-                    {
-                        bar_color = default_step_highlight_color;
-                    }
-
-                    // Draw bars for the sequence values
-                    if (value > 0)
-                        drawBar(vg, i, (value * DRAW_AREA_HEIGHT), DRAW_AREA_HEIGHT, bar_color);
+                // The pattern is only drawn again when it changes
+                pattern_layer->update(patternKey());
+                pattern_layer->drawRetained(args);
+
+                // The playhead's column is painted again on top of the cached
+                // pattern, from the background up, and clipped to the column so
+                // that the guides and overlay stay exactly as they were.
+                unsigned int playback_position = sequencer->getPlaybackPosition();
 
-                    // Highlight the sequence playback column
-                    if (i == sequencer->getPlaybackPosition())
-                    {
-                        drawBar(vg, i, DRAW_AREA_HEIGHT, DRAW_AREA_HEIGHT, sequence_position_highlight_color);
-                    }
+                if (playback_position < MAX_SEQUENCER_STEPS)
+                {
+                    nvgSave(vg);
+                    nvgIntersectScissor(vg, (playback_position * bar_width) + (playback_position * BAR_HORIZONTAL_PADDING), 0, bar_width, DRAW_AREA_HEIGHT);
+                    drawStep(vg, playback_position, true);
+                    drawDecorations(vg);
+                    nvgRestore(vg);
                 }
             }
             else // Draw a demo sequence so that the sequencer looks nice in the library selector
@@ -104,17 +82,101 @@ struct VoltageSequencerDisplayABS : SequencerDisplayABS
                     if (i == 3)
                         drawBar(vg, i, DRAW_AREA_HEIGHT, DRAW_AREA_HEIGHT, nvgRGBA(255, 255, 255, 150));
                 }
-            }
 
-            drawVerticalGuildes(vg, DRAW_AREA_HEIGHT, 4);
-            drawOverlay(vg, OVERLAY_WIDTH, DRAW_AREA_HEIGHT);
-            if (draw_horizontal_guide)
-                drawHorizontalGuide(vg);
+                drawDecorations(vg);
+            }
 
             nvgRestore(vg);
         }
     }
 
+    // Everything that the cached pattern depends on
+    RetainedLayerKey patternKey()
+    {
+        AutobreakVoltageSequencer *sequencer = *sequencer_ptr_ptr;
+        RetainedLayerKey key;
+
+        for (unsigned int i = 0; i < MAX_SEQUENCER_STEPS; i++)
+        {
+            key.add(sequencer->getValue(i));
+        }
+
+        key.add(sequencer->getLength());
+        key.add(draw_horizontal_guide);
+        key.add(settings::rackBrightness);
+
+        return(key);
+    }
+
+    //
+    // void drawPattern(NVGcontext *vg)
+    //
+    // Draws the pattern without the playhead.  This is what pattern_layer
+    // keeps in its framebuffer.
+    //
+    void drawPattern(NVGcontext *vg)
+    {
+        if (! module) return;
+
+        for (unsigned int i = 0; i < MAX_SEQUENCER_STEPS; i++)
+        {
+            drawStep(vg, i, false);
+        }
+
+        drawDecorations(vg);
+    }
+
+    void drawStep(NVGcontext *vg, unsigned int i, bool playing)
+    {
+        AutobreakVoltageSequencer *sequencer = *sequencer_ptr_ptr;
+        NVGcolor bar_color;
+        double value = sequencer->getValue(i);
+
+        // Draw grey background bar
+        if (i < sequencer->getLength())
+        {
+            bar_color = brightness(bright_background_color, settings::rackBrightness);
+        }
+        else
+        {
+            bar_color = brightness(dark_background_color, settings::rackBrightness);
+        }
+
+        drawBar(vg, i, BAR_HEIGHT, DRAW_AREA_HEIGHT, bar_color); // background
+
+        if (playing)
+        {
+            bar_color = current_step_highlight_color;
+        }
+        else if (i < sequencer->getLength())
+        {
+            bar_color = lesser_step_highlight_color;
+        }
+        else
+        {
+            bar_color = default_step_highlight_color;
+        }
+
+        // Draw bars for the sequence values
+        if (value > 0)
+            drawBar(vg, i, (value * DRAW_AREA_HEIGHT), DRAW_AREA_HEIGHT, bar_color);
+
+        // Highlight the sequence playback column
+        if (playing)
+        {
+            drawBar(vg, i, DRAW_AREA_HEIGHT, DRAW_AREA_HEIGHT, sequence_position_highlight_color);
+        }
+    }
+
+    // The guides and overlay, which are drawn over every step
+    void drawDecorations(NVGcontext *vg)
+    {
+        drawVerticalGuildes(vg, DRAW_AREA_HEIGHT, 4);
+        drawOverlay(vg, OVERLAY_WIDTH, DRAW_AREA_HEIGHT);
+        if (draw_horizontal_guide)
+            drawHorizontalGuide(vg);
+    }
+
     void drawHorizontalGuide(NVGcontext *vg)
     {
         // This calculation for y takes advance of the fact that all
@@ -26,6 +26,10 @@ const float LCD_TABS_HEIGHT = 20.0;
 const float LCD_TABS_WIDTH = 65.7;
 const float TABS_HORIZONTAL_PADDING = 1.0;
 
+// Choices for the "Jump crossfade" menu, in seconds
+const int NUMBER_OF_JUMP_CROSSFADES = 5;
+const float jump_crossfades[NUMBER_OF_JUMP_CROSSFADES] = {0.001, 0.002, 0.005, 0.010, 0.020};
+
 const float ratchet_divisions[5] = {
     4.0, // 4 == double ratchet
     6.0, // 6 == triplet ratchet
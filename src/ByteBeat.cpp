@@ -15,6 +15,8 @@
 
 #include "vgLib-2.0/constants.h"
 #include "vgLib-2.0/components/VoxglitchComponents.hpp"
+#include "vgLib-2.0/BytebeatExpression.hpp"
+#include "vgLib-2.0/dsp/PolyphaseInterpolator.hpp"
 
 using namespace vgLib_v2;
 
@@ -22,6 +24,7 @@ using namespace vgLib_v2;
 #include "ByteBeat/defines.h"
 #include "ByteBeat/BytebeatSegmentReadoutWidget.hpp"
 #include "ByteBeat/ByteBeat.hpp"
+#include "vgLib-2.0/widgets/ExpressionMenu.hpp"
 #include "ByteBeat/ByteBeatWidget.hpp"
 
 Model* modelByteBeat = createModel<ByteBeat, ByteBeatWidget>("bytebeat");
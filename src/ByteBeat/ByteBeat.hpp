@@ -9,7 +9,7 @@
 //   new knob, input, or output, you'll need to make updates in this document
 //   as well as in ByteBeatWidget.hpp
 // - The main "process" loop, whic reads all the inputs and outputs audio
-// - A "compute" function which contains all of the bytebeat equations
+// - A "computeLanes" function which contains all of the bytebeat equations
 // - A number of "expression" functions which provide more variance for the
 //   equations.
 // - A few helper functions
@@ -20,32 +20,77 @@
 
 struct ByteBeat : Module
 {
-  uint8_t w = 0;     // w is the output of the equations
+  // Every polyphonic channel is a separate voice, with its own t, parameters
+  // and equation.  Channel 0 is what the readouts display.
+
+  uint8_t w[MAX_POLYPHONY] = {};     // w is the output of the equations
   float output = 0;  // output is the audio output
-  uint32_t t;  // t is the time counter used in the equations
+  uint32_t t[MAX_POLYPHONY] = {};  // t is the time counter used in the equations
+  uint32_t equation[MAX_POLYPHONY] = {};
 
   // p1-p3 are variables used in equations.  These are values that the user
   // can manipulate to alter the sounds coming from the equations.
-  uint32_t p1;
-  uint32_t p2;
-  uint32_t p3;
+  uint32_t p1[MAX_POLYPHONY] = {};
+  uint32_t p2[MAX_POLYPHONY] = {};
+  uint32_t p3[MAX_POLYPHONY] = {};
 
   // e1-e3 are sub-expressions to give equations more variance
   uint32_t e1;
   uint32_t e2;
   uint32_t e3;
 
-  // I want to add better pitch control before this module is released.  But
-  // in the short term, I'm simply skipping frames in the compute() function
-  // to feign sample rate.  This won't work for the final version because
-  // different users may have different sample rate settings.
+  unsigned int channels = 1;
+
+  // At the engine's rate, t is advanced by skipping frames, which is how the
+  // original ByteBeat set its pitch.
 
-  uint8_t clock_division_counter = 0;
+  uint8_t clock_division_counter[MAX_POLYPHONY] = {};
   uint8_t clock_division = 2;
 
   std::string param_1_readout = "000";
   std::string param_2_readout = "000";
   std::string param_3_readout = "000";
+  uint32_t readout_p1 = UINT32_MAX;
+  uint32_t readout_p2 = UINT32_MAX;
+  uint32_t readout_p3 = UINT32_MAX;
+
+  // The rate that the equations run at, as an index into VIRTUAL_RATES.  At
+  // index 0 they run at the engine's rate, like the original ByteBeat.
+  unsigned int virtual_rate_index = DEFAULT_VIRTUAL_RATE_INDEX;
+  unsigned int oversampling = 1;
+  unsigned int oversampling_counter[MAX_POLYPHONY] = {};
+  float held_value[MAX_POLYPHONY] = {};
+  PolyphaseInterpolator interpolators[MAX_POLYPHONY];
+
+  // Channels that share an equation are gathered into lanes and computed
+  // together.  See computeLanes().
+  struct Lanes
+  {
+    uint32_t t[MAX_POLYPHONY];
+    uint32_t p1[MAX_POLYPHONY];
+    uint32_t p2[MAX_POLYPHONY];
+    uint32_t p3[MAX_POLYPHONY];
+    uint32_t w[MAX_POLYPHONY];
+    unsigned int channel[MAX_POLYPHONY];
+    unsigned int count = 0;
+  } lanes;
+
+  // The user's own expression, selected by turning the equation knob all the
+  // way up.  Its values are computed a block at a time and cached, since t
+  // usually counts up steadily while p1-p3 stay put.
+  BytebeatExpressionSlot custom_expression;
+  BytebeatInterpreter interpreter;
+
+  struct CustomValues
+  {
+    uint32_t values[BytebeatInterpreter::BLOCK_SIZE];
+    uint32_t start = 0;
+    unsigned int count = 0;
+    uint32_t p1 = 0;
+    uint32_t p2 = 0;
+    uint32_t p3 = 0;
+    uint32_t generation = 0;
+  } custom_values[MAX_POLYPHONY];
 
   enum ParamIds {
     CLOCK_DIVISION_KNOB,
@@ -85,7 +130,7 @@ struct ByteBeat : Module
 	ByteBeat()
 	{
     config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
-    configParam(EQUATION_KNOB, 0.0f, NUMBER_OF_EQUATIONS - 1, 0.0f, "EquationKnob");
+    configParam(EQUATION_KNOB, 0.0f, CUSTOM_EQUATION, 0.0f, "EquationKnob");
     paramQuantities[EQUATION_KNOB]->snapEnabled = true;
 
     configParam(PARAM_KNOB_1, 0.0f, 128.0f, 0.0f, "ParamKnob1");
@@ -113,21 +158,48 @@ struct ByteBeat : Module
     configOutput(AUDIO_OUTPUT, "Audio");
     configOutput(DEBUG_OUTPUT, "Debug");
     #endif
+
+    custom_expression.setExpression(DEFAULT_CUSTOM_EXPRESSION);
 	}
 
 	// Autosave module data.  VCV Rack decides when this should be called.
 	json_t *dataToJson() override
 	{
 		json_t *root = json_object();
+    json_object_set_new(root, "custom_expression", json_string(custom_expression.expression.c_str()));
+    json_object_set_new(root, "virtual_rate_index", json_integer(virtual_rate_index));
+    json_object_set_new(root, "oversampling", json_integer(oversampling));
   	return root;
 	}
 
 	// Load module data
 	void dataFromJson(json_t *root) override
 	{
-    // There's nothing to save and load yet.
+    json_t *custom_expression_json = json_object_get(root, "custom_expression");
+    if(custom_expression_json) custom_expression.setExpression(json_string_value(custom_expression_json));
+
+    // Patches saved before virtual rates existed keep the original sound
+    json_t *virtual_rate_index_json = json_object_get(root, "virtual_rate_index");
+    virtual_rate_index = virtual_rate_index_json ? json_integer_value(virtual_rate_index_json) : 0;
+    if(virtual_rate_index >= NUMBER_OF_VIRTUAL_RATES) virtual_rate_index = 0;
+
+    json_t *oversampling_json = json_object_get(root, "oversampling");
+    if(oversampling_json) setOversampling(json_integer_value(oversampling_json));
 	}
 
+  void setVirtualRate(unsigned int index)
+  {
+    if(index >= NUMBER_OF_VIRTUAL_RATES) index = 0;
+    virtual_rate_index = index;
+  }
+
+  void setOversampling(unsigned int factor)
+  {
+    if(factor != 1 && factor != 2 && factor != 4) factor = 1;
+    oversampling = factor;
+    for(unsigned int c = 0; c < MAX_POLYPHONY; c++) oversampling_counter[c] = 0;
+  }
+
   // This is a helper function for reading inputs with attenuators
   //
   // input_index: The index of the input in InputIds.
@@ -139,9 +211,9 @@ struct ByteBeat : Module
   // float value = calculate_inputs(MY_INPUT, MY_ATTENUATOR_KNOB, 1200.0);
   //
 
-  float calculate_inputs(int input_index, int knob_index, float maximum_value)
+  float calculate_inputs(int input_index, int knob_index, float maximum_value, int channel = 0)
   {
-    float input_value = inputs[input_index].getVoltage() / 10.0;
+    float input_value = inputs[input_index].getPolyVoltage(channel) / 10.0;
     float knob_value = params[knob_index].getValue();
     float out = 0;
 
@@ -157,9 +229,9 @@ struct ByteBeat : Module
     return(out);
   }
 
-  float calculate_parameter_input(int input_index, int knob_index, int attenuator_index, float maximum_value)
+  float calculate_parameter_input(int input_index, int knob_index, int attenuator_index, float maximum_value, int channel = 0)
   {
-    float input_value = inputs[input_index].getVoltage() / 10.0 * maximum_value; // Scale input to 0-128 range
+    float input_value = inputs[input_index].getPolyVoltage(channel) / 10.0 * maximum_value; // Scale input to 0-128 range
     float knob_value = params[knob_index].getValue();
     float attenuator_value = params[attenuator_index].getValue();
     
@@ -175,44 +247,132 @@ struct ByteBeat : Module
 
 	void process(const ProcessArgs &args) override
 	{
-    if(inputs[T_INPUT].isConnected())
+    // The number of voices follows the widest polyphonic input
+    channels = 1;
+    for(int input_index : { PARAM_INPUT_1, PARAM_INPUT_2, PARAM_INPUT_3, EQUATION_INPUT, CLOCK_CV_INPUT, T_INPUT })
     {
-      t = inputs[T_INPUT].getVoltage() * 2048;
+      channels = std::max(channels, (unsigned int) inputs[input_index].getChannels());
     }
-    else
+
+    //
+    // Read equation, parameter, and expression inputs.
+    // Lots of implicit float to int conversion happening here
+
+    // Inputs that aren't polyphonic give every channel the same value, so
+    // those are only worked out once, for channel 0.
+
+    float division[MAX_POLYPHONY];
+
+    for(unsigned int c = 0; c < channels; c++)
     {
-      // clock_division = params[CLOCK_DIVISION_KNOB].getValue();
-      clock_division = calculate_inputs(CLOCK_CV_INPUT, CLOCK_DIVISION_KNOB, MAX_CLOCK_DIVISION); // float to int conversion happening here
+      bool first = (c == 0);
 
-      // Use clock divider to control how quickly t is incremented.
-      // As I mentioned above, this is a temporary hack and will be replaced with
-      // more intelligent control over sample rate (pitch)
+      equation[c] = (first || inputs[EQUATION_INPUT].getChannels() > 1) ? params[EQUATION_KNOB].getValue() + ((inputs[EQUATION_INPUT].getPolyVoltage(c) / 10.0) * (float) NUMBER_OF_EQUATIONS) : equation[0];
 
-      clock_division_counter ++;
-      if(clock_division_counter >= clock_division)
+      p1[c] = (first || inputs[PARAM_INPUT_1].getChannels() > 1) ? calculate_parameter_input(PARAM_INPUT_1, PARAM_KNOB_1, PARAM_ATTENUATOR_1, 128.0, c) : p1[0];
+      p2[c] = (first || inputs[PARAM_INPUT_2].getChannels() > 1) ? calculate_parameter_input(PARAM_INPUT_2, PARAM_KNOB_2, PARAM_ATTENUATOR_2, 128.0, c) : p2[0];
+      p3[c] = (first || inputs[PARAM_INPUT_3].getChannels() > 1) ? calculate_parameter_input(PARAM_INPUT_3, PARAM_KNOB_3, PARAM_ATTENUATOR_3, 128.0, c) : p3[0];
+
+      division[c] = (first || inputs[CLOCK_CV_INPUT].getChannels() > 1) ? calculate_inputs(CLOCK_CV_INPUT, CLOCK_DIVISION_KNOB, MAX_CLOCK_DIVISION, c) : division[0];
+    }
+
+    updateReadouts();
+
+    bool needs_value[MAX_POLYPHONY];
+    float value[MAX_POLYPHONY];
+
+    if(inputs[T_INPUT].isConnected() || virtual_rate_index == 0)
+    {
+      for(unsigned int c = 0; c < channels; c++)
       {
-        t = t + 1;
-        clock_division_counter = 0;
+        if(inputs[T_INPUT].isConnected())
+        {
+          t[c] = inputs[T_INPUT].getPolyVoltage(c) * 2048;
+        }
+        else
+        {
+          // At the engine's rate, t is advanced by a clock divider and the
+          // output is stepped, exactly as the original ByteBeat did.
+          clock_division = division[c]; // float to int conversion happening here
+
+          clock_division_counter[c] ++;
+          if(clock_division_counter[c] >= clock_division)
+          {
+            t[c] = t[c] + 1;
+            clock_division_counter[c] = 0;
+          }
+        }
+
+        needs_value[c] = true;
       }
+
+      compute(needs_value);
+
+      // w is a 8-bit unsigned integer that ranges from 0 to 256. But
+      // the output is based on a float between 0 and 1, so we divide
+      // w by 256.0.
+      for(unsigned int c = 0; c < channels; c++) value[c] = w[c] / 256.0;
     }
+    else
+    {
+      // At a virtual rate, the equation runs at its own rate (divided down
+      // by the pitch knob) and is band-limited on the way to the engine's
+      // rate.  With oversampling, each value of t is held for several input
+      // samples, which keeps more of the stepped sound below the filter.
+      // Oversampling is limited so that the filter's input never runs faster
+      // than the engine.
+      unsigned int virtual_rate = VIRTUAL_RATES[virtual_rate_index];
+      unsigned int factor = std::max(1u, std::min(oversampling, (unsigned int) (args.sampleRate / virtual_rate)));
+
+      unsigned int pending[MAX_POLYPHONY];
+      bool any_pending = false;
+
+      for(unsigned int c = 0; c < channels; c++)
+      {
+        double rate = (double) virtual_rate * factor / std::max(division[c], 1.0f);
+        pending[c] = interpolators[c].advance(rate * args.sampleTime);
+        if(pending[c] > 0) any_pending = true;
+      }
 
-    //
-    // Read equation, parameter, and expression inputs.
-    // Lots of implicit float to int conversion happening here
+      // Each voice may need zero, one, or a few new values this frame.  All
+      // of the voices that need one are computed together, until none are
+      // left waiting.
+      while(any_pending)
+      {
+        any_pending = false;
 
-    uint32_t equation = params[EQUATION_KNOB].getValue() + ((inputs[EQUATION_INPUT].getVoltage() / 10.0) * (float) NUMBER_OF_EQUATIONS);
+        for(unsigned int c = 0; c < channels; c++)
+        {
+          needs_value[c] = (pending[c] > 0) && (oversampling_counter[c] == 0);
+          if(needs_value[c]) t[c] = t[c] + 1;
+        }
 
-    p1 = calculate_parameter_input(PARAM_INPUT_1, PARAM_KNOB_1, PARAM_ATTENUATOR_1, 128.0);
-    p2 = calculate_parameter_input(PARAM_INPUT_2, PARAM_KNOB_2, PARAM_ATTENUATOR_2, 128.0);
-    p3 = calculate_parameter_input(PARAM_INPUT_3, PARAM_KNOB_3, PARAM_ATTENUATOR_3, 128.0);
+        compute(needs_value);
 
-    updateReadouts();
+        for(unsigned int c = 0; c < channels; c++)
+        {
+          if(pending[c] == 0) continue;
+
+          if(needs_value[c]) held_value[c] = w[c] / 256.0;
+          interpolators[c].push(held_value[c]);
+
+          oversampling_counter[c] = (oversampling_counter[c] + 1) % factor;
+          pending[c]--;
+
+          if(pending[c] > 0) any_pending = true;
+        }
+      }
+
+      for(unsigned int c = 0; c < channels; c++) value[c] = interpolators[c].output();
+    }
 
-    // Send the equation, parameters, and expression selections to the "compute"
-    // function.  The output of the "compute" function will be a float representing
-    // the audio generated by one of the bytebeat equations.
     // Output ranges from -5 to +5
-    outputs[AUDIO_OUTPUT].setVoltage((compute(equation, t, p1, p2, p3) * 10.0) - 5.0);
+    outputs[AUDIO_OUTPUT].setChannels(channels);
+
+    for(unsigned int c = 0; c < channels; c++)
+    {
+      outputs[AUDIO_OUTPUT].setVoltage((value[c] * 10.0) - 5.0, c);
+    }
 
     // outputs[DEBUG_OUTPUT].setVoltage(e1); // << for difficult debugging
 
@@ -222,94 +382,191 @@ struct ByteBeat : Module
   //
   // compute(...)
   //
-  // This equation takes in an equation number and a bunch of parameters and outputs
-  // audio in the form of a floating point number.
+  // Updates w for every channel where needs_value is set.  Channels that are
+  // playing the same equation are gathered into lanes and handed to
+  // computeLanes together, so the equation is chosen once per group instead
+  // of once per voice.
+  //
+
+  void compute(const bool *needs_value)
+  {
+    bool done[MAX_POLYPHONY] = {};
+
+    for(unsigned int c = 0; c < channels; c++)
+    {
+      if(done[c] || ! needs_value[c]) continue;
+
+      uint32_t equation_number = equation[c];
+      lanes.count = 0;
+
+      for(unsigned int other = c; other < channels; other++)
+      {
+        if(done[other] || ! needs_value[other] || equation[other] != equation_number) continue;
+
+        unsigned int lane = lanes.count++;
+        lanes.t[lane] = t[other];
+        lanes.p1[lane] = p1[other];
+        lanes.p2[lane] = p2[other];
+        lanes.p3[lane] = p3[other];
+        lanes.w[lane] = w[other];
+        lanes.channel[lane] = other;
+        done[other] = true;
+      }
+
+      computeLanes(equation_number, lanes);
+
+      for(unsigned int lane = 0; lane < lanes.count; lane++) w[lanes.channel[lane]] = lanes.w[lane];
+    }
+  }
+
+  //
+  // computeLanes(...)
+  //
+  // This function takes in an equation number and a group of lanes, each
+  // with its own t and parameters, and updates each lane's w.
   //
   // * The equation number is used  in a switch statement for deciding which equation to evaluate.
   // * Parameters p1, p2, and p3 are used as variables in the equation.  P1, p3, and p3 have
   //   both a knob and CV input on the front panel to allow the user to jazz up the equation.
   //
+  // Each equation is a plain loop over the lanes, so that the compiler is free
+  // to vectorize it.  The equations lean on per-lane shifts and integer
+  // division, which Rack's SIMD types don't offer, so writing the loops this
+  // way gets the same benefit wherever the target supports it.
+  //
   // I'm using a rating system while this module is in development.  Equations
   // are rated from 1 to 10 based on how much I like them.  This'll help me later
   // to decide which equations should be included in the final release.
   //
   // If you want to add a new equation, you'll need to:
-  //  1. Add the equation in the switch statement in the compute function below
+  //  1. Add the equation in the switch statement in the computeLanes function below
   //  2. Increment the constant NUMBER_OF_EQUATIONS in defines.h
   //
-  // Why is "w" defined as a class variable instead of inside of this function?
+  // Why is "w" kept per channel instead of inside of this function?
   // It's because you may want to use the previous value for "w" when calcuating the next "w".  :-)
   //
 
-  float compute(uint32_t equation_number, uint32_t t, uint32_t p1, uint32_t p2, uint32_t p3)
+  void computeLanes(uint32_t equation_number, Lanes &lanes)
   {
+    const uint32_t *__restrict t = lanes.t;
+    const uint32_t *__restrict p1 = lanes.p1;
+    const uint32_t *__restrict p2 = lanes.p2;
+    const uint32_t *__restrict p3 = lanes.p3;
+    uint32_t *__restrict w = lanes.w;
+    unsigned int count = lanes.count;
+
     switch(equation_number) {
 
+      case CUSTOM_EQUATION:
+        for(unsigned int i = 0; i < count; i++) w[i] = computeCustom(lanes.channel[i], t[i], p1[i], p2[i], p3[i]);
+        break;
+
       case 0: // Exploratorium
-        w = ((mod(t,(p1+(mod(t,p2)))))^(t>>(p3>>5)))*2;
+        for(unsigned int i = 0; i < count; i++) w[i] = ((mod(t[i],(p1[i]+(mod(t[i],p2[i])))))^(t[i]>>(p3[i]>>5)))*2;
         break;
 
       case 1: // Toner
-        w = ((t>>( mod((t>>12), (p3>>4)) ))+( mod((p1|t),p2)))<<2;
+        for(unsigned int i = 0; i < count; i++) w[i] = ((t[i]>>( mod((t[i]>>12), (p3[i]>>4)) ))+( mod((p1[i]|t[i]),p2[i])))<<2;
         break;
 
       case 2: // widerange
-        w = (((p1^(t>>(p2>>3)))-(t>>(p3>>2))-mod(t,(t&p2))));
+        for(unsigned int i = 0; i < count; i++) w[i] = (((p1[i]^(t[i]>>(p2[i]>>3)))-(t[i]>>(p3[i]>>2))-mod(t[i],(t[i]&p2[i]))));
         break;
 
       case 3: // Landing gear
-        w = (((p1&t)^mod((t>>2), p2))&(w+1393+p3));
+        for(unsigned int i = 0; i < count; i++) w[i] = (((p1[i]&t[i])^mod((t[i]>>2), p2[i]))&(w[i]+1393+p3[i]));
         break;
 
       case 4: // rampcode (https://github.com/gabochi/rampcode/blob/master/tutorial)
-        w = div((t*((t>>10&p1)+1)),((-t>>12&p2)+1))<<((t*p3>>(t>>14&3)&7)|3);
+        for(unsigned int i = 0; i < count; i++) w[i] = div((t[i]*((t[i]>>10&p1[i])+1)),((-t[i]>>12&p2[i])+1))<<((t[i]*p3[i]>>(t[i]>>14&3)&7)|3);
         break;
 
       case 5:
-        w = t << (t>> (0xb1a7529>>(t>>p1&7)*4&15) &7) & t>>(p3>>(t>>p2&3)*4&15);
+        for(unsigned int i = 0; i < count; i++) w[i] = t[i] << (t[i]>> (0xb1a7529>>(t[i]>>p1[i]&7)*4&15) &7) & t[i]>>(p3[i]>>(t[i]>>p2[i]&3)*4&15);
         break;
 
       case 6: // Silent treatment
-        w = (t-t+t*p1)|(t&(p3+1))|div(t,p2);
+        for(unsigned int i = 0; i < count; i++) w[i] = (t[i]-t[i]+t[i]*p1[i])|(t[i]&(p3[i]+1))|div(t[i],p2[i]);
         break;
 
       case 7: // BitWiz Transplant
-        w = (t-((t&p1)*p2-1668899)*(mod((t>>15),15)*t))>>( mod(t>>12,16))>>(p3%15);
+        for(unsigned int i = 0; i < count; i++) w[i] = (t[i]-((t[i]&p1[i])*p2[i]-1668899)*(mod((t[i]>>15),15)*t[i]))>>( mod(t[i]>>12,16))>>(p3[i]%15);
         break;
 
       // Add next equation here.  Don't forget to increment NUMBER_OF_EQUATIONS in defines.h
       case 8: // Decoherence
         // w = ( (t>>6) & (t<<3) / (t*(t>>11)%(3+((t>>16)%22)))    );
-        w = ((t>>6) & div((t<<3),mod( (t*(t>>p1)),(p3+ mod((t>>16),p3) ))));
+        for(unsigned int i = 0; i < count; i++) w[i] = ((t[i]>>6) & div((t[i]<<3),mod( (t[i]*(t[i]>>p1[i])),(p3[i]+ mod((t[i]>>16),p3[i]) ))));
         break;
     }
 
-    // w is a 8-bit unsigned integer that ranges from 0 to 256. But
-    // this funtion is supposed to return a float between 0 and 1, so we divide
-    // w by 256.0.
-    return(w / 256.0);
+    // w is an 8-bit value, so keep only the low byte
+    for(unsigned int i = 0; i < count; i++) w[i] &= 255;
+  }
+
+  //
+  // computeCustom(...)
+  //
+  // Returns the value of the user's expression at time t, for one channel.
+  // When t moves on to the value right after the cached block, the next
+  // block of values is computed in one go.  Otherwise, such as when t is
+  // being driven by the T input, a single value is computed, which starts a
+  // new block.
+  //
+
+  uint32_t computeCustom(unsigned int channel, uint32_t t, uint32_t p1, uint32_t p2, uint32_t p3)
+  {
+    const BytebeatProgram *program = custom_expression.update();
+    if(program == nullptr) return(0);
+
+    CustomValues &cache = custom_values[channel];
+
+    bool parameters_match = (p1 == cache.p1) && (p2 == cache.p2) && (p3 == cache.p3) && (cache.generation == custom_expression.getActiveGeneration());
+    uint32_t index = t - cache.start;
+
+    if(parameters_match && index < cache.count) return(cache.values[index]);
+
+    bool sequential = parameters_match && (index == cache.count);
+
+    cache.start = t;
+    cache.count = sequential ? BytebeatInterpreter::BLOCK_SIZE : 1;
+    cache.p1 = p1;
+    cache.p2 = p2;
+    cache.p3 = p3;
+    cache.generation = custom_expression.getActiveGeneration();
+
+    interpreter.run(*program, t, p1, p2, p3, cache.values, cache.count);
+
+    return(cache.values[0]);
   }
 
   //
   // These are safe versions of / and %  that avoid division by 0 which crash VCV Rack
   //
 
-  uint32_t div(uint32_t a, uint32_t b)
+  static inline uint32_t div(uint32_t a, uint32_t b)
   {
     if(b == 0) return(0);
     return(a / b);
   }
 
-  uint32_t mod(uint32_t a, uint32_t b)
+  static inline uint32_t mod(uint32_t a, uint32_t b)
   {
     if(b == 0) return(0);
     return(a % b);
   }
 
+  // The readouts are only reformatted when a parameter changes
   void updateReadouts() {
-    param_1_readout = string::f("%d", (int)p1);
-    param_2_readout = string::f("%d", (int)p2);
-    param_3_readout = string::f("%d", (int)p3);
+    if(p1[0] == readout_p1 && p2[0] == readout_p2 && p3[0] == readout_p3) return;
+
+    param_1_readout = string::f("%d", (int)p1[0]);
+    param_2_readout = string::f("%d", (int)p2[0]);
+    param_3_readout = string::f("%d", (int)p3[0]);
+
+    readout_p1 = p1[0];
+    readout_p2 = p2[0];
+    readout_p3 = p3[0];
   }
 
 };
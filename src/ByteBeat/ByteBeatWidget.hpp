@@ -1,5 +1,73 @@
 struct ByteBeatWidget : ModuleWidget
 {
+    struct VirtualRateMenuItem : MenuItem
+    {
+        ByteBeat *module;
+        unsigned int index = 0;
+
+        void onAction(const event::Action &e) override
+        {
+            module->setVirtualRate(index);
+        }
+    };
+
+    struct VirtualRateMenu : MenuItem
+    {
+        ByteBeat *module;
+
+        Menu *createChildMenu() override
+        {
+            Menu *menu = new Menu;
+
+            for (unsigned int i = 0; i < NUMBER_OF_VIRTUAL_RATES; i++)
+            {
+                std::string name = (VIRTUAL_RATES[i] == 0) ? "Engine rate (stepped)" : std::to_string(VIRTUAL_RATES[i]) + " Hz";
+
+                VirtualRateMenuItem *item = createMenuItem<VirtualRateMenuItem>(name, CHECKMARK(module->virtual_rate_index == i));
+                item->module = module;
+                item->index = i;
+                menu->addChild(item);
+            }
+
+            return menu;
+        }
+    };
+
+    struct OversamplingMenuItem : MenuItem
+    {
+        ByteBeat *module;
+        unsigned int factor = 1;
+
+        void onAction(const event::Action &e) override
+        {
+            module->setOversampling(factor);
+        }
+    };
+
+    struct OversamplingMenu : MenuItem
+    {
+        ByteBeat *module;
+
+        Menu *createChildMenu() override
+        {
+            Menu *menu = new Menu;
+
+            unsigned int factors[] = { 1, 2, 4 };
+
+            for (unsigned int factor : factors)
+            {
+                std::string name = (factor == 1) ? "Off" : std::to_string(factor) + "x";
+
+                OversamplingMenuItem *item = createMenuItem<OversamplingMenuItem>(name, CHECKMARK(module->oversampling == factor));
+                item->module = module;
+                item->factor = factor;
+                menu->addChild(item);
+            }
+
+            return menu;
+        }
+    };
+
     ByteBeatWidget(ByteBeat *module)
     {
         setModule(module);
@@ -103,6 +171,27 @@ struct ByteBeatWidget : ModuleWidget
         // addInput(createInputCentered<PJ301MPort>(mm2px(Vec(COLUMN_5, ROW_13)), module, ByteBeat::SYNC_CLOCK_INPUT));
     }
 
+    void appendContextMenu(Menu *menu) override
+    {
+        ByteBeat *module = dynamic_cast<ByteBeat *>(this->module);
+        assert(module);
+
+        // Add a space
+        menu->addChild(new MenuEntry);
+
+        VirtualRateMenu *virtual_rate_menu = createMenuItem<VirtualRateMenu>("Sample Rate", RIGHT_ARROW);
+        virtual_rate_menu->module = module;
+        menu->addChild(virtual_rate_menu);
+
+        OversamplingMenu *oversampling_menu = createMenuItem<OversamplingMenu>("Oversampling", RIGHT_ARROW);
+        oversampling_menu->module = module;
+        menu->addChild(oversampling_menu);
+
+        ExpressionMenu *expression_menu = createMenuItem<ExpressionMenu>("Custom Expression", RIGHT_ARROW);
+        expression_menu->expression_slot = &module->custom_expression;
+        menu->addChild(expression_menu);
+    }
+
     /*
     void add_snapping_parameter_knob(float column, float row, int index)
     {
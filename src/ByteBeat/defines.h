@@ -4,8 +4,20 @@
 // the last equation might be numbered "42" in the switch/case statement,
 // that means that there are 43 equations and you should set NUMBER_OF_EQUATIONS to 43
 #define NUMBER_OF_EQUATIONS 9
+
+// The position after the last built-in equation plays the user's expression
+#define CUSTOM_EQUATION NUMBER_OF_EQUATIONS
+#define DEFAULT_CUSTOM_EXPRESSION "t*((t>>12|t>>8)&p1&t>>4)"
 #define MAX_CLOCK_DIVISION 256.0
 
+// Each polyphonic channel runs its own voice
+#define MAX_POLYPHONY 16
+
+// Rates, in Hz, that the equations can run at.  0 means the engine's own rate.
+#define NUMBER_OF_VIRTUAL_RATES 7
+#define DEFAULT_VIRTUAL_RATE_INDEX 1
+static const unsigned int VIRTUAL_RATES[NUMBER_OF_VIRTUAL_RATES] = { 0, 8000, 11025, 16000, 22050, 32000, 44100 };
+
 #define COLUMN_1 6.35
 #define COLUMN_2 12.7
 #define COLUMN_3 19.05
@@ -13,8 +13,11 @@
 
 #include "vgLib-2.0/constants.h"
 #include "vgLib-2.0/sample.hpp"
+#include "vgLib-2.0/SamplePlayer.hpp"
 #include "vgLib-2.0/components/VoxglitchComponents.hpp"
 #include "vgLib-2.0/helpers/JSON.hpp"
+#include "vgLib-2.0/Telemetry.hpp"
+#include "vgLib-2.0/PublishedValue.hpp"
 
 // For the lower waveform
 #include "vgLib-2.0/widgets/WaveformModel.hpp"
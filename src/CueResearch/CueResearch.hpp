@@ -9,6 +9,7 @@
 */
 
 #include "Marker.hpp"
+#include "MarkerSchedule.hpp"
 #include "ScrubState.hpp"
 
 struct CueResearch : VoxglitchSamplerModule
@@ -18,6 +19,7 @@ struct CueResearch : VoxglitchSamplerModule
     TrackModel track_model;
     WaveformModel waveform_model;
     Sample sample;
+    BackgroundSampleLoad sample_load;   // Decodes the sample off of the UI thread
     ScrubState scrub_state;
 
     dsp::SchmittTrigger start_trigger;
@@ -33,6 +35,7 @@ struct CueResearch : VoxglitchSamplerModule
     dsp::PulseGenerator marker_pulse_generators[32];
     dsp::PulseGenerator reset_light_pulse;
     std::map<unsigned int, std::vector<Marker>> markers; // position -> markers at that position
+    MarkerSchedule marker_schedule; // The audio thread's copy of _markers_
 
     // Menu options
     bool enable_vertical_drag_zoom = true;
@@ -45,8 +48,6 @@ struct CueResearch : VoxglitchSamplerModule
     std::vector<float> trigger_lengths = {0.001, 0.002, 0.005, 0.010, 0.020, 0.050, 0.100, 0.200};
     unsigned int trigger_length_index = 0;
 
-    std::vector<std::function<void(unsigned int)>> playback_position_observers;
-
     enum ParamIds
     {
         ENUMS(MARKER_BUTTONS, 32),
@@ -85,6 +86,9 @@ struct CueResearch : VoxglitchSamplerModule
         // sample.load("e:/dev/example.wav");
         track_model.setSample(&sample);
 
+        // Markers can be placed on the transients found when the sample loads
+        sample.analyze_on_load = true;
+
         // Set up the callback
         track_model.onMarkerSelected = [this](int output_number)
         {
@@ -128,23 +132,12 @@ struct CueResearch : VoxglitchSamplerModule
         track_model.setLockMarkers(&lock_markers);
         track_model.setLockInteractions(&lock_interactions);
 
-        registerPlaybackObserver([this](unsigned int position)
-        {
-            track_model.updatePlayheadPosition(position);
-        });
-
         // Set up the callback for scrubber position changes (registerPlayheadObserver) to call onDragPlayhead
         track_model.registerDragPlayheadObserver([this](unsigned int position)
         {
             onDragPlayhead(position);
         });
 
-        // Register playback observer for waveform playhead position
-        registerPlaybackObserver([this](unsigned int position)
-        {
-            waveform_model.updatePlayheadPosition(position);
-        });
-
         // Set up the callback for waveform scrubbing
         waveform_model.registerDragPlayheadObserver([this](unsigned int position)
         {
@@ -166,6 +159,23 @@ struct CueResearch : VoxglitchSamplerModule
             // Assuming each position in the map represents a sample position for a marker
             waveform_model.marker_positions.push_back(marker_pair.first);
         }
+
+        marker_schedule.publish(markers);
+    }
+
+    // Fires the markers that the playhead crosses on its way from _from_ to _to_
+    void crossMarkers(double from, double to)
+    {
+        if (marker_schedule.position != from) marker_schedule.seek(from);
+
+        uint32_t fired = marker_schedule.advance(to);
+        if (fired == 0) return;
+
+        float trigger_length = trigger_lengths[trigger_length_index];
+        for (int i = 0; i < 32; i++)
+        {
+            if (fired & (1u << i)) marker_pulse_generators[i].trigger(trigger_length);
+        }
     }
 
     void placeMarkersAtDivisions(unsigned int num_divisions) {  // Changed to unsigned int
@@ -185,32 +195,20 @@ struct CueResearch : VoxglitchSamplerModule
         syncMarkers();
     }
 
-    void updateScrubBuffer() {
-        unsigned int buffer_midpoint = ScrubState::SCRUB_BUFFER_SIZE / 2;
-        
-        // Start filling from half a buffer before target position
-        unsigned int fill_start = (scrub_state.target_position >= buffer_midpoint)
-            ? scrub_state.target_position - buffer_midpoint
-            : 0;
-            
-        for (size_t i = 0; i < ScrubState::SCRUB_BUFFER_SIZE; i++) {
-            if (fill_start + i < sample.size()) {
-                float left, right;
-                sample.read(fill_start + i, &left, &right);
-                
-                // Triangle envelope centered at buffer midpoint
-                float envelope = 1.0f - std::abs((float)(i - buffer_midpoint) / buffer_midpoint);
-                
-                scrub_state.buffer_left[i] = left * envelope;
-                scrub_state.buffer_right[i] = right * envelope;
-            } else {
-                scrub_state.buffer_left[i] = 0.0f;
-                scrub_state.buffer_right[i] = 0.0f;
+    // Places a marker on every transient that was found when the sample was
+    // loaded.  See OnsetDetector.
+    void placeMarkersAtTransients() {
+        if (!sample.loaded) return;
+
+        markers.clear();
+
+        for (uint32_t position : sample.slices.positions) {
+            if (position > 0 && position < sample.size()) {
+                markers[position].push_back(Marker(active_marker));
             }
         }
-        
-        scrub_state.buffer_needs_update = false;
-        scrub_state.buffer_position = buffer_midpoint;  // Start playback from middle
+
+        syncMarkers();
     }
 
     //
@@ -218,21 +216,15 @@ struct CueResearch : VoxglitchSamplerModule
     // Added 10/31
     //
 
-    void registerPlaybackObserver(std::function<void(unsigned int)> callback) {
-        playback_position_observers.push_back(callback);
-    }
-
     void onDragPlayhead(unsigned int position) 
     {
-        scrub_state.display_position = position;  // Set display position directly
-        scrub_state.target_position = position;   // Set target for buffer system
-        broadcastPlaybackPosition(position);      // Broadcast display position
+        scrub_state.target_position = position;   // The scrubber chases this
     }
 
+    // Hands the playhead to the displays.  They pick it up once per frame.
     void broadcastPlaybackPosition(unsigned int position) {
-        for(auto& observer : playback_position_observers) {
-            observer(position);
-        }
+        track_model.updatePlayheadPosition(position);
+        waveform_model.updatePlayheadPosition(position);
     }
 
     // █▀ ▄▀█ █░█ █▀▀   ▄▀█ █▄░█ █▀▄   █░░ █▀█ ▄▀█ █▀▄
@@ -276,7 +268,7 @@ struct CueResearch : VoxglitchSamplerModule
         json_t *loaded_sample_path = json_object_get(rootJ, ("loaded_sample_path"));
         if (loaded_sample_path)
         {
-            sample.load(json_string_value(loaded_sample_path));
+            sample_load.load(&sample, json_string_value(loaded_sample_path));
             loaded_filename = sample.getFilename();
         }
 
@@ -338,6 +330,9 @@ struct CueResearch : VoxglitchSamplerModule
 
     void process(const ProcessArgs &args) override
     {
+        // Pick up the sample once it has finished loading
+        sample_load.adopt(&sample);
+
         bool reset_triggered = reset_trigger.process(inputs[RESET_INPUT].getVoltage(), constants::gate_low_trigger, constants::gate_high_trigger);
         bool start_triggered = start_trigger.process(inputs[START_INPUT].getVoltage(), constants::gate_low_trigger, constants::gate_high_trigger);
         bool stop_triggered = stop_trigger.process(inputs[STOP_INPUT].getVoltage(), constants::gate_low_trigger, constants::gate_high_trigger);
@@ -380,46 +375,36 @@ struct CueResearch : VoxglitchSamplerModule
             scrub_state.reset();
         }
 
+        marker_schedule.update();
+
         // Handle playback
         if (sample.loaded) 
         {
-            if (waveform_model.scrubber_dragging || track_model.scrubber_dragging) 
+            bool scrubbing = waveform_model.scrubber_dragging || track_model.scrubber_dragging;
+            if (! scrubbing) scrub_state.end();
+
+            if (scrubbing) 
             {
-                if (scrub_state.buffer_needs_update) {
-                    updateScrubBuffer();
+                if (! scrub_state.active) {
+                    scrub_state.begin(playback_position);
                 }
 
-                // Buffer playback for audio
-                unsigned int buffer_position = scrub_state.buffer_position;
-                buffer_position += 1;  // or some other increment
-                
-                if (buffer_position >= ScrubState::SCRUB_BUFFER_SIZE * 3/4) {
-                    scrub_state.buffer_needs_update = true;
-                    buffer_position = ScrubState::SCRUB_BUFFER_SIZE/2;
-                }
-                
-                scrub_state.buffer_position = buffer_position;
-                
-                // Output audio from buffer
-                output_left = scrub_state.buffer_left[buffer_position];
-                output_right = scrub_state.buffer_right[buffer_position];
-
-                // Use display position for UI updates
-                playback_position = scrub_state.display_position;
+                scrub_state.step(args.sampleTime, sample.size());
+
+                float gain = scrub_state.gain();
+                sample.readHermite(scrub_state.position, &output_left, &output_right);
+                output_left *= gain;
+                output_right *= gain;
+
+                // The playhead shows where the scrubber is being dragged to
+                playback_position = scrub_state.target_position;
             }
             else if (playing) 
             {
                 // Normal playback - increment position
                 if (playback_position < sample.size()) {
-                    // Check if there are markers at the current position
-                    auto it = markers.find(playback_position);
-                    if (it != markers.end()) {
-                        // Trigger pulses for all markers at this position
-                        float trigger_length = trigger_lengths[trigger_length_index];
-                        for (const Marker& marker : it->second) {
-                            marker_pulse_generators[marker.output_number].trigger(trigger_length);
-                        }
-                    }
+                    // Trigger pulses for all markers at this position
+                    crossMarkers(playback_position, playback_position + 1);
 
                     sample.read(playback_position, &output_left, &output_right);
                     playback_position++;
@@ -427,6 +412,7 @@ struct CueResearch : VoxglitchSamplerModule
                     if (loop_sample_playback) {
                         // When looping, wrap the playback position back to start
                         playback_position = playback_position % sample.size();
+                        crossMarkers(playback_position, playback_position + 1);
                         
                         // Read the wrapped position
                         sample.read(playback_position, &output_left, &output_right);
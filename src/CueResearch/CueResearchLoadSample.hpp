@@ -22,7 +22,7 @@ struct CueResearchLoadSample : MenuItem
     {
         if (filename != "")
         {
-            module->sample.load(filename);
+            module->sample_load.load(&module->sample, filename);
             module->loaded_filename = module->sample.getFilename();
             module->setRoot(filename);
             if (module->clear_markers_on_sample_load)
@@ -126,6 +126,10 @@ struct CueResearchWidget : VoxglitchSamplerModuleWidget
             }
         ));
 
+        menu->addChild(createMenuItem("Place markers at transients", "", [=]() {
+            module->placeMarkersAtTransients();
+        }));
+
         // Add action to clear markers
         menu->addChild(createMenuItem("Clear All Markers", "", [=]() {
             module->clearMarkers();
@@ -0,0 +1,132 @@
+#pragma once
+#include <vector>
+#include <map>
+#include <memory>
+#include <atomic>
+#include <algorithm>
+
+#include "Marker.hpp"
+
+//
+// MarkerSchedule
+//
+// The audio thread's view of the markers.  The marker map is edited by the
+// UI, and every time it changes, publish() flattens it into a MarkerTable: a
+// sorted array of positions, each with a bitmask of the outputs to fire.
+// The table is handed to the audio thread through a PublishedValue, the same
+// way BytebeatExpressionSlot hands over programs, so the audio thread never
+// waits on the UI, touches the map, or frees a replaced table.
+//
+// On the audio thread, a cursor remembers where the playhead is in the
+// table.  advance() fires every marker the playhead passes over, in either
+// direction and at any speed, and moves the cursor along with it.  During
+// normal playback this costs a comparison or two per sample.  Jumps, like a
+// reset or a scrub, are handled by seek(), which does a binary search.
+//
+
+struct MarkerTable
+{
+    std::vector<unsigned int> positions;
+    std::vector<uint32_t> outputs;
+};
+
+struct MarkerSchedule
+{
+    PublishedValue<const MarkerTable> table;
+
+    // Audio thread
+    double position = 0.0;
+    size_t next = 0; // The first marker at or after _position_
+
+    // Called from the UI thread whenever the markers change
+    void publish(const std::map<unsigned int, std::vector<Marker>> &markers)
+    {
+        std::shared_ptr<MarkerTable> compiled = std::make_shared<MarkerTable>();
+
+        for (const auto &marker_pair : markers)
+        {
+            uint32_t mask = 0;
+
+            for (const Marker &marker : marker_pair.second)
+            {
+                if (marker.output_number >= 0 && marker.output_number < 32) mask |= (1u << marker.output_number);
+            }
+
+            if (mask == 0) continue;
+
+            compiled->positions.push_back(marker_pair.first);
+            compiled->outputs.push_back(mask);
+        }
+
+        table.publish(compiled);
+    }
+
+    // Audio thread.  Picks up the latest table, if it has changed.
+    void update()
+    {
+        if (table.update()) seek(position);
+    }
+
+    // Moves the playhead without firing anything
+    void seek(double new_position)
+    {
+        position = new_position;
+
+        const MarkerTable *active = table.get();
+
+        if (! active)
+        {
+            next = 0;
+            return;
+        }
+
+        const std::vector<unsigned int> &positions = active->positions;
+        next = std::lower_bound(positions.begin(), positions.end(), new_position, [](unsigned int marker_position, double value) {
+            return(marker_position < value);
+        }) - positions.begin();
+    }
+
+    //
+    // advance(to)
+    //
+    // Moves the playhead to _to_ and returns the outputs of every marker it
+    // crossed.  Going forward, markers in [position, to) fire.  Going
+    // backward, markers in (to, position] fire.  Either way, a marker fires
+    // once each time the playhead passes over it.
+    //
+    uint32_t advance(double to)
+    {
+        uint32_t fired = 0;
+        const MarkerTable *active = table.get();
+
+        if (active)
+        {
+            const std::vector<unsigned int> &positions = active->positions;
+            const std::vector<uint32_t> &outputs = active->outputs;
+
+            if (to > position)
+            {
+                while (next < positions.size() && positions[next] < to)
+                {
+                    fired |= outputs[next];
+                    next++;
+                }
+            }
+            else if (to < position)
+            {
+                if (next < positions.size() && positions[next] <= position) fired |= outputs[next];
+
+                while (next > 0 && positions[next - 1] > to)
+                {
+                    next--;
+                    fired |= outputs[next];
+                }
+
+                if (next > 0 && positions[next - 1] >= to) next--;
+            }
+        }
+
+        position = to;
+        return(fired);
+    }
+};
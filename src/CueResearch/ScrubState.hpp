@@ -1,24 +1,107 @@
 #pragma once
-#include <vector>
+#include <atomic>
+#include <cmath>
+
+//
+// ScrubState
+//
+// A tape-style scrubber.  While the playhead is being dragged, a read head
+// chases the drag position.  Its speed follows the speed of the drag, so a
+// slow drag plays slowly and low, a fast drag plays fast and high, and
+// dragging backward plays backward.
+//
+// The drag position only changes once per UI frame, so it's smoothed before
+// the read head follows it, and the read head's speed is smoothed as well.
+// This avoids the zipper noise that a steppy speed would make.  The speed is
+// limited to MAX_SPEED.
+//
+// The volume fades in with speed, like a tape that's barely moving, so
+// holding the playhead still is silent instead of a click followed by a
+// stuck sample.
+//
+// Every step is a handful of multiplies, and the audio is read straight from
+// the sample with an interpolator.  Nothing is ever buffered.
+//
 
 struct ScrubState {
-    static const size_t SCRUB_BUFFER_SIZE = 256 * 16;
-    
-    std::vector<float> buffer_left;
-    std::vector<float> buffer_right;
-    unsigned int buffer_position = 0;    // For audio output
-    unsigned int display_position = 0;   // For UI/playhead display
-    unsigned int target_position = 0;    // Position from drag events
-    float scrub_speed = 0.0f;
-    bool buffer_needs_update = false;
-    
-    ScrubState() : buffer_left(SCRUB_BUFFER_SIZE), buffer_right(SCRUB_BUFFER_SIZE) {}
-    
+    static constexpr double MAX_SPEED = 16.0;              // samples per sample
+    static constexpr float TARGET_SMOOTHING_TIME = 0.015f;  // seconds
+    static constexpr float FOLLOW_TIME = 0.030f;            // seconds
+    static constexpr float SPEED_SMOOTHING_TIME = 0.010f;   // seconds
+    static constexpr float FULL_VOLUME_SPEED = 0.25f;       // samples per sample
+
+    // Written by the UI while dragging
+    std::atomic<unsigned int> target_position{0};
+
+    // Audio thread
+    bool active = false;
+    double position = 0.0;
+    double smoothed_target = 0.0;
+    double speed = 0.0;
+
+    float sample_time = 0.0f;
+    float target_coefficient = 1.0f;
+    float follow_rate = 1.0f;
+    float speed_coefficient = 1.0f;
+
+    // The read head starts at _from_, not moving
+    void begin(double from) {
+        active = true;
+        position = from;
+        smoothed_target = from;
+        speed = 0.0;
+    }
+
+    void end() {
+        active = false;
+        speed = 0.0;
+    }
+
     void reset() {
-        buffer_position = 0;
-        display_position = 0;
+        end();
         target_position = 0;
-        scrub_speed = 0.0f;
-        buffer_needs_update = true;
     }
-};
\ No newline at end of file
+
+    //
+    // step(sample_time, length)
+    //
+    // Moves the read head one sample closer to the drag position.  The read
+    // head stays between 0 and _length_.
+    //
+    void step(float new_sample_time, unsigned int length) {
+        if (new_sample_time != sample_time) setSampleTime(new_sample_time);
+
+        smoothed_target += ((double) target_position.load() - smoothed_target) * target_coefficient;
+
+        double desired_speed = (smoothed_target - position) * follow_rate;
+        if (desired_speed > MAX_SPEED) desired_speed = MAX_SPEED;
+        if (desired_speed < -MAX_SPEED) desired_speed = -MAX_SPEED;
+
+        speed += (desired_speed - speed) * speed_coefficient;
+        position += speed;
+
+        if (position < 0.0) {
+            position = 0.0;
+            speed = 0.0;
+        }
+
+        if (position > (double) length) {
+            position = length;
+            speed = 0.0;
+        }
+    }
+
+    float gain() {
+        float magnitude = std::fabs(speed) / FULL_VOLUME_SPEED;
+        return(magnitude < 1.0f ? magnitude : 1.0f);
+    }
+
+    void setSampleTime(float new_sample_time) {
+        sample_time = new_sample_time;
+        target_coefficient = 1.0f - std::exp(-sample_time / TARGET_SMOOTHING_TIME);
+        speed_coefficient = 1.0f - std::exp(-sample_time / SPEED_SMOOTHING_TIME);
+
+        // Proportional follower: closes the gap over roughly FOLLOW_TIME
+        follow_rate = sample_time / FOLLOW_TIME;
+    }
+};
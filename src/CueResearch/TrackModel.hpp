@@ -29,6 +29,7 @@ struct TrackModel
     // float playback_percentage = 0.0f;
     // bool scrubber_dragging = false;
     unsigned int playhead_position = 0;
+    TelemetryChannel<unsigned int> playhead_telemetry;
 
     // Marker properties
     std::map<unsigned int, std::vector<Marker>>* markers = nullptr;
@@ -68,9 +69,9 @@ struct TrackModel
 
     void initialize() 
     {
-        if (sample && sample->isLoaded()) 
+        if (sample && sample->getDisplayLength() > 0) 
         {
-            visible_window_end = sample->size(); // Initially, set the visible window to the full sample length
+            visible_window_end = sample->getDisplayLength(); // Initially, set the visible window to the full sample length
             computeAverages(); // Compute averages when sample is set
             normalizeAverages(); // Normalize them after computation
         }
@@ -162,15 +163,24 @@ struct TrackModel
 
     void onSampleChanged() {
         cache_valid = false;
-        if (sample && sample->isLoaded()) {
+        if (sample && sample->getDisplayLength() > 0) {
             visible_window_start = 0;
-            visible_window_end = sample->size();
+            visible_window_end = sample->getDisplayLength();
         }
         invalidateCache();
     }
 
     // Add new methods
+    // Called from the audio thread.  See WaveformModel::updatePlayheadPosition().
     void updatePlayheadPosition(unsigned int position) {
+        playhead_telemetry.process(position);
+    }
+
+    // Called from TrackWidget::step()
+    void pollPlayheadPosition() {
+        unsigned int position;
+        if (! playhead_telemetry.read(position)) return;
+
         if (position != playhead_position) {
             playhead_position = position;
             // Tell the widget to update its display
@@ -194,7 +204,7 @@ struct TrackModel
 
     void updateWaveformCache(float track_width, float track_height, float padding_left, float padding_right,
                         float padding_top, float padding_bottom) {
-        if (!sample || !sample->isLoaded()) return;
+        if (!sample || sample->getDisplayLength() == 0) return;
 
         float drawable_width = track_width - (padding_left + padding_right);
         
@@ -209,7 +219,7 @@ struct TrackModel
         // Use the smaller of:
         // 1. Global chunk size (for stability)
         // 2. Visible chunk size (for detail when zoomed)
-        unsigned int global_chunk_size = std::max(1u, sample->size() / chunks_needed);
+        unsigned int global_chunk_size = std::max(1u, sample->getDisplayLength() / chunks_needed);
         unsigned int visible_chunk_size = std::max(1u, visible_samples / chunks_needed);
         unsigned int chunk_size = std::min(global_chunk_size, visible_chunk_size);
         
@@ -224,8 +234,8 @@ struct TrackModel
             WaveformChunk& chunk = chunk_cache[i];
             
             // Calculate chunk boundaries, clamped to sample range
-            unsigned int chunk_start = std::min((first_chunk + i) * chunk_size, sample->size());
-            unsigned int chunk_end = std::min(chunk_start + chunk_size, sample->size());
+            unsigned int chunk_start = std::min((first_chunk + i) * chunk_size, sample->getDisplayLength());
+            unsigned int chunk_end = std::min(chunk_start + chunk_size, sample->getDisplayLength());
             
             // Skip if chunk is outside visible range
             if (chunk_start >= visible_window_end || chunk_end <= visible_window_start) {
@@ -242,20 +252,12 @@ struct TrackModel
                 continue;
             }
             
-            float left_sum = 0.0f;
-            float right_sum = 0.0f;
-            unsigned int count = 0;
-            
-            for (unsigned int pos = visible_start; pos < visible_end; ++pos) {
-                float left, right;
-                sample->read(pos, &left, &right);
-                left_sum += std::abs(left);
-                right_sum += std::abs(right);
-                count++;
-            }
+            // Look the chunk up in the sample's peak pyramid rather than
+            // re-reading the audio every time the view zooms or scrolls.
+            unsigned int count = visible_end - visible_start;
 
             if (count > 0) {
-                float average_height = (left_sum + right_sum) / (2.0f * count);
+                float average_height = sample->readPeaks(visible_start, visible_end).mean_abs;
                 average_height *= (track_height - (padding_top + padding_bottom));
                 
                 chunk.average_height = average_height;
@@ -293,10 +295,10 @@ struct TrackModel
     // Update the visible window based on the current zoom factor
     void updateVisibleWindow()
     {
-        if (!sample || !sample->isLoaded())
+        if (!sample || sample->getDisplayLength() == 0)
             return;
 
-        unsigned int sample_size = sample->size();
+        unsigned int sample_size = sample->getDisplayLength();
         unsigned int visible_span = static_cast<unsigned int>(sample_size / zoom_factor);
         unsigned int visible_center = (visible_window_start + visible_window_end) / 2;
 
@@ -310,35 +312,23 @@ struct TrackModel
     // Compute waveform averages for the entire sample
     void computeAverages()
     {
-        if (!sample || !sample->isLoaded())
+        if (!sample || sample->getDisplayLength() == 0)
             return;
 
-        unsigned int total_samples = sample->size();
+        unsigned int total_samples = sample->getDisplayLength();
         unsigned int num_chunks = (total_samples + samples_per_average - 1) / samples_per_average; // Calculate the number of chunks, rounding up
         averages.clear();
         averages.reserve(num_chunks); // Predefine size to match the number of chunks
 
         for (unsigned int chunk_index = 0; chunk_index < num_chunks; ++chunk_index) 
         {
-            float left_sum = 0.0;
-            float right_sum = 0.0;
-            unsigned int count = 0;
-
             unsigned int chunk_start = chunk_index * samples_per_average;
             unsigned int chunk_end = std::min(chunk_start + samples_per_average, total_samples);
-
-            for (unsigned int i = chunk_start; i < chunk_end; i++)
-            {
-                float left, right;
-                sample->read(i, &left, &right);
-                left_sum += std::abs(left);
-                right_sum += std::abs(right);
-                count++;
-            }
+            unsigned int count = chunk_end - chunk_start;
 
             if (count > 0)
             {
-                float average = (left_sum + right_sum) / (2.0f * count);
+                float average = sample->readPeaks(chunk_start, chunk_end).mean_abs;
                 averages.push_back(average);
                 if (average > max_average)
                     max_average = average;
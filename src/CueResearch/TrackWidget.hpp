@@ -7,6 +7,7 @@ struct TrackWidget : TransparentWidget
     TrackModel *track_model = nullptr;
     // Used to watch for updates to the sample
     std::string sample_filename = "";
+    unsigned int sample_display_length = 0;
 
     // Properties for sample view dragging/zooming
     Vec drag_start_position;
@@ -70,10 +71,15 @@ struct TrackWidget : TransparentWidget
         nvgFillColor(vg, nvgRGB(0x10, 0x20, 0x20));
         nvgFill(vg);
 
-        // Draw the waveform
-        if (track_model && track_model->sample && track_model->sample->isLoaded())
+        // Draw the waveform.  It can come from cached peaks while the audio
+        // is still loading, but the markers and playhead wait for the audio.
+        if (track_model && track_model->sample && track_model->sample->getDisplayLength() > 0)
         {
             drawWaveform(vg, box.size.x, box.size.y);
+        }
+
+        if (track_model && track_model->sample && track_model->sample->isLoaded())
+        {
             drawMarkers(args, box.size.x, box.size.y);
             drawPlaybackIndicator(args, box.size.x, box.size.y);
         }
@@ -90,11 +96,11 @@ struct TrackWidget : TransparentWidget
         // Clamp visible window to sample bounds
         unsigned int visible_sample_start = std::min(
             static_cast<unsigned int>(track_model->visible_window_start),
-            track_model->sample->size() - 1
+            track_model->sample->getDisplayLength() - 1
         );
         unsigned int visible_sample_end = std::min(
             static_cast<unsigned int>(track_model->visible_window_end),
-            track_model->sample->size()
+            track_model->sample->getDisplayLength()
         );
 
         // Check if we need to update the cache
@@ -301,10 +307,14 @@ struct TrackWidget : TransparentWidget
     {
         TransparentWidget::step();
 
-        // Sample has changed
-        if (sample_filename != track_model->sample->filename)
+        track_model->pollPlayheadPosition();
+
+        // Sample has changed, or its audio has arrived without any cached
+        // peaks to show in the meantime
+        if (sample_filename != track_model->sample->filename || sample_display_length != track_model->sample->getDisplayLength())
         {
             sample_filename = track_model->sample->filename;
+            sample_display_length = track_model->sample->getDisplayLength();
             track_model->initialize();
         }
     }
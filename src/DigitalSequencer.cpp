@@ -24,6 +24,7 @@
 #include "vgLib-2.0/constants.h"
 
 #include "vgLib-2.0/components/VoxglitchComponents.hpp"
+#include "vgLib-2.0/widgets/RetainedLayer.hpp"
 #include "vgLib-2.0/sequencer/VoltageSequencerHistory.hpp"
 #include "vgLib-2.0/sequencer/Sequencer.hpp"
 #include "vgLib-2.0/sequencer/VoltageSequencer.hpp"
@@ -10,6 +10,8 @@ struct VoltageSequencerDisplay : SequencerDisplay
     int previous_shift_sequence_column = 0;
     int shift_sequence_column = 0;
 
+    RetainedLayer *pattern_layer;
+
     VoltageSequencerDisplay()
     {
         // The bounding box needs to be a little deeper than the visual
@@ -17,6 +19,9 @@ struct VoltageSequencerDisplay : SequencerDisplay
         // which is why 16 is being added to the draw height to define the
         // bounding box.
         box.size = Vec(DRAW_AREA_WIDTH, DRAW_AREA_HEIGHT + 16);
+
+        pattern_layer = new RetainedLayer(Vec(DRAW_AREA_WIDTH, DRAW_AREA_HEIGHT), [this](NVGcontext *vg) { drawPattern(vg); });
+        addChild(pattern_layer);
     }
 
     void drawLayer(const DrawArgs &args, int layer) override
@@ -24,96 +29,37 @@ struct VoltageSequencerDisplay : SequencerDisplay
         if (layer == 1)
         {
             const auto vg = args.vg;
-            NVGcolor bar_color;
-            bool draw_from_center = false;
 
             // Save the drawing context to restore later
             nvgSave(vg);
 
             if (module)
             {
-                // OLD CODE
-                // double range_low = module->selected_voltage_sequencer->voltage_ranges[module->selected_voltage_sequencer->voltage_range_index][0];
-                // double range_high = module->selected_voltage_sequencer->voltage_ranges[module->selected_voltage_sequencer->voltage_range_index][1];
-
-                // NEW CODE
-                unsigned int voltage_range_index = module->voltage_range_indexes[module->selected_sequencer_index];
-                double range_low = module->voltage_ranges[voltage_range_index][0];
-                double range_high = module->voltage_ranges[voltage_range_index][1];
+                // The pattern is only drawn again when it changes
+                pattern_layer->update(patternKey());
+                pattern_layer->drawRetained(args);
 
-                if (range_low < 0 && range_high > 0)
-                    draw_from_center = true;
+                // The playhead's column is painted again on top of the cached
+                // pattern, from the background up, and clipped to the column so
+                // that the guides and overlay stay exactly as they were.
+                int playback_position = module->selected_voltage_sequencer->getPlaybackPosition();
 
-                //
-                // Display the pattern
-                //
-                for (unsigned int i = 0; i < MAX_SEQUENCER_STEPS; i++)
+                if (playback_position >= 0 && playback_position < MAX_SEQUENCER_STEPS)
                 {
-                    float value = module->selected_voltage_sequencer->getValue(i);
-
-                    // Draw grey background bar
-                    if ((int)i < (module->selected_voltage_sequencer->getWindowEnd() + 1))
-                    {
-                        bar_color = brightness(bright_background_color, settings::rackBrightness);
-                    }
-                    else
-                    {
-                        bar_color = brightness(dark_background_color, settings::rackBrightness);
-                    }
-
-                    drawBar(vg, i, BAR_HEIGHT, DRAW_AREA_HEIGHT, bar_color);
-
-                    if ((int)i == module->selected_voltage_sequencer->getPlaybackPosition())
-                    {
-                        bar_color = current_step_highlight_color; // Highlight current step
-                    }
-                    else if ((int)i < (module->selected_voltage_sequencer->getWindowEnd() + 1))
-                    {
-                        bar_color = lesser_step_highlight_color;
-                    }
-                    else
-                    {
-                        bar_color = default_step_highlight_color;
-                    }
-
-                    if (draw_from_center) {
-                        float half_height = DRAW_AREA_HEIGHT / 2.0;
-                        if (value > 0.5) {
-                            // Draw up from center (this works fine)
-                            float bar_height = (value - 0.5) * 2 * half_height;
-                            drawBar(vg, i, bar_height, half_height, bar_color);
-                        } else {
-                            // Draw down from center
-                            float bar_height = (0.5 - value) * 2 * half_height;
-                            // Start at half_height and draw downward by adding height
-                            drawBar(vg, i, bar_height, half_height + bar_height, bar_color);
-                        }
-                    } else {
-                        // Original unipolar drawing
-                        if (value > 0) {
-                            drawBar(vg, i, (value * DRAW_AREA_HEIGHT), DRAW_AREA_HEIGHT, bar_color);
-                        }
-                    }
-
-                    // Highlight the sequence playback column
-                    if ((int)i == module->selected_voltage_sequencer->getPlaybackPosition())
-                    {
-                        drawBar(vg, i, DRAW_AREA_HEIGHT, DRAW_AREA_HEIGHT, sequence_position_highlight_color);
-                    }
+                    nvgSave(vg);
+                    nvgIntersectScissor(vg, (playback_position * bar_width) + (playback_position * BAR_HORIZONTAL_PADDING), 0, bar_width, DRAW_AREA_HEIGHT);
+                    drawStep(vg, playback_position, true);
+                    drawDecorations(vg);
+                    nvgRestore(vg);
                 }
 
-                // Draw a horizontal 0-indicator if the range is not symmetrical
-                if (draw_from_center)
+                if (module->tooltip_timer > 0)
+                    draw_tooltip = true;
+
+                if (draw_tooltip)
                 {
-                    // This calculation for y takes advance of the fact that all
-                    // ranges that would have the 0-guide visible are symmetric, so
-                    // it will need updating if non-symmetric ranges are added.
-                    double y = DRAW_AREA_HEIGHT / 2.0;
-
-                    nvgBeginPath(vg);
-                    nvgRect(vg, 1, y, (DRAW_AREA_WIDTH - 2), 1.0);
-                    nvgFillColor(vg, nvgRGBA(240, 240, 255, 40));
-                    nvgFill(vg);
+                    drawTooltip(vg);
+                    draw_tooltip = false;
                 }
             }
             else // Draw a demo sequence so that the sequencer looks nice in the library selector
@@ -132,27 +78,141 @@ struct VoltageSequencerDisplay : SequencerDisplay
                     if (i == 5)
                         drawBar(vg, i, DRAW_AREA_HEIGHT, DRAW_AREA_HEIGHT, sequence_position_highlight_color);
                 }
+
+                drawVerticalGuildes(vg, DRAW_AREA_HEIGHT);
+                drawOverlay(vg, DRAW_AREA_WIDTH, DRAW_AREA_HEIGHT);
             }
 
-            drawVerticalGuildes(vg, DRAW_AREA_HEIGHT);
-            drawOverlay(vg, DRAW_AREA_WIDTH, DRAW_AREA_HEIGHT);
+            nvgRestore(vg);
+        }
+    }
 
-            if (module)
-            {
-                if (module->tooltip_timer > 0)
-                    draw_tooltip = true;
+    // Everything that the cached pattern depends on
+    RetainedLayerKey patternKey()
+    {
+        RetainedLayerKey key;
 
-                if (draw_tooltip)
-                {
-                    drawTooltip(vg);
-                    draw_tooltip = false;
-                }
+        for (unsigned int i = 0; i < MAX_SEQUENCER_STEPS; i++)
+        {
+            key.add(module->selected_voltage_sequencer->getValue(i));
+        }
+
+        key.add(module->selected_voltage_sequencer->getWindowEnd());
+        key.add(drawFromCenter());
+        key.add(settings::rackBrightness);
+
+        return(key);
+    }
+
+    bool drawFromCenter()
+    {
+        // OLD CODE
+        // double range_low = module->selected_voltage_sequencer->voltage_ranges[module->selected_voltage_sequencer->voltage_range_index][0];
+        // double range_high = module->selected_voltage_sequencer->voltage_ranges[module->selected_voltage_sequencer->voltage_range_index][1];
+
+        // NEW CODE
+        unsigned int voltage_range_index = module->voltage_range_indexes[module->selected_sequencer_index];
+        double range_low = module->voltage_ranges[voltage_range_index][0];
+        double range_high = module->voltage_ranges[voltage_range_index][1];
+
+        return(range_low < 0 && range_high > 0);
+    }
+
+    //
+    // void drawPattern(NVGcontext *vg)
+    //
+    // Draws the pattern without the playhead.  This is what pattern_layer
+    // keeps in its framebuffer.
+    //
+    void drawPattern(NVGcontext *vg)
+    {
+        if (! module) return;
+
+        for (unsigned int i = 0; i < MAX_SEQUENCER_STEPS; i++)
+        {
+            drawStep(vg, i, false);
+        }
+
+        drawDecorations(vg);
+    }
+
+    void drawStep(NVGcontext *vg, unsigned int i, bool playing)
+    {
+        NVGcolor bar_color;
+        float value = module->selected_voltage_sequencer->getValue(i);
+
+        // Draw grey background bar
+        if ((int)i < (module->selected_voltage_sequencer->getWindowEnd() + 1))
+        {
+            bar_color = brightness(bright_background_color, settings::rackBrightness);
+        }
+        else
+        {
+            bar_color = brightness(dark_background_color, settings::rackBrightness);
+        }
+
+        drawBar(vg, i, BAR_HEIGHT, DRAW_AREA_HEIGHT, bar_color);
+
+        if (playing)
+        {
+            bar_color = current_step_highlight_color; // Highlight current step
+        }
+        else if ((int)i < (module->selected_voltage_sequencer->getWindowEnd() + 1))
+        {
+            bar_color = lesser_step_highlight_color;
+        }
+        else
+        {
+            bar_color = default_step_highlight_color;
+        }
+
+        if (drawFromCenter()) {
+            float half_height = DRAW_AREA_HEIGHT / 2.0;
+            if (value > 0.5) {
+                // Draw up from center (this works fine)
+                float bar_height = (value - 0.5) * 2 * half_height;
+                drawBar(vg, i, bar_height, half_height, bar_color);
+            } else {
+                // Draw down from center
+                float bar_height = (0.5 - value) * 2 * half_height;
+                // Start at half_height and draw downward by adding height
+                drawBar(vg, i, bar_height, half_height + bar_height, bar_color);
+            }
+        } else {
+            // Original unipolar drawing
+            if (value > 0) {
+                drawBar(vg, i, (value * DRAW_AREA_HEIGHT), DRAW_AREA_HEIGHT, bar_color);
             }
+        }
 
-            nvgRestore(vg);
+        // Highlight the sequence playback column
+        if (playing)
+        {
+            drawBar(vg, i, DRAW_AREA_HEIGHT, DRAW_AREA_HEIGHT, sequence_position_highlight_color);
         }
     }
 
+    // The zero line, guides and overlay, which are drawn over every step
+    void drawDecorations(NVGcontext *vg)
+    {
+        // Draw a horizontal 0-indicator if the range is not symmetrical
+        if (drawFromCenter())
+        {
+            // This calculation for y takes advance of the fact that all
+            // ranges that would have the 0-guide visible are symmetric, so
+            // it will need updating if non-symmetric ranges are added.
+            double y = DRAW_AREA_HEIGHT / 2.0;
+
+            nvgBeginPath(vg);
+            nvgRect(vg, 1, y, (DRAW_AREA_WIDTH - 2), 1.0);
+            nvgFillColor(vg, nvgRGBA(240, 240, 255, 40));
+            nvgFill(vg);
+        }
+
+        drawVerticalGuildes(vg, DRAW_AREA_HEIGHT);
+        drawOverlay(vg, DRAW_AREA_WIDTH, DRAW_AREA_HEIGHT);
+    }
+
     void drawTooltip(NVGcontext *vg)
     {
         nvgSave(vg);
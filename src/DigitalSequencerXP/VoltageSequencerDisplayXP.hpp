@@ -15,6 +15,8 @@ struct VoltageSequencerDisplayXP : SequencerDisplay
     int previous_control_sequence_column = 0;
     int control_sequence_column = 0;
 
+    RetainedLayer *pattern_layer;
+
     VoltageSequencerDisplayXP()
     {
         // The bounding box needs to be a little deeper than the visual
@@ -22,6 +24,9 @@ struct VoltageSequencerDisplayXP : SequencerDisplay
         // which is why 16 is being added to the draw height to define the
         // bounding box.
         box.size = Vec(DRAW_AREA_WIDTH, DRAW_AREA_HEIGHT + 16);
+
+        pattern_layer = new RetainedLayer(Vec(DRAW_AREA_WIDTH, DRAW_AREA_HEIGHT), [this](NVGcontext *vg) { drawPattern(vg); });
+        addChild(pattern_layer);
     }
 
     void drawLayer(const DrawArgs &args, int layer) override
@@ -29,112 +34,37 @@ struct VoltageSequencerDisplayXP : SequencerDisplay
         if (layer == 1)
         {
             const auto vg = args.vg;
-            double value;
-            NVGcolor bar_color;
-            bool draw_from_center = false;
 
             // Save the drawing context to restore later
             nvgSave(vg);
 
             if (module)
             {
-                // OLD CODE
-                // double range_low = module->selected_voltage_sequencer->voltage_ranges[module->selected_voltage_sequencer->voltage_range_index][0];
-                // double range_high = module->selected_voltage_sequencer->voltage_ranges[module->selected_voltage_sequencer->voltage_range_index][1];
-
-                // NEW CODE
-                unsigned int voltage_range_index = module->voltage_range_indexes[module->selected_sequencer_index];
-                double range_low = module->voltage_ranges[voltage_range_index][0];
-                double range_high = module->voltage_ranges[voltage_range_index][1];
+                // The pattern is only drawn again when it changes
+                pattern_layer->update(patternKey());
+                pattern_layer->drawRetained(args);
 
-                if (range_low < 0 && range_high > 0)
-                    draw_from_center = true;
-
-                //
-                // Display the pattern
-                //
-                for (unsigned int i = 0; i < MAX_SEQUENCER_STEPS; i++)
-                {
-                    value = module->selected_voltage_sequencer->getValue(i);
-
-                    // Draw grey background bar
-                    if ((int)i < (module->selected_voltage_sequencer->getWindowEnd() + 1))
-                    {
-                        bar_color = brightness(bright_background_color, settings::rackBrightness);
-                    }
-                    else
-                    {
-                        bar_color = brightness(dark_background_color, settings::rackBrightness);
-                    }
-
-                    drawBar(vg, i, BAR_HEIGHT, DRAW_AREA_HEIGHT, bar_color); // background
-
-                    if ((int)i == module->selected_voltage_sequencer->getPlaybackPosition())
-                    {
-                        bar_color = current_step_highlight_color; // Highlight current step
-                    }
-                    else if ((int)i < (module->selected_voltage_sequencer->getWindowEnd() + 1))
-                    {
-                        bar_color = lesser_step_highlight_color;
-                    }
-                    else
-                    {
-                        bar_color = default_step_highlight_color;
-                    }
-
-                    // Draw bars for the sequence values
-                    if (draw_from_center) {
-                        float half_height = DRAW_AREA_HEIGHT / 2.0;
-                        if (value > 0.5) {
-                            // Draw up from center
-                            float bar_height = (value - 0.5) * 2 * half_height;
-                            drawBar(vg, i, bar_height, half_height, bar_color);
-                        } else {
-                            // Draw down from center
-                            float bar_height = (0.5 - value) * 2 * half_height;
-                            drawBar(vg, i, bar_height, half_height + bar_height, bar_color);
-                        }
-                    } else {
-                        // Original unipolar drawing
-                        if (value > 0) {
-                            drawBar(vg, i, (value * DRAW_AREA_HEIGHT), DRAW_AREA_HEIGHT, bar_color);
-                        }
-                    }
-
-                    // Highlight the sequence playback column
-                    if ((int)i == module->selected_voltage_sequencer->getPlaybackPosition())
-                    {
-                        drawBar(vg, i, DRAW_AREA_HEIGHT, DRAW_AREA_HEIGHT, sequence_position_highlight_color);
-                    }
-                }
+                // The playhead's column is painted again on top of the cached
+                // pattern, from the background up, and clipped to the column so
+                // that the guides and overlay stay exactly as they were.
+                int playback_position = module->selected_voltage_sequencer->getPlaybackPosition();
 
-                // Draw a horizontal 0-indicator if the range is not symmetrical
-                if (draw_from_center)
+                if (playback_position >= 0 && playback_position < MAX_SEQUENCER_STEPS)
                 {
-                    // This calculation for y takes advance of the fact that all
-                    // ranges that would have the 0-guide visible are symmetric, so
-                    // it will need updating if non-symmetric ranges are added.
-                    double y = DRAW_AREA_HEIGHT / 2.0;
-
-                    nvgBeginPath(vg);
-                    nvgRect(vg, 1, y, (DRAW_AREA_WIDTH - 2), 1.0);
-                    nvgFillColor(vg, nvgRGBA(240, 240, 255, 40));
-                    nvgFill(vg);
+                    nvgSave(vg);
+                    nvgIntersectScissor(vg, (playback_position * bar_width) + (playback_position * BAR_HORIZONTAL_PADDING), 0, bar_width, DRAW_AREA_HEIGHT);
+                    drawStep(vg, playback_position, true);
+                    drawDecorations(vg);
+                    nvgRestore(vg);
                 }
 
-                // Draw label, if there is one
-                std::string to_display = module->labels[module->selected_sequencer_index];
+                if (module->tooltip_timer > 0)
+                    draw_tooltip = true;
 
-                if (to_display != "")
+                if (draw_tooltip)
                 {
-                    nvgFontSize(args.vg, 14);
-                    nvgTextLetterSpacing(args.vg, 0);
-                    nvgFillColor(args.vg, nvgRGBA(255, 255, 255, 0xff));
-                    nvgTextAlign(args.vg, NVG_ALIGN_CENTER);
-                    float x_position = DRAW_AREA_HEIGHT / 2;
-                    float y_position = 16;
-                    float wrap_at = 275.0; // Just throw your hands in the air!  And wave them like you just don't 274.0
-                    nvgTextBox(args.vg, x_position, y_position, wrap_at, to_display.c_str(), NULL);
+                    drawTooltip(vg);
+                    draw_tooltip = false;
                 }
             }
             else // Draw a demo sequence so that the sequencer looks nice in the library selector
@@ -153,27 +83,157 @@ struct VoltageSequencerDisplayXP : SequencerDisplay
                     if (i == 5)
                         drawBar(vg, i, DRAW_AREA_HEIGHT, DRAW_AREA_HEIGHT, nvgRGBA(255, 255, 255, 20));
                 }
+
+                drawVerticalGuildes(vg, DRAW_AREA_HEIGHT);
+                drawOverlay(vg, OVERLAY_WIDTH, DRAW_AREA_HEIGHT);
             }
 
-            drawVerticalGuildes(vg, DRAW_AREA_HEIGHT);
-            drawOverlay(vg, OVERLAY_WIDTH, DRAW_AREA_HEIGHT);
+            nvgRestore(vg);
+        }
+    }
 
-            if (module)
-            {
-                if (module->tooltip_timer > 0)
-                    draw_tooltip = true;
+    // Everything that the cached pattern depends on
+    RetainedLayerKey patternKey()
+    {
+        RetainedLayerKey key;
 
-                if (draw_tooltip)
-                {
-                    drawTooltip(vg);
-                    draw_tooltip = false;
-                }
+        for (unsigned int i = 0; i < MAX_SEQUENCER_STEPS; i++)
+        {
+            key.add(module->selected_voltage_sequencer->getValue(i));
+        }
+
+        key.add(module->selected_voltage_sequencer->getWindowEnd());
+        key.add(drawFromCenter());
+        key.add(module->labels[module->selected_sequencer_index]);
+        key.add(settings::rackBrightness);
+
+        return(key);
+    }
+
+    bool drawFromCenter()
+    {
+        // OLD CODE
+        // double range_low = module->selected_voltage_sequencer->voltage_ranges[module->selected_voltage_sequencer->voltage_range_index][0];
+        // double range_high = module->selected_voltage_sequencer->voltage_ranges[module->selected_voltage_sequencer->voltage_range_index][1];
+
+        // NEW CODE
+        unsigned int voltage_range_index = module->voltage_range_indexes[module->selected_sequencer_index];
+        double range_low = module->voltage_ranges[voltage_range_index][0];
+        double range_high = module->voltage_ranges[voltage_range_index][1];
+
+        return(range_low < 0 && range_high > 0);
+    }
+
+    //
+    // void drawPattern(NVGcontext *vg)
+    //
+    // Draws the pattern without the playhead.  This is what pattern_layer
+    // keeps in its framebuffer.
+    //
+    void drawPattern(NVGcontext *vg)
+    {
+        if (! module) return;
+
+        for (unsigned int i = 0; i < MAX_SEQUENCER_STEPS; i++)
+        {
+            drawStep(vg, i, false);
+        }
+
+        drawDecorations(vg);
+    }
+
+    void drawStep(NVGcontext *vg, unsigned int i, bool playing)
+    {
+        NVGcolor bar_color;
+        double value = module->selected_voltage_sequencer->getValue(i);
+
+        // Draw grey background bar
+        if ((int)i < (module->selected_voltage_sequencer->getWindowEnd() + 1))
+        {
+            bar_color = brightness(bright_background_color, settings::rackBrightness);
+        }
+        else
+        {
+            bar_color = brightness(dark_background_color, settings::rackBrightness);
+        }
+
+        drawBar(vg, i, BAR_HEIGHT, DRAW_AREA_HEIGHT, bar_color); // background
+
+        if (playing)
+        {
+            bar_color = current_step_highlight_color; // Highlight current step
+        }
+        else if ((int)i < (module->selected_voltage_sequencer->getWindowEnd() + 1))
+        {
+            bar_color = lesser_step_highlight_color;
+        }
+        else
+        {
+            bar_color = default_step_highlight_color;
+        }
+
+        // Draw bars for the sequence values
+        if (drawFromCenter()) {
+            float half_height = DRAW_AREA_HEIGHT / 2.0;
+            if (value > 0.5) {
+                // Draw up from center
+                float bar_height = (value - 0.5) * 2 * half_height;
+                drawBar(vg, i, bar_height, half_height, bar_color);
+            } else {
+                // Draw down from center
+                float bar_height = (0.5 - value) * 2 * half_height;
+                drawBar(vg, i, bar_height, half_height + bar_height, bar_color);
             }
+        } else {
+            // Original unipolar drawing
+            if (value > 0) {
+                drawBar(vg, i, (value * DRAW_AREA_HEIGHT), DRAW_AREA_HEIGHT, bar_color);
+            }
+        }
 
-            nvgRestore(vg);
+        // Highlight the sequence playback column
+        if (playing)
+        {
+            drawBar(vg, i, DRAW_AREA_HEIGHT, DRAW_AREA_HEIGHT, sequence_position_highlight_color);
         }
     }
 
+    // The zero line, label, guides and overlay, which are drawn over every step
+    void drawDecorations(NVGcontext *vg)
+    {
+        // Draw a horizontal 0-indicator if the range is not symmetrical
+        if (drawFromCenter())
+        {
+            // This calculation for y takes advance of the fact that all
+            // ranges that would have the 0-guide visible are symmetric, so
+            // it will need updating if non-symmetric ranges are added.
+            double y = DRAW_AREA_HEIGHT / 2.0;
+
+            nvgBeginPath(vg);
+            nvgRect(vg, 1, y, (DRAW_AREA_WIDTH - 2), 1.0);
+            nvgFillColor(vg, nvgRGBA(240, 240, 255, 40));
+            nvgFill(vg);
+        }
+
+        // Draw label, if there is one
+        std::string to_display = module->labels[module->selected_sequencer_index];
+
+        if (to_display != "")
+        {
+            nvgFontSize(vg, 14);
+            nvgTextLetterSpacing(vg, 0);
+            nvgFillColor(vg, nvgRGBA(255, 255, 255, 0xff));
+            nvgTextAlign(vg, NVG_ALIGN_CENTER);
+            float x_position = DRAW_AREA_HEIGHT / 2;
+            float y_position = 16;
+            float wrap_at = 275.0; // Just throw your hands in the air!  And wave them like you just don't 274.0
+            nvgTextBox(vg, x_position, y_position, wrap_at, to_display.c_str(), NULL);
+        }
+
+        drawVerticalGuildes(vg, DRAW_AREA_HEIGHT);
+        drawOverlay(vg, OVERLAY_WIDTH, DRAW_AREA_HEIGHT);
+    }
+
     void drawTooltip(NVGcontext *vg)
     {
         nvgSave(vg);
@@ -15,6 +15,7 @@ using namespace groove_box;
 
 #include "vgLib-2.0/constants.h"
 #include "vgLib-2.0/components/VoxglitchComponents.hpp"
+#include "vgLib-2.0/widgets/RetainedLayer.hpp"
 #include "GrooveBox/ParameterLockSettings.hpp"
 #include "GrooveBoxExpander/ExpanderToGrooveboxMessage.hpp"
 #include "GrooveBox/GrooveboxToExpanderMessage.hpp"
@@ -30,6 +31,8 @@ using namespace groove_box;
 #include "vgLib-2.0/dsp/FastSlewLimiter.hpp"
 #include "vgLib-2.0/dsp/Random.hpp"
 #include "vgLib-2.0/SamplePlayer.hpp"
+#include "vgLib-2.0/SampleFolderIndex.hpp"
+#include "vgLib-2.0/SamplePrefetcher.hpp"
 
 using namespace vgLib_v2;
 
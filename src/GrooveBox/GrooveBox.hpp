@@ -106,6 +106,10 @@ struct GrooveBox : VoxglitchSamplerModule
 
     SamplePlayer sample_players[NUMBER_OF_TRACKS];
 
+    // Decodes the samples on either side of each track's sample in the
+    // background, so that the nudge buttons can swap them in instantly.
+    SamplePrefetcher sample_prefetcher{NUMBER_OF_TRACKS};
+
     // Each of the 8 tracks has dedicated slew limiters:
     FastSlewLimiter volume_slew_limiters[NUMBER_OF_TRACKS];
     FastSlewLimiter pan_slew_limiters[NUMBER_OF_TRACKS];
@@ -246,6 +250,13 @@ struct GrooveBox : VoxglitchSamplerModule
             delay_dsps[i].setBufferSize(APP->engine->getSampleRate() / 30.0);
         }
 
+        // The sample start snap uses the transients found when a sample loads
+        for (unsigned int i = 0; i < NUMBER_OF_TRACKS; i++)
+        {
+            sample_players[i].sample.analyze_on_load = true;
+        }
+        sample_prefetcher.analyze_on_load = true;
+
         // Configure the individual track outputs
         for (unsigned int i = 0; i < (NUMBER_OF_TRACKS * 2); i += 2)
         {
@@ -578,6 +589,75 @@ struct GrooveBox : VoxglitchSamplerModule
     {
         sample_players[track_index].releaseSample();
         loaded_filenames[track_index] = "";
+        sample_prefetcher.prefetch(track_index, {});
+    }
+
+    //
+    // nudgeSample
+    //
+    // Step a track to the previous (-1) or next (1) sample in its folder.  If
+    // that sample has already been prefetched, it's swapped in with a short
+    // crossfade.  Otherwise it's loaded from disk, as usual.  This is called
+    // from the UI thread.
+    //
+    void nudgeSample(unsigned int track_index, int direction)
+    {
+        SamplePlayer &sample_player = sample_players[track_index];
+
+        std::string directory = rack::system::getDirectory(sample_player.getPath());
+        std::shared_ptr<const SampleFolderIndex::Folder> folder = SampleFolderIndex::getFolder(directory);
+
+        int index = SampleFolderIndex::find(*folder, sample_player.getFilename());
+        if (index < 0) return;
+
+        int nudged_index = clamp(index + direction, 0, (int) folder->paths.size() - 1);
+        if (nudged_index == index) return;
+
+        std::string nudged_path = folder->paths[nudged_index];
+        std::shared_ptr<PendingSample> pending = sample_prefetcher.take(nudged_path, getPrefetchSampleRate(track_index));
+
+        if (pending)
+        {
+            sample_player.swapSample(pending);
+        }
+        else
+        {
+            sample_player.loadSample(nudged_path);
+        }
+
+        loaded_filenames[track_index] = sample_player.getFilename();
+        setRoot(nudged_path);
+
+        prefetchNeighbours(track_index);
+    }
+
+    // Start decoding the two samples on either side of the track's sample,
+    // nearest first.
+    void prefetchNeighbours(unsigned int track_index)
+    {
+        SamplePlayer &sample_player = sample_players[track_index];
+        if (sample_player.getPath() == "") return;
+
+        std::string directory = rack::system::getDirectory(sample_player.getPath());
+        std::shared_ptr<const SampleFolderIndex::Folder> folder = SampleFolderIndex::getFolder(directory);
+
+        int index = SampleFolderIndex::find(*folder, sample_player.getFilename());
+        if (index < 0) return;
+
+        std::vector<std::string> neighbours;
+
+        for (int offset : {1, -1, 2, -2})
+        {
+            int neighbour_index = index + offset;
+            if (neighbour_index >= 0 && neighbour_index < (int) folder->paths.size()) neighbours.push_back(folder->paths[neighbour_index]);
+        }
+
+        sample_prefetcher.prefetch(track_index, neighbours, getPrefetchSampleRate(track_index));
+    }
+
+    uint32_t getPrefetchSampleRate(unsigned int track_index)
+    {
+        return(sample_players[track_index].resample_on_load ? APP->engine->getSampleRate() : 0);
     }
 
     void importKitDialog(const std::string& kit_path)
@@ -127,7 +127,20 @@ namespace groove_box
           // If the sample start settings is set and snap is on, then quantize the sample start position.
           float sample_start = m.local_parameter_lock_settings.getParameter(SAMPLE_START);
 
-          if (sample_position_snap_value > 0 && sample_start > 0)
+          if (sample_position_snap_value == SAMPLE_POSITION_SNAP_TRANSIENTS)
+          {
+            // The transients were found when the sample was loaded, so this
+            // is only a binary search.
+            unsigned int sample_size = sample_player->sample.size();
+
+            if (sample_start > 0 && sample_size > 0)
+            {
+              double snapped_position = sample_player->sample.slices.snap(sample_start * sample_size, sample_size);
+              m.local_parameter_lock_settings.setParameter(SAMPLE_START, snapped_position / (double) sample_size);
+              sample_start = m.local_parameter_lock_settings.getParameter(SAMPLE_START);
+            }
+          }
+          else if (sample_position_snap_value > 0 && sample_start > 0)
           {
             // settings.sample_start ranges from 0 to 1
             // This next line sets quantized_sample_start to an integer between 0 and sample_position_snap
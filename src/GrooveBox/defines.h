@@ -4,9 +4,12 @@ namespace groove_box
     const int NUMBER_OF_TRACKS = 8;
     const int NUMBER_OF_MEMORY_SLOTS = 16;
     const int NUMBER_OF_PARAMETER_LOCKS = 16;
-    const int NUMBER_OF_SAMPLE_POSITION_SNAP_OPTIONS = 8;
+    const int NUMBER_OF_SAMPLE_POSITION_SNAP_OPTIONS = 9;
     const int NUMBER_OF_RATCHET_PATTERNS = 16;
 
+    // Snaps the sample start to the nearest transient found by the OnsetDetector
+    const unsigned int SAMPLE_POSITION_SNAP_TRANSIENTS = 0xFFFFFFFF;
+
     const float MODULE_WIDTH = 223.52000 * 2.952756;
     const float MODULE_HEIGHT = 128.50000 * 2.952756;
 
@@ -123,7 +126,8 @@ namespace groove_box
         "32",
         "64",
         "128",
-        "256"};
+        "256",
+        "transients"};
 
     const unsigned int sample_position_snap_values[NUMBER_OF_SAMPLE_POSITION_SNAP_OPTIONS] = {
         0,
@@ -133,7 +137,8 @@ namespace groove_box
         32,
         64,
         128,
-        256};
+        256,
+        SAMPLE_POSITION_SNAP_TRANSIENTS};
 
     const bool ratchet_patterns[NUMBER_OF_RATCHET_PATTERNS][7] = {
         {0, 0, 0, 0, 0, 0, 0},
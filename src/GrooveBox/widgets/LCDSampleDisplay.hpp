@@ -9,6 +9,8 @@ struct LCDSampleDisplay : LCDDisplay
   unsigned int columns = 390;
   float stroke_width = 1;
 
+  RetainedLayer *waveform_layer;
+
   LCDSampleDisplay(GrooveBox *module)
   {
     this->module = module;
@@ -21,6 +23,55 @@ struct LCDSampleDisplay : LCDDisplay
     // this->height = height;
     this->mid_height = box.size.y / 2.0;
     // this->box.size = Vec(width, height);
+
+    waveform_layer = new RetainedLayer(box.size, [this](NVGcontext *vg) { drawWaveform(vg); });
+    addChild(waveform_layer);
+  }
+
+  // Everything that the cached waveform depends on
+  RetainedLayerKey waveformKey()
+  {
+    Sample *active_sample = &module->selected_track->sample_player->sample;
+    RetainedLayerKey key;
+
+    key.add(active_sample);
+    key.add(active_sample->path);
+    key.add(active_sample->loaded);
+    key.add(active_sample->size());
+
+    return(key);
+  }
+
+  void drawWaveform(NVGcontext *vg)
+  {
+    if (! module) return;
+
+    Sample *active_sample = &module->selected_track->sample_player->sample;
+
+    unsigned int sample_size = active_sample->size();
+    unsigned int index_offset = sample_size / columns;
+
+    for (unsigned int i = 0; i < columns; i++)
+    {
+      unsigned int sample_index = index_offset * i;
+
+      float left_audio = 0;
+      float right_audio = 0;
+
+      active_sample->read(sample_index, &left_audio, &right_audio);
+
+      left_audio = clamp(left_audio * 0.5f, -0.5, 0.5);
+
+      float rect_height = ((box.size.y - ( 2.0 * display_padding)) * left_audio);
+      float rect_x = display_padding + (((box.size.x - (2.0 * display_padding)) / columns) * i);
+
+      nvgBeginPath(vg);
+      nvgStrokeWidth(vg, stroke_width);
+      nvgStrokeColor(vg, nvgRGB(255, 255, 255));
+      nvgMoveTo(vg, rect_x, mid_height);
+      nvgLineTo(vg, rect_x, mid_height + rect_height);
+      nvgStroke(vg);
+    }
   }
 
   void drawLayer(const DrawArgs &args, int layer) override
@@ -35,36 +86,9 @@ struct LCDSampleDisplay : LCDDisplay
 
         if (module->lcd_screen_mode == module->SAMPLE)
         {
-          Sample *active_sample = &module->selected_track->sample_player->sample;
-
-          unsigned int sample_size = active_sample->size();
-          unsigned int index_offset = sample_size / columns;
-
-          //
-          // Draw waveform
-          //
-
-          for (unsigned int i = 0; i < columns; i++)
-          {
-            unsigned int sample_index = index_offset * i;
-
-            float left_audio = 0;
-            float right_audio = 0;
-
-            active_sample->read(sample_index, &left_audio, &right_audio);
-
-            left_audio = clamp(left_audio * 0.5f, -0.5, 0.5);
-
-            float rect_height = ((box.size.y - ( 2.0 * display_padding)) * left_audio);
-            float rect_x = display_padding + (((box.size.x - (2.0 * display_padding)) / columns) * i);
-
-            nvgBeginPath(vg);
-            nvgStrokeWidth(vg, stroke_width);
-            nvgStrokeColor(vg, nvgRGB(255, 255, 255));
-            nvgMoveTo(vg, rect_x, mid_height);
-            nvgLineTo(vg, rect_x, mid_height + rect_height);
-            nvgStroke(vg);
-          }
+          // The waveform is only drawn again when the sample changes
+          waveform_layer->update(waveformKey());
+          waveform_layer->drawRetained(args);
 
           //
           // Draw range rectangle
@@ -10,10 +10,15 @@ struct TrackLabelDisplay : TransparentWidget
     GrooveBox *module;
     unsigned int track_number = 0;
 
+    RetainedLayer *label_layer;
+
     TrackLabelDisplay(unsigned int track_number, float width, float height)
     {
         this->track_number = track_number;
         box.size = Vec(width, height);
+
+        label_layer = new RetainedLayer(box.size, [this](NVGcontext *vg) { drawLabel(vg); });
+        addChild(label_layer);
     }
 
     void onDoubleClick(const event::DoubleClick &e) override
@@ -115,6 +120,39 @@ struct TrackLabelDisplay : TransparentWidget
         nvgFill(vg);
     }
 
+    // Everything that the cached label depends on
+    RetainedLayerKey labelKey()
+    {
+        RetainedLayerKey key;
+
+        key.add(module->sample_players[track_number].getFilename());
+        key.add(module->track_index == this->track_number);
+        key.add(LCDColorScheme::selected_color_scheme);
+
+        return(key);
+    }
+
+    void drawLabel(NVGcontext *vg)
+    {
+        if (! module) return;
+
+        NVGcolor backgroundColor;
+
+        if (module->track_index == this->track_number)
+        {
+            backgroundColor = LCDColorScheme::getLightColor();
+        }
+        else
+        {
+            backgroundColor = LCDColorScheme::getDarkColor();
+        }
+
+        std::string to_display = module->sample_players[track_number].getFilename();
+
+        // Always draw the background
+        draw_track_label(to_display, vg, backgroundColor);
+    }
+
     void drawLayer(const DrawArgs &args, int layer) override
     {
         if (layer == 1)
@@ -134,19 +172,9 @@ struct TrackLabelDisplay : TransparentWidget
                     return;
                 }
 
-                if (module->track_index == this->track_number)
-                {
-                    backgroundColor = LCDColorScheme::getLightColor();
-                }
-                else
-                {
-                    backgroundColor = LCDColorScheme::getDarkColor();
-                }
-
-                std::string to_display = module->sample_players[track_number].getFilename();
-
-                // Always draw the background
-                draw_track_label(to_display, vg, backgroundColor);
+                // The label is only drawn again when it changes
+                label_layer->update(labelKey());
+                label_layer->drawRetained(args);
             }
             else
             {
@@ -319,40 +347,9 @@ struct TrackSampleNudge : TransparentWidget
         {
             module->selectTrack(this->track_number);
 
-            std::string path = module->sample_players[track_number].getPath();
-            std::string directory = rack::system::getDirectory(path);
-            std::string filename = module->sample_players[track_number].getFilename();
-
-            std::vector<std::string> directory_list = system::getEntries(directory);
-            std::vector<std::string> wav_files;
-
-            // Folders might contain things that aren't .wav files, and we need to
-            // weed those out. In order to do that, we iterate over the directory list
-            // and populate a new vector called "wav_files".
-            for (auto entry : directory_list)
-            {
-                if (
-                    (rack::string::lowercase(system::getExtension(entry)) == "wav") ||
-                    (rack::string::lowercase(system::getExtension(entry)) == ".wav"))
-                {
-                    wav_files.push_back(entry);
-                }
-            }
-
-            // Now that we have a clean list, search for the currently selected
-            // wav file.  If we find it (which we should), find the next sample.
-            for (unsigned i = 0; i < wav_files.size(); i++)
-            {
-                std::string filename_in_directory = rack::system::getFilename(wav_files[i]);
-
-                if (filename_in_directory.compare(filename) == 0) // Found it!
-                {
-                    int index = i + direction;
-                    index = clamp(index, 0, wav_files.size() - 1);
-                    fileSelected(this->module, this->track_number, wav_files[index]);
-                    break;
-                }
-            }
+            // The folder listing is cached, and the neighbouring samples are
+            // usually decoded already, so this doesn't touch the disk.
+            module->nudgeSample(this->track_number, direction);
 
             e.consume(this);
         }
@@ -361,6 +358,10 @@ struct TrackSampleNudge : TransparentWidget
     void onEnter(const event::Enter &e) override
     {
         TransparentWidget::onEnter(e);
+
+        // Hovering over the nudge buttons is a good hint that they're about to
+        // be used, so get the neighbouring samples ready.
+        if (module) module->prefetchNeighbours(this->track_number);
     }
 
     void onLeave(const event::Leave &e) override
@@ -374,16 +375,6 @@ struct TrackSampleNudge : TransparentWidget
         e.consume(this);
     }
 
-    static void fileSelected(GrooveBox *module, unsigned int track_number, std::string filename)
-    {
-        if (filename != "")
-        {
-            module->sample_players[track_number].loadSample(filename);
-            module->loaded_filenames[track_number] = module->sample_players[track_number].getFilename();
-            module->setRoot(filename);
-        }
-    }
-
     void drawLayer(const DrawArgs &args, int layer) override
     {
         if (layer == 1)
@@ -7,6 +7,7 @@
 #include "settings.hpp"
 
 #include "vgLib-2.0/constants.h"
+#include "vgLib-2.0/SequenceFile.hpp"
 
 #include "vgLib-2.0/components/VoxglitchComponents.hpp"
 #include "vgLib-2.0/sequencer/Sequencer.hpp"
@@ -26,7 +26,11 @@ struct OnePoint : VoxglitchModule
     dsp::PulseGenerator nextPulse;
     dsp::PulseGenerator zeroPulse;
 
-    std::vector<std::vector<float>> sequences;
+    // The sequences are loaded on a background thread.  process() picks up
+    // the latest table with sequence_loader.update() and reads it through
+    // sequence_loader.get().
+    SequenceLoader<float> sequence_loader{SequenceFile::NUMBERS};
+    int pending_selected_sequence = -1;
     unsigned int step = 0;
     unsigned int selected_sequence = 0;
     unsigned int real_selected_sequence = 0;
@@ -110,17 +114,14 @@ struct OnePoint : VoxglitchModule
         if (loaded_path_json)
         {
             this->path = json_string_value(loaded_path_json);
-            this->loadData(this->path);
-            
-            // Restore the selected sequence if it exists in the saved data
+
+            // Restore the selected sequence once the file has loaded, if it
+            // exists in the file.  See onSequencesLoaded().
             json_t *loaded_sequence_json = json_object_get(json_root, "selected_sequence");
             if (loaded_sequence_json)
-            {
-                unsigned int loaded_sequence = json_integer_value(loaded_sequence_json);
-                // Make sure the loaded sequence is valid
-                if (loaded_sequence < sequences.size())
-                    this->selectNewSequence(loaded_sequence);
-            }
+                pending_selected_sequence = json_integer_value(loaded_sequence_json);
+
+            this->loadData(this->path);
         }
     }
 
@@ -151,27 +152,47 @@ struct OnePoint : VoxglitchModule
     void selectNewSequence(unsigned int new_sequence) {
         selected_sequence = new_sequence;
         // Ensure step is valid for the new sequence
-        if (step >= sequences[selected_sequence].size()) {
+        if (step >= sequence_loader.get()->length(selected_sequence)) {
             step = 0;
         }
     }    
 
+    // Called from process() when a newly loaded file arrives
+    void onSequencesLoaded()
+    {
+        unsigned int sequence_count = sequence_loader.get()->size();
+
+        if (pending_selected_sequence >= 0 && (unsigned int)pending_selected_sequence < sequence_count)
+            selected_sequence = pending_selected_sequence;
+        else if (selected_sequence >= sequence_count)
+            selected_sequence = 0;
+
+        pending_selected_sequence = -1;
+        real_selected_sequence = selected_sequence;
+        reset();
+    }
+
     void process(const ProcessArgs &args) override
     {
-        if (sequences.empty())
+        if (sequence_loader.update())
+            onSequencesLoaded();
+
+        const SequenceTable<float> *sequences = sequence_loader.get();
+
+        if (sequences->empty())
             return;
 
         // Process NEXT trigger and button
         if (next_sequence_trigger.process(inputs[NEXT_SEQUENCE_INPUT].getVoltage(), constants::gate_low_trigger, constants::gate_high_trigger) || next_sequence_button_trigger.process(params[NEXT_BUTTON_PARAM].getValue()))
         {
-            selectNewSequence((selected_sequence + 1) % sequences.size());
+            selectNewSequence((selected_sequence + 1) % sequences->size());
             nextPulse.trigger(1e-3f);
         }
 
         // Process PREV trigger and button
         if (prev_sequence_trigger.process(inputs[PREV_SEQUENCE_INPUT].getVoltage(), constants::gate_low_trigger, constants::gate_high_trigger) || prev_sequence_button_trigger.process(params[PREV_BUTTON_PARAM].getValue()))
         {
-            unsigned int new_sequence = (selected_sequence == 0) ? sequences.size() - 1 : selected_sequence - 1;
+            unsigned int new_sequence = (selected_sequence == 0) ? sequences->size() - 1 : selected_sequence - 1;
             selectNewSequence(new_sequence);
             prevPulse.trigger(1e-3f);
         }
@@ -194,7 +215,7 @@ struct OnePoint : VoxglitchModule
         // Adjust selected sequence based on CV input (if connected)
         if (inputs[CV_SEQUENCE_SELECT].isConnected())
         {
-            unsigned int sequence_count = sequences.size() - 1; // 20
+            unsigned int sequence_count = sequences->size() - 1; // 20
             float sequence_select_cv = inputs[CV_SEQUENCE_SELECT].getVoltage() * params[CV_SEQUENCE_ATTN_KNOB].getValue();
             int cv_sequence_value = (int)rescale(sequence_select_cv, -5.0, 5.0, -20, 20);
 
@@ -207,7 +228,7 @@ struct OnePoint : VoxglitchModule
 
         // If we've changed sequences via CV, ensure step is valid for the new sequence
         if (previous_real_selected_sequence != real_selected_sequence) {
-            if (step >= sequences[real_selected_sequence].size()) {
+            if (step >= sequences->length(real_selected_sequence)) {
                 step = 0;
             }
         }
@@ -227,14 +248,14 @@ struct OnePoint : VoxglitchModule
                 step++;
 
                 // If we're at the end of the sequencer, wrap to the beginning
-                if (step == sequences[real_selected_sequence].size())
+                if (step == sequences->length(real_selected_sequence))
                 {
                     step = 0;
                     eol_pulse_generator.trigger(0.01f);
                 }
             }
 
-            // if (sequences[real_selected_sequence][step])
+            // if (sequences->at(real_selected_sequence, step))
             //     output_pulse_generator.trigger(0.01f);
         }
 
@@ -262,7 +283,7 @@ struct OnePoint : VoxglitchModule
         //
 
         // bool output_pulse = output_pulse_generator.process(1.0 / args.sampleRate);
-        outputs[CV_OUTPUT].setVoltage(sequences[real_selected_sequence][step]);
+        outputs[CV_OUTPUT].setVoltage(sequences->at(real_selected_sequence, step));
 
         bool eol_pulse = eol_pulse_generator.process(1.0 / args.sampleRate);
         outputs[EOL_OUTPUT].setVoltage((eol_pulse ? 10.0f : 0.0f));
@@ -270,31 +291,9 @@ struct OnePoint : VoxglitchModule
 
     void loadData(std::string path)
     {
-        // Clear out existing data
-        sequences.clear();
-
-        FILE* input_file = fopen(path.c_str(), "r");
-        if (input_file)
-        {
-            char line[1024]; // Buffer for reading lines
-            while (fgets(line, sizeof(line), input_file))
-            {
-                std::vector<float> sequence;
-                char* token = strtok(line, ",\n");
-                
-                while (token != NULL)
-                {
-                    sequence.push_back(std::stof(token));
-                    token = strtok(NULL, ",\n");
-                }
-
-                sequences.push_back(sequence);
-            }
-
-            fclose(input_file);
-        }
-
-        reset();
+        // The new sequences replace the old ones when they've loaded.  Then
+        // onSequencesLoaded() resets playback.
+        sequence_loader.load(path);
     }
 
 #ifndef USING_CARDINAL_NOT_RACK
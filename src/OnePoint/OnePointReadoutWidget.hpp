@@ -27,7 +27,7 @@ struct OnePointReadoutWidget : TransparentWidget
 
         if (module)
         {
-            if(module->sequences.empty())
+            if(module->sequence_loader.size() == 0)
             {
                 text_to_display = "NO DATA";
             }
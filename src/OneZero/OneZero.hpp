@@ -26,7 +26,11 @@ struct OneZero : VoxglitchModule
     dsp::PulseGenerator nextPulse;
     dsp::PulseGenerator zeroPulse;
 
-    std::vector<std::vector<bool>> sequences;
+    // The sequences are loaded on a background thread.  process() picks up
+    // the latest table with sequence_loader.update() and reads it through
+    // sequence_loader.get().
+    SequenceLoader<uint8_t> sequence_loader{SequenceFile::BITS};
+    int pending_selected_sequence = -1;
     unsigned int step = 0;
     unsigned int selected_sequence = 0;
     unsigned int real_selected_sequence = 0;
@@ -110,17 +114,14 @@ struct OneZero : VoxglitchModule
         if (loaded_path_json)
         {
             this->path = json_string_value(loaded_path_json);
-            this->loadData(this->path);
-            
-            // Restore the selected sequence if it exists in the saved data
+
+            // Restore the selected sequence once the file has loaded, if it
+            // exists in the file.  See onSequencesLoaded().
             json_t *loaded_sequence_json = json_object_get(json_root, "selected_sequence");
             if (loaded_sequence_json)
-            {
-                unsigned int loaded_sequence = json_integer_value(loaded_sequence_json);
-                // Make sure the loaded sequence is valid
-                if (loaded_sequence < sequences.size())
-                    this->selected_sequence = loaded_sequence;
-            }
+                pending_selected_sequence = json_integer_value(loaded_sequence_json);
+
+            this->loadData(this->path);
         }       
     }
 
@@ -148,22 +149,42 @@ struct OneZero : VoxglitchModule
         return kLowerBound + (kX - kLowerBound) % range_size;
     }
 
+    // Called from process() when a newly loaded file arrives
+    void onSequencesLoaded()
+    {
+        unsigned int sequence_count = sequence_loader.get()->size();
+
+        if (pending_selected_sequence >= 0 && (unsigned int)pending_selected_sequence < sequence_count)
+            selected_sequence = pending_selected_sequence;
+        else if (selected_sequence >= sequence_count)
+            selected_sequence = 0;
+
+        pending_selected_sequence = -1;
+        real_selected_sequence = selected_sequence;
+        reset();
+    }
+
     void process(const ProcessArgs &args) override
     {
-        if (sequences.empty())
+        if (sequence_loader.update())
+            onSequencesLoaded();
+
+        const SequenceTable<uint8_t> *sequences = sequence_loader.get();
+
+        if (sequences->empty())
             return;
 
         // Process NEXT trigger and button
         if (next_sequence_trigger.process(inputs[NEXT_SEQUENCE_INPUT].getVoltage(), constants::gate_low_trigger, constants::gate_high_trigger) || next_sequence_button_trigger.process(params[NEXT_BUTTON_PARAM].getValue()))
         {
-            selected_sequence = ((selected_sequence + 1) % sequences.size());
+            selected_sequence = ((selected_sequence + 1) % sequences->size());
             nextPulse.trigger(1e-3f);
         }
 
         // Process PREV trigger and button
         if (prev_sequence_trigger.process(inputs[PREV_SEQUENCE_INPUT].getVoltage(), constants::gate_low_trigger, constants::gate_high_trigger) || prev_sequence_button_trigger.process(params[PREV_BUTTON_PARAM].getValue()))
         {
-            selected_sequence = (selected_sequence == 0) ? sequences.size() - 1 : selected_sequence - 1;
+            selected_sequence = (selected_sequence == 0) ? sequences->size() - 1 : selected_sequence - 1;
             prevPulse.trigger(1e-3f);
         }
 
@@ -183,7 +204,7 @@ struct OneZero : VoxglitchModule
         // Adjust selected sequence based on CV input (if connected)
         if (inputs[CV_SEQUENCE_SELECT].isConnected())
         {
-            unsigned int sequence_count = sequences.size() - 1;  // 20
+            unsigned int sequence_count = sequences->size() - 1;  // 20
             float sequence_select_cv = inputs[CV_SEQUENCE_SELECT].getVoltage() * params[CV_SEQUENCE_ATTN_KNOB].getValue();
             int cv_sequence_value = (int) rescale(sequence_select_cv, -5.0, 5.0, -20, 20);
 
@@ -194,6 +215,13 @@ struct OneZero : VoxglitchModule
             real_selected_sequence = selected_sequence;
         }
 
+        // Sequences can be different lengths, so make sure the step is valid
+        // for the selected one
+        if (step >= sequences->length(real_selected_sequence))
+        {
+            step = 0;
+        }
+
         // Process STEP input
         if (!wait_for_reset_timer && step_trigger.process(inputs[STEP_INPUT].getVoltage(), constants::gate_low_trigger, constants::gate_high_trigger))
         {
@@ -209,14 +237,14 @@ struct OneZero : VoxglitchModule
                 step++;
 
                 // If we're at the end of the sequencer, wrap to the beginning
-                if (step == sequences[real_selected_sequence].size())
+                if (step == sequences->length(real_selected_sequence))
                 {
                     step = 0;
                     eol_pulse_generator.trigger(0.01f);
                 }
             }
 
-            if (sequences[real_selected_sequence][step])
+            if (sequences->at(real_selected_sequence, step))
                 output_pulse_generator.trigger(0.01f);
         }
 
@@ -252,28 +280,9 @@ struct OneZero : VoxglitchModule
 
     void loadData(std::string path)
     {
-        // Clear out existing data
-        sequences.clear();
-
-        FILE* input_file = fopen(path.c_str(), "r");
-        if (input_file)
-        {
-            char line[1024]; // Buffer for reading lines
-            while (fgets(line, sizeof(line), input_file))
-            {
-                std::vector<bool> sequence;
-                for (char* c = line; *c != '\0' && *c != '\n'; c++)
-                {
-                    if (*c == '1') sequence.push_back(true);
-                    if (*c == '0') sequence.push_back(false);
-                }
-                sequences.push_back(sequence);
-            }
-
-            fclose(input_file);
-        }
-
-        reset();
+        // The new sequences replace the old ones when they've loaded.  Then
+        // onSequencesLoaded() resets playback.
+        sequence_loader.load(path);
     }
 
     /*
@@ -1,7 +1,7 @@
 struct Sampler16P : VoxglitchSamplerModule
 {
 	std::string loaded_filenames[NUMBER_OF_SAMPLES] = {""};
-  std::vector<SamplePlayer> sample_players;
+  SamplePlayer sample_players[NUMBER_OF_SAMPLES];
   dsp::SchmittTrigger sample_triggers[NUMBER_OF_SAMPLES];
 
   StereoPan stereo_pan;
@@ -35,12 +35,6 @@ struct Sampler16P : VoxglitchSamplerModule
 
     std::fill_n(loaded_filenames, NUMBER_OF_SAMPLES, "[ EMPTY ]");
 
-    for(unsigned int i=0; i<NUMBER_OF_SAMPLES; i++)
-    {
-      SamplePlayer sample_player;
-      sample_players.push_back(sample_player);
-    }
-
     
 	}
 
@@ -66,6 +60,11 @@ struct Sampler16P : VoxglitchSamplerModule
   //
 	void dataFromJson(json_t *root) override
 	{
+    // Call VoxglitchSamplerModule::loadSamplerData to load sampler specific
+    // data.  This comes first so that the samples below are loaded with the
+    // saved resample_on_load setting, rather than being converted again.
+    loadSamplerData(root);
+
     for(int i=0; i < NUMBER_OF_SAMPLES; i++)
 		{
 			json_t *loaded_sample_path = json_object_get(root, ("loaded_sample_path_" +  std::to_string(i+1)).c_str());
@@ -77,9 +76,6 @@ struct Sampler16P : VoxglitchSamplerModule
         }
 			}
 		}
-
-    // Call VoxglitchSamplerModule::loadSamplerData to load sampler specific data
-    loadSamplerData(root);
 	}
 
 
@@ -117,6 +113,16 @@ struct Sampler16P : VoxglitchSamplerModule
 
   }
 
+  void setResampleOnLoad(bool resample_on_load) override
+  {
+    VoxglitchSamplerModule::setResampleOnLoad(resample_on_load);
+
+    for(unsigned int i=0; i<NUMBER_OF_SAMPLES; i++)
+    {
+      sample_players[i].setResampleOnLoad(resample_on_load);
+    }
+  }
+
   void onSampleRateChange(const SampleRateChangeEvent& e) override
   {
     for(unsigned int i=0; i<NUMBER_OF_SAMPLES; i++)
@@ -45,5 +45,9 @@ struct Sampler16PWidget : VoxglitchSamplerModuleWidget
         SampleInterpolationMenuItem *sample_interpolation_menu_item = createMenuItem<SampleInterpolationMenuItem>("Interpolation", RIGHT_ARROW);
         sample_interpolation_menu_item->module = module;
         menu->addChild(sample_interpolation_menu_item);
+
+        ResampleOnLoadMenuItem *resample_on_load_menu_item = createMenuItem<ResampleOnLoadMenuItem>("Resample to engine rate on load", CHECKMARK(module->resample_on_load));
+        resample_on_load_menu_item->module = module;
+        menu->addChild(resample_on_load_menu_item);
     }
 };
@@ -1,7 +1,7 @@
 struct SamplerX8 : VoxglitchSamplerModule
 {
     std::string loaded_filenames[NUMBER_OF_SAMPLES] = {""};
-    std::vector<SamplePlayer> sample_players;
+    SamplePlayer sample_players[NUMBER_OF_SAMPLES];
     dsp::SchmittTrigger sample_triggers[NUMBER_OF_SAMPLES];
 
     StereoPan stereo_pan;
@@ -51,12 +51,6 @@ struct SamplerX8 : VoxglitchSamplerModule
 
         std::fill_n(loaded_filenames, NUMBER_OF_SAMPLES, "[ EMPTY ]");
 
-        for (unsigned int i = 0; i < NUMBER_OF_SAMPLES; i++)
-        {
-            SamplePlayer sample_player;
-            sample_players.push_back(sample_player);
-        }
-
         #ifdef METAMODULE
         for (unsigned int i = 0; i < NUMBER_OF_SAMPLES; i++)
         {
@@ -91,6 +85,11 @@ struct SamplerX8 : VoxglitchSamplerModule
     //
     void dataFromJson(json_t *root) override
     {
+        // Call VoxglitchSamplerModule::loadSamplerData to load sampler specific
+        // data.  This comes first so that the samples below are loaded with the
+        // saved resample_on_load setting, rather than being converted again.
+        loadSamplerData(root);
+
         for (int i = 0; i < NUMBER_OF_SAMPLES; i++)
         {
             json_t *loaded_sample_path = json_object_get(root, ("loaded_sample_path_" + std::to_string(i + 1)).c_str());
@@ -102,9 +101,6 @@ struct SamplerX8 : VoxglitchSamplerModule
                 }
             }
         }
-
-        // Call VoxglitchSamplerModule::loadSamplerData to load sampler specific data
-        loadSamplerData(root);
     }
 
     void process(const ProcessArgs &args) override
@@ -161,6 +157,16 @@ struct SamplerX8 : VoxglitchSamplerModule
         outputs[AUDIO_MIX_OUTPUT_RIGHT].setVoltage(summed_output_right);
     }
 
+    void setResampleOnLoad(bool resample_on_load) override
+    {
+        VoxglitchSamplerModule::setResampleOnLoad(resample_on_load);
+
+        for (unsigned int i = 0; i < NUMBER_OF_SAMPLES; i++)
+        {
+            sample_players[i].setResampleOnLoad(resample_on_load);
+        }
+    }
+
     void onSampleRateChange(const SampleRateChangeEvent &e) override
     {
         for (unsigned int i = 0; i < NUMBER_OF_SAMPLES; i++)
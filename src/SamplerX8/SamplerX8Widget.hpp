@@ -113,5 +113,9 @@ struct SamplerX8Widget : VoxglitchSamplerModuleWidget
         SampleInterpolationMenuItem *sample_interpolation_menu_item = createMenuItem<SampleInterpolationMenuItem>("Interpolation", RIGHT_ARROW);
         sample_interpolation_menu_item->module = module;
         menu->addChild(sample_interpolation_menu_item);
+
+        ResampleOnLoadMenuItem *resample_on_load_menu_item = createMenuItem<ResampleOnLoadMenuItem>("Resample to engine rate on load", CHECKMARK(module->resample_on_load));
+        resample_on_load_menu_item->module = module;
+        menu->addChild(resample_on_load_menu_item);
     }
 };
@@ -11,6 +11,7 @@
 
 #include "vgLib-2.0/constants.h"
 #include "vgLib-2.0/components/VoxglitchComponents.hpp"
+#include "vgLib-2.0/BytebeatExpression.hpp"
 
 using namespace vgLib_v2;
 
@@ -19,6 +20,7 @@ using namespace vgLib_v2;
 #include "Satanonaut/SatanonautAudioBuffer.hpp"
 #include "Satanonaut/SatanonautStereoAudioBuffer.hpp"
 #include "Satanonaut/Satanonaut.hpp"
+#include "vgLib-2.0/widgets/ExpressionMenu.hpp"
 #include "Satanonaut/SatanonautEffectReadout.hpp"
 #include "Satanonaut/SatanonautWidget.hpp"
 
@@ -12,13 +12,35 @@ struct Satanonaut : Module
 
   dsp::SchmittTrigger purge_button_schmitt_trigger;
 
-  float left_audio = 0.0;
-  float right_audio = 0.0;
+  // One block of audio waiting to be processed, and one block of output
+  float input_left[SATANONAUT_BLOCK_SIZE] = {};
+  float input_right[SATANONAUT_BLOCK_SIZE] = {};
+  float output_left[SATANONAUT_BLOCK_SIZE] = {};
+  float output_right[SATANONAUT_BLOCK_SIZE] = {};
+  unsigned int block_index = 0;
+
+  // Effect switching
+  unsigned int active_effect = 0;
+  unsigned int outgoing_effect = 0;
+  unsigned int crossfade_frames_remaining = 0;
+  float fade_left[SATANONAUT_BLOCK_SIZE] = {};
+  float fade_right[SATANONAUT_BLOCK_SIZE] = {};
+
+  dsp::ExponentialFilter param_1_filter;
+  dsp::ExponentialFilter param_2_filter;
+  float sample_time = 1.0 / 44100.0;
 
   uint32_t buffer_size = 0;
   float feedback = 0.0;
   float drive = 1;
 
+  BytebeatExpressionSlot custom_expression;
+
+  // Shared by the effects that are written as expressions.  Only one effect
+  // renders at a time.
+  BytebeatInterpreter interpreter;
+  uint32_t offsets[SATANONAUT_BLOCK_SIZE];
+
   enum ParamIds {
     CLOCK_DIVISION_KNOB,
     BUFFER_SIZE_KNOB,
@@ -63,6 +85,11 @@ struct Satanonaut : Module
     // configParam(EFFECT_KNOB, 0.0f, 1.0f, 0.0f, "EffectKnob");
     configParam(DRIVE_KNOB, 1, 60, 1, "DriveKnob");
 
+    param_1_filter.setTau(SATANONAUT_PARAM_SMOOTHING_TIME);
+    param_2_filter.setTau(SATANONAUT_PARAM_SMOOTHING_TIME);
+
+    custom_expression.setExpression(DEFAULT_CUSTOM_EXPRESSION);
+
     rack::random::init();
     audio_buffer.purge();
 	}
@@ -71,13 +98,15 @@ struct Satanonaut : Module
 	json_t *dataToJson() override
 	{
 		json_t *root = json_object();
+    json_object_set_new(root, "custom_expression", json_string(custom_expression.expression.c_str()));
   	return root;
 	}
 
 	// Load module data
 	void dataFromJson(json_t *root) override
 	{
-    // There's nothing to save and load yet.
+    json_t *custom_expression_json = json_object_get(root, "custom_expression");
+    if(custom_expression_json) custom_expression.setExpression(json_string_value(custom_expression_json));
 	}
 
 
@@ -136,12 +165,41 @@ struct Satanonaut : Module
     bool purge_button_is_triggered = purge_button_schmitt_trigger.process(params[PURGE_BUTTON].getValue());
     if(purge_button_is_triggered) audio_buffer.purge();
 
+    sample_time = args.sampleTime;
+
     //
-    // Read knobs and inputs
+    // Audio is handled in blocks of SATANONAUT_BLOCK_SIZE frames.  The input
+    // is collected until a block is full, then the whole block is pushed
+    // into the buffer and the selected effect renders the next block of
+    // output in one go.  This delays the output by one block.
+    //
+    input_left[block_index] = inputs[AUDIO_INPUT_LEFT].getVoltage();
+    input_right[block_index] = inputs[AUDIO_INPUT_RIGHT].getVoltage();
+
+    outputs[AUDIO_OUTPUT_LEFT].setVoltage(output_left[block_index]);
+    outputs[AUDIO_OUTPUT_RIGHT].setVoltage(output_right[block_index]);
+
+    block_index++;
+
+    if(block_index >= SATANONAUT_BLOCK_SIZE)
+    {
+      block_index = 0;
+      processBlock();
+    }
+  }
+
+  void processBlock()
+  {
+    //
+    // Read knobs and inputs once per block
     //
     selected_effect = snapped_attenuverter_input(EFFECT_INPUT, EFFECT_KNOB, 0, NUMBER_OF_EFFECTS);
-    param_1_input = attenuverter_input(PARAM_1_INPUT, PARAM_1_KNOB); // ranges from 0 to 1
-    param_2_input = attenuverter_input(PARAM_2_INPUT, PARAM_2_KNOB); // ranges from 0 to 1
+
+    // The effect parameters are smoothed at the block rate so that sweeping
+    // them, or sequencing them with CV, doesn't step abruptly.
+    float block_time = sample_time * SATANONAUT_BLOCK_SIZE;
+    param_1_input = param_1_filter.process(block_time, attenuverter_input(PARAM_1_INPUT, PARAM_1_KNOB)); // ranges from 0 to 1
+    param_2_input = param_2_filter.process(block_time, attenuverter_input(PARAM_2_INPUT, PARAM_2_KNOB)); // ranges from 0 to 1
     buffer_size = clamp((int) (attenuverter_input(BUFFER_SIZE_INPUT, BUFFER_SIZE_KNOB) * (float) MAX_BUFFER_SIZE), MIN_BUFFER_SIZE, MAX_BUFFER_SIZE);
     feedback = clamp(attenuverter_input(FEEDBACK_INPUT, FEEDBACK_KNOB), 0.0, 1.0);
     drive = params[DRIVE_KNOB].getValue();
@@ -150,64 +208,111 @@ struct Satanonaut : Module
     audio_buffer.setBufferSize(buffer_size);
     audio_buffer.setFeedback(feedback);
 
-    float audio_input_left = inputs[AUDIO_INPUT_LEFT].getVoltage();
-    float audio_input_right = inputs[AUDIO_INPUT_RIGHT].getVoltage();
-    // float output = 0.0;
+    audio_buffer.push(input_left, input_right, SATANONAUT_BLOCK_SIZE);
 
-    audio_buffer.push(audio_input_left, audio_input_right);
+    // Each effect renders the whole block, starting at time t + 1
+    unsigned int start = t + 1;
+    unsigned int frames = SATANONAUT_BLOCK_SIZE;
 
-    t += 1;
+    // When the selected effect changes, the new effect fades in while the
+    // old one fades out.  Both effects only run during the crossfade.  If the
+    // selection changes again part way through, it waits for the crossfade
+    // to finish.
+    if((selected_effect != active_effect) && (crossfade_frames_remaining == 0))
+    {
+      outgoing_effect = active_effect;
+      active_effect = selected_effect;
+      crossfade_frames_remaining = SATANONAUT_CROSSFADE_FRAMES;
+    }
 
-    switch(selected_effect) {
+    renderEffect(active_effect, start, output_left, output_right, frames);
+
+    if(crossfade_frames_remaining > 0)
+    {
+      renderEffect(outgoing_effect, start, fade_left, fade_right, frames);
+
+      float step = 1.0f / (float) SATANONAUT_CROSSFADE_FRAMES;
+      float fade_in = (float)(SATANONAUT_CROSSFADE_FRAMES - crossfade_frames_remaining) * step;
+
+      for(unsigned int i = 0; i < frames; i++)
+      {
+        float amount = std::min(fade_in + ((i + 1) * step), 1.0f);
+        output_left[i] = (fade_left[i] * (1.0f - amount)) + (output_left[i] * amount);
+        output_right[i] = (fade_right[i] * (1.0f - amount)) + (output_right[i] * amount);
+      }
+
+      crossfade_frames_remaining -= std::min(frames, crossfade_frames_remaining);
+    }
+
+    t += frames;
+
+    for(unsigned int i = 0; i < frames; i++)
+    {
+      output_left[i] *= drive;
+      output_right[i] *= drive;
+    }
+  }
+
+  void renderEffect(unsigned int effect, unsigned int start, float *left, float *right, unsigned int frames)
+  {
+    switch(effect) {
 
       case 0:
-        std::tie(left_audio, right_audio) = fx_two_direction.process(this, t, param_1_input, param_2_input);
+        fx_two_direction.process(this, start, param_1_input, param_2_input, left, right, frames);
         break;
       case 1:
-        std::tie(left_audio, right_audio) = fx_delays.process(this, t, param_1_input, param_2_input);
+        fx_delays.process(this, start, param_1_input, param_2_input, left, right, frames);
         break;
       case 2:
-        std::tie(left_audio, right_audio) = fx_bytebeat_1.process(this,t, param_1_input, param_2_input);
+        fx_bytebeat_1.process(this, start, param_1_input, param_2_input, left, right, frames);
         break;
       case 3:
-        std::tie(left_audio, right_audio) = fx_bytebeat_2.process(this,t, param_1_input, param_2_input);
+        fx_bytebeat_2.process(this, start, param_1_input, param_2_input, left, right, frames);
         break;
       case 4:
-        std::tie(left_audio, right_audio) = fx_bytebeat_3.process(this,t, param_1_input, param_2_input);
+        fx_bytebeat_3.process(this, start, param_1_input, param_2_input, left, right, frames);
         break;
       case 5:
-        std::tie(left_audio, right_audio) = fx_bytebeat_4.process(this,t, param_1_input, param_2_input);
+        fx_bytebeat_4.process(this, start, param_1_input, param_2_input, left, right, frames);
         break;
       case 6:
-        std::tie(left_audio, right_audio) = fx_bytebeat_5.process(this,t, param_1_input, param_2_input);
+        fx_bytebeat_5.process(this, start, param_1_input, param_2_input, left, right, frames);
         break;
       case 7:
-        std::tie(left_audio, right_audio) = fx_slice_repeat.process(this, t, param_1_input, param_2_input);
+        fx_slice_repeat.process(this, start, param_1_input, param_2_input, left, right, frames);
         break;
       case 8:
-        std::tie(left_audio, right_audio) = fx_dizzy.process(this, t, param_1_input, param_2_input);
+        fx_dizzy.process(this, start, param_1_input, param_2_input, left, right, frames);
         break;
       case 9:
-        std::tie(left_audio, right_audio) = fx_wave_packing.process(this, t, param_1_input, param_2_input);
+        fx_wave_packing.process(this, start, param_1_input, param_2_input, left, right, frames);
         break;
       case 10:
-        std::tie(left_audio, right_audio) = fx_smooth.process(this, t, param_1_input, param_2_input);
+        fx_smooth.process(this, start, param_1_input, param_2_input, left, right, frames);
         break;
       case 11:
-        std::tie(left_audio, right_audio) = fx_fold.process(this, t, param_1_input, param_2_input);
+        fx_fold.process(this, start, param_1_input, param_2_input, left, right, frames);
         break;
       case 12:
-        std::tie(left_audio, right_audio) = fx_bytebeat_anxious.process(this, t, param_1_input, param_2_input);
+        fx_bytebeat_anxious.process(this, start, param_1_input, param_2_input, left, right, frames);
         break;
       case 13:
-        std::tie(left_audio, right_audio) = fx_long_play.process(this, t, param_1_input, param_2_input);
+        fx_long_play.process(this, start, param_1_input, param_2_input, left, right, frames);
+        break;
+      case CUSTOM_EFFECT:
+        fx_custom_expression.process(this, start, param_1_input, param_2_input, left, right, frames);
         break;
     }
-
-    outputs[AUDIO_OUTPUT_LEFT].setVoltage(left_audio * drive);
-    outputs[AUDIO_OUTPUT_RIGHT].setVoltage(right_audio * drive);
   }
 
+  //
+  // Effects
+  //
+  // Every effect has a process method that renders _frames_ frames of audio
+  // into _left_ and _right_.  The first frame is at time _t_, the next at
+  // t + 1, and so on.
+  //
+
   struct Effect
   {
     uint32_t div(uint32_t a, uint32_t b)
@@ -222,22 +327,6 @@ struct Satanonaut : Module
       return(a % b);
     }
 
-    std::pair<float,float> mix(const std::pair<float,float> &a, const std::pair<float,float> &b)
-    {
-      return(std::make_pair(a.first + b.first, a.second + b.second));
-    }
-
-    std::pair<float,float> subtract(const std::pair<float,float> &a, const std::pair<float,float> &b)
-    {
-      return(std::make_pair((a.first - b.first) * 2, a.second - b.second));
-    }
-
-    std::pair<float,float> divide(const std::pair<float,float> &a, unsigned int divisor)
-    {
-      if(divisor == 0) divisor = 1;
-      return(std::make_pair(a.first / divisor, a.second / divisor));
-    }
-
     // Folder code from Squinky Labs: https://github.com/squinkylabs/SquinkyVCV/blob/3a5fbaae4956737c77d0494b69149747c25726af/dsp/utils/AudioMath.h#L162
     float fold(float x, float bounds)
     {
@@ -254,20 +343,48 @@ struct Satanonaut : Module
     }
   };
 
+  // An effect written as a bytebeat expression, compiled once when the
+  // module is created.  run() evaluates it for the frames of a block, with
+  // p3 set to the buffer size.  The expressions give exactly the same values
+  // as the C++ they replaced, shifts by 32 or more included.
+  struct ExpressionEffect : Effect
+  {
+    BytebeatProgram program;
+
+    ExpressionEffect(const char *source)
+    {
+      BytebeatCompiler::compile(source, program);
+    }
+
+    uint32_t *run(Satanonaut *satanonaut, unsigned int t, uint32_t p1, uint32_t p2, unsigned int frames)
+    {
+      satanonaut->interpreter.run(program, t, p1, p2, satanonaut->buffer_size, satanonaut->offsets, frames);
+      return(satanonaut->offsets);
+    }
+  };
+
   //
   // EFFECT #0
   //
 
   struct FXTwoDirection : Effect
   {
-    std::pair<float, float> process(Satanonaut *satanonaut, unsigned int t, float p1, float p2)
+    void process(Satanonaut *satanonaut, unsigned int t, float p1, float p2, float *left, float *right, unsigned int frames)
     {
+      SatanonautStereoAudioBuffer &buffer = satanonaut->audio_buffer;
+
       uint32_t vp1 = (p1 * 15.0) + 1;
 
       float vp2 = 1.0;
       if(p2 > .1) vp2 = (p2 * 8.0) - 4.0;
 
-      return(mix(satanonaut->audio_buffer.valueAt((satanonaut->buffer_size / vp1) - t), satanonaut->audio_buffer.valueAt(t * vp2)));
+      uint32_t start = satanonaut->buffer_size / vp1;
+
+      for(unsigned int i = 0; i < frames; i++, t++)
+      {
+        buffer.read(start - t, &left[i], &right[i]);
+        buffer.readMix((int)(t * vp2), &left[i], &right[i]);
+      }
     }
   } fx_two_direction;
 
@@ -277,17 +394,22 @@ struct Satanonaut : Module
 
   struct FXDelays : Effect
   {
-    std::pair<float, float> process(Satanonaut *satanonaut, unsigned int t, float p1, float p2)
+    void process(Satanonaut *satanonaut, unsigned int t, float p1, float p2, float *left, float *right, unsigned int frames)
     {
+      SatanonautStereoAudioBuffer &buffer = satanonaut->audio_buffer;
+
       uint32_t vp1 = (p1 * 6) + 1;
       uint32_t vp2 = (p2 * 6) + 1;
 
-      return(
-        mix(
-          mix(satanonaut->audio_buffer.valueAt(t), satanonaut->audio_buffer.valueAt(t + (satanonaut->buffer_size / vp1))),
-          satanonaut->audio_buffer.valueAt(t + (satanonaut->buffer_size / vp2))
-        )
-      );
+      uint32_t delay_1 = satanonaut->buffer_size / vp1;
+      uint32_t delay_2 = satanonaut->buffer_size / vp2;
+
+      for(unsigned int i = 0; i < frames; i++, t++)
+      {
+        buffer.read(t, &left[i], &right[i]);
+        buffer.readMix(t + delay_1, &left[i], &right[i]);
+        buffer.readMix(t + delay_2, &left[i], &right[i]);
+      }
     }
   } fx_delays;
 
@@ -299,16 +421,21 @@ struct Satanonaut : Module
   {
     unsigned int offset = 0;
 
-    std::pair<float, float> process(Satanonaut *satanonaut, unsigned int t, float p1, float p2)
+    void process(Satanonaut *satanonaut, unsigned int t, float p1, float p2, float *left, float *right, unsigned int frames)
     {
+      SatanonautStereoAudioBuffer &buffer = satanonaut->audio_buffer;
+
       uint32_t vp1 = (p1 * 14.0) + 1;
       uint32_t vp2 = (p2 * 4) + 3;
 
-      // offset = ((t*vp1)&div(t,vp2)) * .1;
-      offset = (((t>>2)|(t>>vp2)) - ((t<<7)|(t/vp1)) + ((t>>4)+(t<<2))%(offset + 1));
-      offset = offset * (p1 * .01);
+      for(unsigned int i = 0; i < frames; i++, t++)
+      {
+        // offset = ((t*vp1)&div(t,vp2)) * .1;
+        offset = (((t>>2)|(t>>vp2)) - ((t<<7)|(t/vp1)) + ((t>>4)+(t<<2))%(offset + 1));
+        offset = offset * (p1 * .01);
 
-      return(satanonaut->audio_buffer.valueAt(t + offset));
+        buffer.read(t + offset, &left[i], &right[i]);
+      }
     }
   } fx_bytebeat_1;
 
@@ -316,21 +443,27 @@ struct Satanonaut : Module
   // EFFECT #3
   //
   // This doesn't seem to do anything
-  struct FXBytebeat2 : Effect
+  struct FXBytebeat2 : ExpressionEffect
   {
-    int offset = 0;
+    // offset = (((vp1&t)^mod((t>>2), vp2))) * .1;
+    // offset = ((t>>6) & div((t<<3),mod( (t*(t>>vp1)),(vp2+ mod((t>>16),vp2) ))));
+    FXBytebeat2() : ExpressionEffect("p1*(t/32)%p2")
+    {
+    }
 
-    std::pair<float, float> process(Satanonaut *satanonaut, unsigned int t, float p1, float p2)
+    void process(Satanonaut *satanonaut, unsigned int t, float p1, float p2, float *left, float *right, unsigned int frames)
     {
+      SatanonautStereoAudioBuffer &buffer = satanonaut->audio_buffer;
+
       uint32_t vp1 = p1 * 10991.0;
       uint32_t vp2 = (p2 * 22000) + 1;
 
-      // offset = (((vp1&t)^mod((t>>2), vp2))) * .1;
-      // offset = ((t>>6) & div((t<<3),mod( (t*(t>>vp1)),(vp2+ mod((t>>16),vp2) ))));
+      uint32_t *offsets = run(satanonaut, t, vp1, vp2, frames);
 
-      offset = (vp1*(t/32)%vp2);
-
-      return(satanonaut->audio_buffer.valueAt(t + offset));
+      for(unsigned int i = 0; i < frames; i++, t++)
+      {
+        buffer.read(t + offsets[i], &left[i], &right[i]);
+      }
     }
   } fx_bytebeat_2;
 
@@ -338,17 +471,25 @@ struct Satanonaut : Module
   // EFFECT #4
   //
 
-  struct FXBytebeat3 : Effect
+  struct FXBytebeat3 : ExpressionEffect
   {
-    int offset = 0;
+    FXBytebeat3() : ExpressionEffect("((t >> p1) & t) * (t >> p2)")
+    {
+    }
 
-    std::pair<float, float> process(Satanonaut *satanonaut, unsigned int t, float p1, float p2)
+    void process(Satanonaut *satanonaut, unsigned int t, float p1, float p2, float *left, float *right, unsigned int frames)
     {
+      SatanonautStereoAudioBuffer &buffer = satanonaut->audio_buffer;
+
       uint32_t vp1 = p1 * 16.0;
       uint32_t vp2 = p2 * 32.0;
 
-      offset = ((t >> vp1) & t) * (t>>vp2);
-      return(satanonaut->audio_buffer.valueAt(t + offset));
+      uint32_t *offsets = run(satanonaut, t, vp1, vp2, frames);
+
+      for(unsigned int i = 0; i < frames; i++, t++)
+      {
+        buffer.read(t + offsets[i], &left[i], &right[i]);
+      }
     }
   } fx_bytebeat_3;
 
@@ -361,13 +502,18 @@ struct Satanonaut : Module
   {
     int offset = 0;
 
-    std::pair<float, float> process(Satanonaut *satanonaut, unsigned int t, float p1, float p2)
+    void process(Satanonaut *satanonaut, unsigned int t, float p1, float p2, float *left, float *right, unsigned int frames)
     {
+      SatanonautStereoAudioBuffer &buffer = satanonaut->audio_buffer;
+
       uint32_t vp1 = p1 * 32.0;
       uint32_t vp2 = p2 * 32.0;
 
-      offset = mod((( mod(t,((76 - (t>>vp2)) % 11))) * (t>>1)), (47-(t>>(4+vp1)) % 41)) * .7;
-      return(satanonaut->audio_buffer.valueAt(t + offset));
+      for(unsigned int i = 0; i < frames; i++, t++)
+      {
+        offset = mod((( mod(t,((76 - (t>>vp2)) % 11))) * (t>>1)), (47-(t>>(4+vp1)) % 41)) * .7;
+        buffer.read(t + offset, &left[i], &right[i]);
+      }
     }
   } fx_bytebeat_4;
 
@@ -375,22 +521,27 @@ struct Satanonaut : Module
   // EFFECT #6
   //
 
-  struct FXBytebeat5 : Effect
+  struct FXBytebeat5 : ExpressionEffect
   {
-    int previous_offset = 0;
-    int next_offset = 0;
-    int offset = 0;
+    // This used to average with a previous offset that was never set, so
+    // it halves instead
+    FXBytebeat5() : ExpressionEffect("((t * ((t>>4 | t>>p1) & p2)) & (p2+5)) / 2")
+    {
+    }
 
-    std::pair<float, float> process(Satanonaut *satanonaut, unsigned int t, float p1, float p2)
+    void process(Satanonaut *satanonaut, unsigned int t, float p1, float p2, float *left, float *right, unsigned int frames)
     {
+      SatanonautStereoAudioBuffer &buffer = satanonaut->audio_buffer;
+
       uint32_t vp1 = p1 * 32.0;
       uint32_t vp2 = p2 * 32.0;
 
-      next_offset = ( t * (( t>>4| t>>vp1 ) & vp2)) & (vp2+5);
-      offset = (previous_offset + next_offset) / 2;
-      next_offset = offset;
+      uint32_t *offsets = run(satanonaut, t, vp1, vp2, frames);
 
-      return(satanonaut->audio_buffer.valueAt(t + offset));
+      for(unsigned int i = 0; i < frames; i++, t++)
+      {
+        buffer.read(t + offsets[i], &left[i], &right[i]);
+      }
     }
   } fx_bytebeat_5;
 
@@ -402,15 +553,20 @@ struct Satanonaut : Module
   {
     int offset = 0;
 
-    std::pair<float, float> process(Satanonaut *satanonaut, unsigned int t, float p1, float p2)
+    void process(Satanonaut *satanonaut, unsigned int t, float p1, float p2, float *left, float *right, unsigned int frames)
     {
+      SatanonautStereoAudioBuffer &buffer = satanonaut->audio_buffer;
+
       uint32_t vp1 = p1 * 5000;
       uint32_t vp2 = p2 * 6000;
 
-      offset = sin(float(t/8.0) / vp1) * satanonaut->buffer_size;
-      offset += sin(float(t/32.0) / vp2) * satanonaut->buffer_size;
+      for(unsigned int i = 0; i < frames; i++, t++)
+      {
+        offset = sin(float(t/8.0) / vp1) * satanonaut->buffer_size;
+        offset += sin(float(t/32.0) / vp2) * satanonaut->buffer_size;
 
-      return(satanonaut->audio_buffer.valueAt(t + offset));
+        buffer.read(t + offset, &left[i], &right[i]);
+      }
     }
   } fx_dizzy;
 
@@ -424,15 +580,22 @@ struct Satanonaut : Module
     int window_size;
     int offset = -1;
 
-    std::pair<float, float> process(Satanonaut *satanonaut, unsigned int t, float p1, float p2)
+    void process(Satanonaut *satanonaut, unsigned int t, float p1, float p2, float *left, float *right, unsigned int frames)
     {
+      SatanonautStereoAudioBuffer &buffer = satanonaut->audio_buffer;
+
       divisor = int(p1 * 16.0);
       if(divisor <= 1) divisor = 2;
 
       window_size = satanonaut->buffer_size / divisor;
-      if(++offset >= 0) offset = (-1 * window_size);
 
-      return(mix(satanonaut->audio_buffer.valueAt(offset), satanonaut->audio_buffer.valueAt(t)));
+      for(unsigned int i = 0; i < frames; i++, t++)
+      {
+        if(++offset >= 0) offset = (-1 * window_size);
+
+        buffer.read(offset, &left[i], &right[i]);
+        buffer.readMix(t, &left[i], &right[i]);
+      }
     }
 
   } fx_slice_repeat;
@@ -452,10 +615,11 @@ struct Satanonaut : Module
     float sin_amplitude = 0;
 
     bool sin_is_playing = false;
-    std::pair<float, float> stereo_audio = { 0, 0 };
 
-    std::pair<float, float> process(Satanonaut *satanonaut, unsigned int t, float p1, float p2)
+    void process(Satanonaut *satanonaut, unsigned int t, float p1, float p2, float *left, float *right, unsigned int frames)
     {
+      SatanonautStereoAudioBuffer &buffer = satanonaut->audio_buffer;
+
       // HOW about flutter?  (sequenced muting)
       divisor = int(p1 * 4096.0);
       if(divisor < 12) divisor = 12;
@@ -463,16 +627,18 @@ struct Satanonaut : Module
       phase = float(divisor) * p2;
       if(phase < 1) phase = 1;
 
-      if(t%divisor < phase)
-      {
-        stereo_audio = satanonaut->audio_buffer.valueAt(t);
-      }
-      else
+      for(unsigned int i = 0; i < frames; i++, t++)
       {
-        stereo_audio = { 0, 0 };
+        if(t%divisor < phase)
+        {
+          buffer.read(t, &left[i], &right[i]);
+        }
+        else
+        {
+          left[i] = 0;
+          right[i] = 0;
+        }
       }
-
-      return(stereo_audio);
     }
 
   } fx_wave_packing;
@@ -486,63 +652,72 @@ struct Satanonaut : Module
     int divisor = 32;
     unsigned int window_size = 44010;
     int offset = -1;
-    std::pair<float, float> stereo_audio = {0,0};
 
-    std::pair<float, float> process(Satanonaut *satanonaut, unsigned int t, float p1, float p2)
+    void process(Satanonaut *satanonaut, unsigned int t, float p1, float p2, float *left, float *right, unsigned int frames)
     {
+      SatanonautStereoAudioBuffer &buffer = satanonaut->audio_buffer;
 
       // For this effect, the parameters need to be positive numbers
       if(p1 < 0) p1 = 0;
       if(p2 < 0) p2 = 0;
 
-      if(satanonaut->buffer_size > 16)
+      if(satanonaut->buffer_size <= 16)
       {
-        stereo_audio = satanonaut->audio_buffer.valueAt(t);
-        window_size = satanonaut->buffer_size / (int(p1 * 64)+1);
-        if(window_size < 1) window_size = 1;
+        for(unsigned int i = 0; i < frames; i++, t++) buffer.read(t, &left[i], &right[i]);
+        return;
+      }
 
-        divisor = int(p2*60) + 1;
-        if(divisor < 1) divisor = 1;
+      window_size = satanonaut->buffer_size / (int(p1 * 64)+1);
+      if(window_size < 1) window_size = 1;
+
+      divisor = int(p2*60) + 1;
+      if(divisor < 1) divisor = 1;
+
+      unsigned int stride = window_size / divisor;
+
+      for(unsigned int i = 0; i < frames; i++, t++)
+      {
+        buffer.read(t, &left[i], &right[i]);
 
-        if((window_size/divisor) >= 1)
+        if(stride >= 1)
         {
-          for(unsigned int i=1; i<window_size; i+=(window_size/divisor))
+          for(unsigned int j = 1; j < window_size; j += stride)
           {
-            offset = (t-i) % satanonaut->buffer_size;
-            stereo_audio = mix(stereo_audio, satanonaut->audio_buffer.valueAt(offset));
+            offset = (t-j) % satanonaut->buffer_size;
+            buffer.readMix(offset, &left[i], &right[i]);
           }
         }
 
-        stereo_audio = divide(stereo_audio, 8);
-        return(stereo_audio);
+        left[i] /= 8;
+        right[i] /= 8;
       }
-      else
-      {
-        return(satanonaut->audio_buffer.valueAt(t));
-      }
-
     }
   } fx_smooth;
 
   //
   // EFFECT #11
   //
-  struct FXFold : Effect
+  struct FXFold : ExpressionEffect
   {
-    int offset = 0;
+    // offset = ((t/vp1)|t|((t>>1)&(t+(t>>(t*vp2)))))-(t/44100);
+    FXFold() : ExpressionEffect("(t*p1) | (t & (t/44100)) | (t/p2)")
+    {
+    }
 
-    std::pair<float, float> process(Satanonaut *satanonaut, unsigned int t, float p1, float p2)
+    void process(Satanonaut *satanonaut, unsigned int t, float p1, float p2, float *left, float *right, unsigned int frames)
     {
+      SatanonautStereoAudioBuffer &buffer = satanonaut->audio_buffer;
+
+      // Negative values wrap around, as they did when multiplied with t
       int vp1 = (p1 * 50.0) - 25;
       int vp2 = (p2 * 30.0) - 15;
 
-      // if(vp1 == 0) vp1 = 1;
-
-      offset = (t-t+t*vp1)|(t&(t/44100))|div(t,vp2);
+      uint32_t *offsets = run(satanonaut, t, vp1, vp2, frames);
 
-      // offset = ((t/vp1)|t|((t>>1)&(t+(t>>(t*vp2)))))-(t/44100);
-
-      return(satanonaut->audio_buffer.valueAt(offset));
+      for(unsigned int i = 0; i < frames; i++)
+      {
+        buffer.read(offsets[i], &left[i], &right[i]);
+      }
     }
   } fx_fold;
 
@@ -550,20 +725,27 @@ struct Satanonaut : Module
   // EFFECT #12
   //
 
-  struct FXByteBeatAnxous : Effect
+  struct FXByteBeatAnxous : ExpressionEffect
   {
-    int offset = 0;
+    FXByteBeatAnxous() : ExpressionEffect("((t/p1) | t | ((t>>1) & (t + (t >> (t*p2))))) - (t/44100)")
+    {
+    }
 
-    std::pair<float, float> process(Satanonaut *satanonaut, unsigned int t, float p1, float p2)
+    void process(Satanonaut *satanonaut, unsigned int t, float p1, float p2, float *left, float *right, unsigned int frames)
     {
+      SatanonautStereoAudioBuffer &buffer = satanonaut->audio_buffer;
+
       uint32_t vp1 = p1 * 50.0;
       uint32_t vp2 = p2 * 300.0;
 
       if(vp1 == 0) vp1 = 1;
 
-      offset = ((t/vp1)|t|((t>>1)&(t+(t>>(t*vp2)))))-(t/44100);
+      uint32_t *offsets = run(satanonaut, t, vp1, vp2, frames);
 
-      return(satanonaut->audio_buffer.valueAt(t + offset));
+      for(unsigned int i = 0; i < frames; i++, t++)
+      {
+        buffer.read(t + offsets[i], &left[i], &right[i]);
+      }
     }
   } fx_bytebeat_anxious;
 
@@ -575,16 +757,57 @@ struct Satanonaut : Module
   {
     int offset = 0;
 
-    std::pair<float, float> process(Satanonaut *satanonaut, unsigned int t, float p1, float p2)
+    void process(Satanonaut *satanonaut, unsigned int t, float p1, float p2, float *left, float *right, unsigned int frames)
     {
+      SatanonautStereoAudioBuffer &buffer = satanonaut->audio_buffer;
+
       uint32_t vp1 = (p1 * 22.0) + 1;
       p2 = p2 * .1;
 
-      // offset = ((t>>2)|(t>>2)) - ((t<<7)|(t/22)) + ((t>>4)+(t<<2))%101;
-      offset = (((t>>2)|(t>>2)) - ((t<<7)|(t/vp1)) + ((t>>4)+(t<<2))%101) * p2;
+      for(unsigned int i = 0; i < frames; i++, t++)
+      {
+        // offset = ((t>>2)|(t>>2)) - ((t<<7)|(t/22)) + ((t>>4)+(t<<2))%101;
+        offset = (((t>>2)|(t>>2)) - ((t<<7)|(t/vp1)) + ((t>>4)+(t<<2))%101) * p2;
 
-      return(satanonaut->audio_buffer.valueAt(t + offset));
+        buffer.read(t + offset, &left[i], &right[i]);
+      }
     }
   } fx_long_play;
 
+  //
+  // EFFECT #14
+  //
+  // Offsets the reads using the expression that the user typed in.  The
+  // offsets for the whole block are computed first, then the audio is read.
+  // In the expression, p1 and p2 range from 0 to 256 and p3 is the buffer
+  // size.
+  //
+
+  struct FXCustomExpression : Effect
+  {
+    void process(Satanonaut *satanonaut, unsigned int t, float p1, float p2, float *left, float *right, unsigned int frames)
+    {
+      SatanonautStereoAudioBuffer &buffer = satanonaut->audio_buffer;
+
+      const BytebeatProgram *program = satanonaut->custom_expression.update();
+
+      if(program == nullptr)
+      {
+        for(unsigned int i = 0; i < frames; i++) buffer.read(t + i, &left[i], &right[i]);
+        return;
+      }
+
+      uint32_t vp1 = p1 * 256.0;
+      uint32_t vp2 = p2 * 256.0;
+
+      uint32_t *offsets = satanonaut->offsets;
+      satanonaut->interpreter.run(*program, t, vp1, vp2, satanonaut->buffer_size, offsets, frames);
+
+      for(unsigned int i = 0; i < frames; i++, t++)
+      {
+        buffer.read(t + offsets[i], &left[i], &right[i]);
+      }
+    }
+  } fx_custom_expression;
+
 };
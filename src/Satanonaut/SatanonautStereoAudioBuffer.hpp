@@ -1,26 +1,35 @@
 #pragma once
 
+#include <cstdint>
+
 #define MAX_BUFFER_SIZE 44100
 #define MIN_BUFFER_SIZE 10
 
+// The audio is stored in a power-of-two sized array, so any index can be
+// masked into range.  BUFFER_STORAGE_SIZE must be at least MAX_BUFFER_SIZE.
+#define BUFFER_STORAGE_SIZE 65536
+#define BUFFER_STORAGE_MASK (BUFFER_STORAGE_SIZE - 1)
+
 struct SatanonautStereoAudioBuffer
 {
   int read_head = 0;
   unsigned int write_head = 0;
 
-	float buffer_left[MAX_BUFFER_SIZE];
-  float buffer_right[MAX_BUFFER_SIZE];
+  float buffer_left[BUFFER_STORAGE_SIZE];
+  float buffer_right[BUFFER_STORAGE_SIZE];
   float feedback = 0.0;
 
   uint32_t buffer_size = 44100;
 
+  // Effects read at positions that wrap around buffer_size, which can be any
+  // length, so the wrap is computed with a multiply instead of a division.
+  // See Lemire, Kaser and Kurz, "Faster Remainder by Direct Computation".
+  uint64_t modulo_multiplier = 0;
+
 	SatanonautStereoAudioBuffer()
 	{
-    for(unsigned int i=0; i<MAX_BUFFER_SIZE; i++)
-    {
-      buffer_left[i] = 0.0;
-      buffer_right[i] = 0.0;
-    }
+    setBufferSize(buffer_size);
+    purge();
 	}
 
 	virtual ~SatanonautStereoAudioBuffer() {}
@@ -28,7 +37,7 @@ struct SatanonautStereoAudioBuffer
 	virtual void push(float audio_left, float audio_right)
 	{
     write_head++;
-    if(write_head >= buffer_size || write_head >= MAX_BUFFER_SIZE) write_head = 0;
+    if(write_head >= buffer_size) write_head = 0;
 
     if(feedback == 0)
     {
@@ -40,33 +49,42 @@ struct SatanonautStereoAudioBuffer
       float existing_audio_left = buffer_left[write_head];
       float existing_audio_right = buffer_right[write_head];
 
-      float mixed_audio_left = (existing_audio_left * feedback) + (audio_left * (1.0 - feedback));
-      float mixed_audio_right = (existing_audio_right * feedback) + (audio_right * (1.0 - feedback));
-
-      // float mixed_audio = (existing_audio * feedback);
-      buffer_left[write_head] = mixed_audio_left;
-      buffer_right[write_head] = mixed_audio_right;
+      buffer_left[write_head] = (existing_audio_left * feedback) + (audio_left * (1.0 - feedback));
+      buffer_right[write_head] = (existing_audio_right * feedback) + (audio_right * (1.0 - feedback));
     }
-
 	};
 
-  std::pair<float, float> valueAt(int sample_position)
+  // Push a block of audio, one frame at a time
+  void push(const float *audio_left, const float *audio_right, unsigned int frames)
   {
-    if(buffer_size <= 0) buffer_size = 1;
-    if(buffer_size > MAX_BUFFER_SIZE) buffer_size = MAX_BUFFER_SIZE - 1;
-
-    float output_left = 0;
-    float output_right = 0;
+    for(unsigned int i = 0; i < frames; i++) push(audio_left[i], audio_right[i]);
+  }
 
-    unsigned int index = sample_position % buffer_size;
+  // Returns sample_position modulo buffer_size
+  inline uint32_t wrap(uint32_t sample_position)
+  {
+#ifdef __SIZEOF_INT128__
+    uint64_t lowbits = modulo_multiplier * sample_position;
+    return((uint32_t)(((__uint128_t) lowbits * buffer_size) >> 64));
+#else
+    return(sample_position % buffer_size);
+#endif
+  }
 
-    if(index < sizeof(buffer_left)) // very paranoid!
-    {
-      output_left = buffer_left[index];
-      output_right = buffer_right[index];
-    }
+  // Read the stereo frame at sample_position, which wraps around the buffer
+  inline void read(uint32_t sample_position, float *output_left, float *output_right)
+  {
+    uint32_t index = wrap(sample_position) & BUFFER_STORAGE_MASK;
+    *output_left = buffer_left[index];
+    *output_right = buffer_right[index];
+  }
 
-    return { output_left, output_right };
+  // Same as read, but adds to the output instead of replacing it
+  inline void readMix(uint32_t sample_position, float *output_left, float *output_right)
+  {
+    uint32_t index = wrap(sample_position) & BUFFER_STORAGE_MASK;
+    *output_left += buffer_left[index];
+    *output_right += buffer_right[index];
   }
 
   uint32_t getBufferSize()
@@ -81,7 +99,12 @@ struct SatanonautStereoAudioBuffer
 
   void setBufferSize(uint32_t new_buffer_size)
   {
+    if(new_buffer_size < 1) new_buffer_size = 1;
+    if(new_buffer_size > MAX_BUFFER_SIZE) new_buffer_size = MAX_BUFFER_SIZE;
+    if(new_buffer_size == buffer_size && modulo_multiplier != 0) return;
+
     buffer_size = new_buffer_size;
+    modulo_multiplier = (UINT64_C(0xFFFFFFFFFFFFFFFF) / buffer_size) + 1;
   }
 
   void setFeedback(float new_feedback)
@@ -96,7 +119,7 @@ struct SatanonautStereoAudioBuffer
 
   void purge()
   {
-    for(unsigned int i=0; i < MAX_BUFFER_SIZE; i++)
+    for(unsigned int i=0; i < BUFFER_STORAGE_SIZE; i++)
     {
       buffer_left[i] = 0.0;
       buffer_right[i] = 0.0;
@@ -33,4 +33,18 @@ struct SatanonautWidget : ModuleWidget
         addOutput(createOutputCentered<VoxglitchOutputPort>(panelHelper.findNamed("left_output"), module, Satanonaut::AUDIO_OUTPUT_LEFT));
         addOutput(createOutputCentered<VoxglitchOutputPort>(panelHelper.findNamed("right_output"), module, Satanonaut::AUDIO_OUTPUT_RIGHT));
     }
+
+    void appendContextMenu(Menu *menu) override
+    {
+        Satanonaut *module = dynamic_cast<Satanonaut *>(this->module);
+        assert(module);
+
+        // Add a space
+        menu->addChild(new MenuEntry);
+
+        ExpressionMenu *expression_menu = createMenuItem<ExpressionMenu>("Custom Expression", RIGHT_ARROW);
+        expression_menu->expression_slot = &module->custom_expression;
+        expression_menu->description = "Effect #" + std::to_string(CUSTOM_EFFECT) + " read offset.  Variables: t p1 p2 p3";
+        menu->addChild(expression_menu);
+    }
 };
@@ -1,6 +1,20 @@
 // #define _TIME_DRAWING 1
 
-#define NUMBER_OF_EFFECTS 13
+#define NUMBER_OF_EFFECTS 14
+
+// The last effect offsets its reads with the user's own bytebeat expression
+#define CUSTOM_EFFECT 14
+#define DEFAULT_CUSTOM_EXPRESSION "((t>>4)|(t>>p2))*p1&p3"
+
+// Number of frames that the effects process at a time
+#define SATANONAUT_BLOCK_SIZE 32
+
+// Length of the crossfade when switching effects, in frames.  This should be
+// a multiple of SATANONAUT_BLOCK_SIZE.
+#define SATANONAUT_CROSSFADE_FRAMES 512
+
+// Time constant, in seconds, of the smoothing applied to param 1 and param 2
+#define SATANONAUT_PARAM_SMOOTHING_TIME 0.01f
 
 #define COLUMN_1 9.525
 #define COLUMN_2 19.050
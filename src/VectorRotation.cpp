@@ -11,6 +11,7 @@
 #include "vgLib-2.0/components/VoxglitchComponents.hpp"
 
 using namespace vgLib_v2;
+using simd::float_4;
 
 #include "VectorRotation/VectorRotation.hpp"
 #include "VectorRotation/VectorRotationWidget.hpp"
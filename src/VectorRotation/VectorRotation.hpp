@@ -23,6 +23,22 @@ struct VectorRotation : Module {
     };
 
     const float twoPi = 2.f * M_PI;
+
+    // The three rotations combined into one matrix, for four channels at a
+    // time.  The Z input is always 0, so only the X and Y columns are kept.
+    struct RotationMatrix {
+        float_4 xx = 1.f, xy = 0.f;
+        float_4 yx = 0.f, yy = 1.f;
+        float_4 zx = 0.f, zy = 0.f;
+    };
+
+    // One matrix per group of four channels, and the angles it was built
+    // from.  The angles start out as NaN, which never compares equal, so the
+    // first call to updateMatrix() always builds the matrix.
+    RotationMatrix matrices[4];
+    float_4 matrix_alpha[4];
+    float_4 matrix_beta[4];
+    float_4 matrix_gamma[4];
    
     VectorRotation() {
         config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS);
@@ -42,47 +58,93 @@ struct VectorRotation : Module {
         configOutput(Y_OUTPUT, "Y Coordinate");
         configOutput(Z_OUTPUT, "Z Coordinate");
         #endif
-        
+
+        for (int group = 0; group < 4; group++) {
+            matrix_alpha[group] = NAN;
+            matrix_beta[group] = NAN;
+            matrix_gamma[group] = NAN;
+        }
     }
 
-    void rotatePoint(float* x, float* y, float* z, float alpha, float beta, float gamma) {
-        // Rotate around X
-        float y1 = *y * std::cos(alpha) - *z * std::sin(alpha);
-        float z1 = *y * std::sin(alpha) + *z * std::cos(alpha);
-        *y = y1;
-        *z = z1;
-        
-        // Rotate around Y
-        float x1 = *x * std::cos(beta) + *z * std::sin(beta);
-        float z2 = -*x * std::sin(beta) + *z * std::cos(beta);
-        *x = x1;
-        *z = z2;
-        
-        // Rotate around Z
-        float x2 = *x * std::cos(gamma) - *y * std::sin(gamma);
-        float y2 = *x * std::sin(gamma) + *y * std::cos(gamma);
-        *x = x2;
-        *y = y2;
+    //
+    // updateMatrix(group, channel)
+    //
+    // Rebuilds the matrix for _group_ if the angles for the four channels
+    // starting at _channel_ have changed since it was last built.  Rack's
+    // simd::sin and simd::cos are fast approximations that work on all four
+    // channels at once.
+    //
+    void updateMatrix(int group, int channel)
+    {
+        float_4 scale = 0.1f * twoPi;
+        float_4 alpha = params[ALPHA_PARAM].getValue() + inputs[ALPHA_INPUT].getPolyVoltageSimd<float_4>(channel) * scale;
+        float_4 beta = params[BETA_PARAM].getValue() + inputs[BETA_INPUT].getPolyVoltageSimd<float_4>(channel) * scale;
+        float_4 gamma = params[GAMMA_PARAM].getValue() + inputs[GAMMA_INPUT].getPolyVoltageSimd<float_4>(channel) * scale;
+
+        bool unchanged = simd::movemask(alpha == matrix_alpha[group]) == 0xF
+            && simd::movemask(beta == matrix_beta[group]) == 0xF
+            && simd::movemask(gamma == matrix_gamma[group]) == 0xF;
+
+        if (unchanged)
+            return;
+
+        matrix_alpha[group] = alpha;
+        matrix_beta[group] = beta;
+        matrix_gamma[group] = gamma;
+
+        float_4 sin_alpha = simd::sin(alpha);
+        float_4 cos_alpha = simd::cos(alpha);
+        float_4 sin_beta = simd::sin(beta);
+        float_4 cos_beta = simd::cos(beta);
+        float_4 sin_gamma = simd::sin(gamma);
+        float_4 cos_gamma = simd::cos(gamma);
+
+        // Rotate around X, then Y, then Z, applied to (x, y, 0)
+        RotationMatrix &matrix = matrices[group];
+        matrix.xx = cos_beta * cos_gamma;
+        matrix.xy = sin_alpha * sin_beta * cos_gamma - cos_alpha * sin_gamma;
+        matrix.yx = cos_beta * sin_gamma;
+        matrix.yy = sin_alpha * sin_beta * sin_gamma + cos_alpha * cos_gamma;
+        matrix.zx = -sin_beta;
+        matrix.zy = sin_alpha * cos_beta;
     }
 
     void process(const ProcessArgs& args) override
     {
-        // Get rotation angles (in radians)
-        float alpha = params[ALPHA_PARAM].getValue() + inputs[ALPHA_INPUT].getVoltage() * 0.1f * twoPi;
-        float beta = params[BETA_PARAM].getValue() + inputs[BETA_INPUT].getVoltage() * 0.1f * twoPi;
-        float gamma = params[GAMMA_PARAM].getValue() + inputs[GAMMA_INPUT].getVoltage() * 0.1f * twoPi;
-       
-        // Get input coordinates
-        float x = inputs[X_INPUT].getVoltage() / 5.f; // Scale from ±5V to ±1 range
-        float y = inputs[Y_INPUT].getVoltage() / 5.f;
-        float z = 0.f; // Default Z depth for input signals
-       
-        // Apply rotation
-        rotatePoint(&x, &y, &z, alpha, beta, gamma);
-       
-        // Output the rotated coordinates as voltages (-5V to +5V range)
-        outputs[X_OUTPUT].setVoltage(5.f * x);
-        outputs[Y_OUTPUT].setVoltage(5.f * y);
-        outputs[Z_OUTPUT].setVoltage(5.f * z);
+        int channels = std::max({1,
+            inputs[X_INPUT].getChannels(),
+            inputs[Y_INPUT].getChannels(),
+            inputs[ALPHA_INPUT].getChannels(),
+            inputs[BETA_INPUT].getChannels(),
+            inputs[GAMMA_INPUT].getChannels()});
+
+        // When the angles are the same for every channel, one matrix does for
+        // all of them
+        bool shared_angles = inputs[ALPHA_INPUT].getChannels() <= 1
+            && inputs[BETA_INPUT].getChannels() <= 1
+            && inputs[GAMMA_INPUT].getChannels() <= 1;
+
+        outputs[X_OUTPUT].setChannels(channels);
+        outputs[Y_OUTPUT].setChannels(channels);
+        outputs[Z_OUTPUT].setChannels(channels);
+
+        for (int c = 0; c < channels; c += 4)
+        {
+            int group = shared_angles ? 0 : c / 4;
+
+            if (c == 0 || !shared_angles)
+                updateMatrix(group, c);
+
+            const RotationMatrix &matrix = matrices[group];
+
+            // The inputs are scaled from ±5V to ±1 and the outputs back to
+            // ±5V.  Rotation is linear, so the two cancel out.
+            float_4 x = inputs[X_INPUT].getPolyVoltageSimd<float_4>(c);
+            float_4 y = inputs[Y_INPUT].getPolyVoltageSimd<float_4>(c);
+
+            outputs[X_OUTPUT].setVoltageSimd(matrix.xx * x + matrix.xy * y, c);
+            outputs[Y_OUTPUT].setVoltageSimd(matrix.yx * x + matrix.yy * y, c);
+            outputs[Z_OUTPUT].setVoltageSimd(matrix.zx * x + matrix.zy * y, c);
+        }
     }
 };
\ No newline at end of file
@@ -8,9 +8,12 @@ struct WavBank : VoxglitchSamplerModule
 	unsigned int trig_input_response_mode = TRIGGER;
 	std::string rootDir;
 	std::string path;
-	bool loading_samples = false;
 
-	std::vector<SamplePlayer> sample_players;
+	// The bank only decodes the selected sample and its neighbours, on a
+	// background thread.  selected_sample_player holds on to the sample that's
+	// currently playing, or is null while it's still being loaded.
+	LazySampleBank<SamplePlayer> sample_bank;
+	std::shared_ptr<SamplePlayer> selected_sample_player;
 	dsp::SchmittTrigger playTrigger;
 	DeclickFilter declick_filter;
 
@@ -53,6 +56,15 @@ struct WavBank : VoxglitchSamplerModule
 		configInput(TRIG_INPUT, "Trigger");
 		configInput(WAV_INPUT, "Wave Selection");
 		configInput(PITCH_INPUT, "Pitch");
+
+		// This runs on the bank's worker thread, where APP isn't available, so
+		// the step amount is set when the audio thread picks the sample up.
+		sample_bank.loader = [](SamplePlayer &sample_player, const std::string &path) {
+			return(sample_player.sample.load(path));
+		};
+		sample_bank.measure = [](SamplePlayer &sample_player) {
+			return((size_t) sample_player.sample.size() * 2 * sizeof(float));
+		};
 		// configSwitch(SWITCH_TEST, 0.0f, 1.0f, 1.0f, "Something", {"Value", "Other Value"});
 
 		#ifdef METAMODULE
@@ -88,35 +100,9 @@ struct WavBank : VoxglitchSamplerModule
 
 	void load_samples_from_path(std::string path)
 	{
-		loading_samples = true;
-
-		// Clear out any old .wav files
-		this->sample_players.clear();
-
-		// Load all .wav files found in the folder specified by 'path'
-		// this->rootDir = std::string(path);
-
-		std::vector<std::string> dirList = system::getEntries(path.c_str());
-
-		// Sort the vector.  This is in response to a user who's samples were being
-		// loaded out of order.  I think it's a mac thing.
-		sort(dirList.begin(), dirList.end());
-
-		// TODO: Consider supporting MP3.
-		for (auto path : dirList)
-		{
-			if (
-				(rack::string::lowercase(system::getExtension(path)) == "wav") ||
-				(rack::string::lowercase(system::getExtension(path)) == ".wav"))
-			{
-				SamplePlayer sample_player;
-
-				sample_player.loadSample(path);
-				this->sample_players.push_back(sample_player);
-			}
-		}
-
-		loading_samples = false;
+		// Only the folder listing is read here.  The audio is loaded on demand
+		// by the sample bank's worker thread.
+		this->sample_bank.scan(path);
 	}
 
 	float calculate_inputs(int input_index, int knob_index, int attenuator_index, float scale)
@@ -130,11 +116,19 @@ struct WavBank : VoxglitchSamplerModule
 
 	void process(const ProcessArgs &args) override
 	{
-		// If the samples are being loaded, don't do anything
-		if (loading_samples)
-			return;
+		// If a new folder was loaded, let go of the sample from the old one.
+		// The bank frees it later, off of the audio thread.
+		if (sample_bank.update())
+		{
+			selected_sample_player = nullptr;
+			selected_sample_slot = 0;
+		}
+
+		unsigned int number_of_samples = sample_bank.size();
 
-		unsigned int number_of_samples = sample_players.size();
+		// Nothing to play before a folder has been loaded
+		if (number_of_samples == 0)
+			return;
 
 		// Read the input/knob for sample selection
 		unsigned int wav_input_value = calculate_inputs(WAV_INPUT, WAV_KNOB, WAV_ATTN_KNOB, number_of_samples);
@@ -155,20 +149,45 @@ struct WavBank : VoxglitchSamplerModule
 			declick_filter.trigger();
 
 			// Reset sample position so playback does not start at previous sample position
-			sample_players[selected_sample_slot].stop();
+			if (selected_sample_player)
+				selected_sample_player->stop();
 
-			// Set the selected sample
+			// Set the selected sample.  Letting go of the old one doesn't free
+			// it, since the bank holds a reference until it's safe to.
 			selected_sample_slot = wav_input_value;
+			selected_sample_player = nullptr;
 
 			playback = false;
 		}
 
-		// Check to see if the selected sample slot refers to an existing sample.
-		// If not, return.  This could happen before any samples have been loaded.
-		if (!(sample_players.size() > selected_sample_slot))
-			return;
+		// Let the bank know which sample is wanted so that it (and its
+		// neighbours) get loaded if they haven't been already.
+		sample_bank.select(selected_sample_slot);
+
+		if (!selected_sample_player)
+		{
+			selected_sample_player = sample_bank.get(selected_sample_slot);
+
+			// Fade in from silence when a sample finishes loading
+			if (selected_sample_player)
+			{
+				selected_sample_player->updateStepAmount(args.sampleRate);
+				declick_filter.trigger();
+			}
+		}
 
-		SamplePlayer *selected_sample_player = &sample_players[selected_sample_slot];
+		// While the selected sample is still loading, fade the output to silence.
+		if (!selected_sample_player)
+		{
+			float left_audio = 0.0;
+			float right_audio = 0.0;
+
+			declick_filter.process(&left_audio, &right_audio);
+
+			outputs[WAV_LEFT_OUTPUT].setVoltage(left_audio * GAIN);
+			outputs[WAV_RIGHT_OUTPUT].setVoltage(right_audio * GAIN);
+			return;
+		}
 
 		if (inputs[TRIG_INPUT].isConnected())
 		{
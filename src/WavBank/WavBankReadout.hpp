@@ -25,7 +25,10 @@ struct WavBankReadout : TransparentWidget
         {
             text_to_display = "";
 
-            unsigned int number_of_sample = module->sample_players.size();
+            // The folder the UI sees might be newer than the one the module
+            // is playing from, but it can't change while it's being drawn
+            std::shared_ptr<LazySampleBank<SamplePlayer>::Folder> folder = module->sample_bank.getFolder();
+            unsigned int number_of_sample = folder->size();
 
             if (number_of_sample > 0)
             {
@@ -68,7 +71,7 @@ struct WavBankReadout : TransparentWidget
 
                 for (unsigned int i = window_start; i < window_end; i++)
                 {
-                    text_to_display = module->sample_players[i].sample.display_name;
+                    text_to_display = folder->getDisplayName(i);
                     text_to_display.resize(22);
 
                     if (i == module->selected_sample_slot || (show_hover_effect && hover_row == i))
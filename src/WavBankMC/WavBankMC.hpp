@@ -27,7 +27,16 @@ struct WavBankMC : VoxglitchSamplerModule
 
   unsigned int number_of_samples = 0;
   bool smoothing = true;
-	std::vector<SampleMC> samples;
+
+  // The bank only decodes the selected sample and its neighbours, on a
+  // background thread.  selected_sample holds on to the sample that's
+  // currently playing, or is null while it's still being loaded.
+  LazySampleBank<SampleMC> sample_bank;
+  std::shared_ptr<SampleMC> selected_sample;
+
+  // A sample picked from the readout, waiting for process() to select it, or
+  // -1.  Only the audio thread touches selected_sample.
+  std::atomic<int> requested_sample_slot {-1};
   unsigned int sample_change_mode = RESTART_PLAYBACK;
 
 	enum ParamIds {
@@ -77,6 +86,14 @@ struct WavBankMC : VoxglitchSamplerModule
     reset_all_playback_positions();
     set_all_playback_flags(false);
 
+    sample_bank.loader = [](SampleMC &sample, const std::string &path) {
+      sample.load(path);
+      return(sample.loaded);
+    };
+    sample_bank.measure = [](SampleMC &sample) {
+      return((size_t) sample.size() * sample.number_of_channels * sizeof(float));
+    };
+
     // This is a variable that helps us detect if there's been any knob
     // movement, which is important if the user is trying to dial in a sample
     // using the selection know while no CV input is present
@@ -146,7 +163,7 @@ struct WavBankMC : VoxglitchSamplerModule
 
   void increment_selected_sample()
   {
-    change_selected_sample((selected_sample_slot + 1) % this->samples.size());
+    change_selected_sample((selected_sample_slot + 1) % this->sample_bank.size());
   }
 
   void decrement_selected_sample()
@@ -157,13 +174,13 @@ struct WavBankMC : VoxglitchSamplerModule
     }
     else
     {
-      change_selected_sample(this->samples.size() - 1);
+      change_selected_sample(this->sample_bank.size() - 1);
     }
   }
 
   void change_selected_sample(unsigned int new_sample_slot)
   {
-    if(this->samples.size() != 0)
+    if(this->sample_bank.size() != 0)
     {
       // Reset the smooth ramp if the selected sample has changed
       smooth_all_channels();
@@ -174,11 +191,20 @@ struct WavBankMC : VoxglitchSamplerModule
         set_all_playback_flags(false);
       }
 
-      // Set the selected sample
+      // Set the selected sample.  Letting go of the old one doesn't free
+      // it, since the bank holds a reference until it's safe to.
       selected_sample_slot = new_sample_slot;
+      selected_sample = nullptr;
     }
   }
 
+  // Called from the UI thread.  The selection happens in process().
+  void request_selected_sample(unsigned int new_sample_slot)
+  {
+    requested_sample_slot = new_sample_slot;
+    params[WAV_KNOB].setValue((float) new_sample_slot / (float) number_of_samples);
+  }
+
   void process_wav_cv_input()
   {
     unsigned int wav_input_value = calculate_inputs(WAV_INPUT, WAV_KNOB, WAV_ATTN_KNOB, number_of_samples);
@@ -206,7 +232,7 @@ struct WavBankMC : VoxglitchSamplerModule
   {
     unsigned int wav_input_value = params[WAV_KNOB].getValue() * number_of_samples;
 
-    if(this->samples.size() == 0) return;
+    if(this->sample_bank.size() == 0) return;
 
 		wav_input_value = clamp(wav_input_value, 0, number_of_samples - 1);
     previous_wav_knob_value = params[WAV_KNOB].getValue();
@@ -226,7 +252,7 @@ struct WavBankMC : VoxglitchSamplerModule
 
   void process_wav_navigation_buttons()
   {
-    if(this->samples.size() == 0) return;
+    if(this->sample_bank.size() == 0) return;
 
     // If next_wav button is pressed, step to the next sample
     bool next_wav_is_triggered = next_wav_cv_trigger.process(inputs[NEXT_WAV_TRIGGER_INPUT].getVoltage(), constants::gate_low_trigger, constants::gate_high_trigger) || next_wav_button_trigger.process(params[NEXT_WAV_BUTTON_PARAM].getValue());
@@ -247,64 +273,13 @@ struct WavBankMC : VoxglitchSamplerModule
     }
   }
 
-  void sort_samples_by_filename(std::vector<SampleMC>& samples)
-  {
-      std::sort(samples.begin(), samples.end(), [](const SampleMC& a, const SampleMC& b) {
-          return a.filename < b.filename;
-      });
-  }
-
 	void load_samples_from_path(std::string path)
 	{
-		// Clear out any old .wav files
-    // Reminder: this->samples is a vector, and vectors have a .clear() menthod.
-		this->samples.clear();
-
-		// Load all .wav files found in the folder specified by 'path'
 		this->rootDir = path;
 
-		std::vector<std::string> dirList = system::getEntries(path.c_str());
-
-    // Sort the vector.  This is in response to a user who's samples were being
-    // loaded out of order.  I think it's a mac thing.
-    sort(dirList.begin(), dirList.end());
-
-    printf("dirList.size(): %d\n", dirList.size());
-
-		// TODO: Decide on a maximum memory consuption allowed and abort if
-		// that amount of member would be exhausted by loading all of the files
-		// in the folder.
-		for (auto entry : dirList)
-		{
-      printf("entry: %s\n", entry.c_str());
-			if (
-        // Something happened in Rack 2 where the extension started to include
-        // the ".", so I decided to check for both versions, just in case.
-        (rack::string::lowercase(system::getExtension(entry)) == "wav") ||
-        (rack::string::lowercase(system::getExtension(entry)) == ".wav")
-      )
-			{
-        // Create new multi-channel sample.  This structure is defined in Common/sample_mc.hpp
-				SampleMC new_sample;
-
-        printf("entry: %s\n", entry.c_str());
-
-        // Load the sample data from the disk
-				new_sample.load(entry);
-
-        printf("new_sample.filename: %s\n", new_sample.filename.c_str());
-
-        // Reminder: .push_back is a method of vectors that pushes the object
-        // to the end of a list.
-				this->samples.push_back(new_sample);
-			}
-		}
-
-    printf("this->samples.size(): %d\n", this->samples.size());
-
-    // Sort the samples vector based on a member attribute, e.g., filename
-    sort_samples_by_filename(this->samples);
-
+    // Only the folder listing is read here.  The audio is loaded on demand by
+    // the sample bank's worker thread.  The bank sorts the files by name.
+		this->sample_bank.scan(path);
 	}
 
   // Helper functions used by WavBankMCReadout
@@ -318,6 +293,27 @@ struct WavBankMC : VoxglitchSamplerModule
     params[WAV_KNOB].setValue((float) selected_sample_slot / (float) number_of_samples);
   }
 
+  void fade_outputs_to_silence(float smooth_rate)
+  {
+    for(unsigned int channel = 0; channel < NUMBER_OF_CHANNELS; channel++)
+    {
+      float output_voltage = 0.0;
+
+      if(this->smoothing && (smooth_ramp[channel] < 1))
+      {
+        smooth_ramp[channel] += smooth_rate;
+        output_voltage = last_output_voltage[channel] * (1 - smooth_ramp[channel]);
+      }
+      last_output_voltage[channel] = output_voltage;
+
+      output_voltage *= 5.0f;  // Scale -1/+1 to -5V/+5V
+      outputs[POLY_WAV_OUTPUT].setVoltage(output_voltage, channel);
+
+      if(channel == 0) outputs[LEFT_WAV_OUTPUT].setVoltage(output_voltage);
+      if(channel == 1) outputs[RIGHT_WAV_OUTPUT].setVoltage(output_voltage);
+    }
+  }
+
 	float calculate_inputs(int input_index, int knob_index, int attenuator_index, float scale)
 	{
 		float input_value = inputs[input_index].getVoltage() / 10.0;
@@ -330,10 +326,26 @@ struct WavBankMC : VoxglitchSamplerModule
 	void process(const ProcessArgs &args) override
 	{
 
-		number_of_samples = samples.size();
+    // If a new folder was loaded, let go of the sample from the old one.
+    // The bank frees it later, off of the audio thread.
+    if(sample_bank.update())
+    {
+      selected_sample = nullptr;
+      selected_sample_slot = 0;
+      requested_sample_slot = -1;
+    }
+
+		number_of_samples = sample_bank.size();
     sample_time = args.sampleTime;
     float smooth_rate = (128.0f / args.sampleRate);
 
+    // Pick up a selection made from the readout
+    int requested_slot = requested_sample_slot.exchange(-1);
+    if(requested_slot >= 0 && (unsigned int) requested_slot < number_of_samples && (unsigned int) requested_slot != selected_sample_slot)
+    {
+      change_selected_sample(requested_slot);
+    }
+
 		// If there's a cable in the wav cv input, it has precendence over all
     // other methods of selecting the .wav file.  If there isn't, then the
     // selected wav file can be incremented, decremented, or reset using the
@@ -350,9 +362,26 @@ struct WavBankMC : VoxglitchSamplerModule
 
 		// Check to see if the selected sample slot refers to an existing sample.
 		// If not, return.  This edge case could happen before any samples have been loaded.
-		if(selected_sample_slot >= samples.size()) return;
+		if(selected_sample_slot >= number_of_samples) return;
+
+    // Let the bank know which sample is wanted so that it (and its neighbours)
+    // get loaded if they haven't been already.
+    sample_bank.select(selected_sample_slot);
+
+    if(! selected_sample)
+    {
+      selected_sample = sample_bank.get(selected_sample_slot);
+
+      // Fade in from whatever was last output when a sample finishes loading
+      if(selected_sample) smooth_all_channels();
+    }
 
-		SampleMC *selected_sample = &samples[selected_sample_slot];
+    // While the selected sample is still loading, fade the outputs to silence
+    if(! selected_sample)
+    {
+      fade_outputs_to_silence(smooth_rate);
+      return;
+    }
 
     // If either the TRG CV input is triggered or the corresponding button is
     // pressed, then restart all playback positions and start playback.
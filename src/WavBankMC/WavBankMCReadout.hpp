@@ -34,21 +34,25 @@ struct WavBankMCReadout : TransparentWidget
       nvgFill(args.vg);
       */
 
-      if(module->samples.size() > 0)
+      // The folder the UI sees might be newer than the one the module is
+      // playing from, but it can't change while it's being drawn
+      std::shared_ptr<LazySampleBank<SampleMC>::Folder> folder = module->sample_bank.getFolder();
+
+      if(folder->size() > 0)
       {
         // When there are too many sample filenames to fit on the front panel,
         // then we'll show a window into the sample list.  Here's where the
         // window start and end are computed.
 
         window_start = 0;
-        window_end = module->samples.size();
+        window_end = folder->size();
 
         // If there are more samples than can naturally fit in the display, then
         // we'll do some extra work to scroll the panel list if necessary.
-        if(! (module->samples.size() < NUMBER_OF_SAMPLE_DISPLAY_ROWS))
+        if(! (folder->size() < NUMBER_OF_SAMPLE_DISPLAY_ROWS))
         {
           unsigned int half_display_location = (NUMBER_OF_SAMPLE_DISPLAY_ROWS / 2);
-          unsigned int number_of_loaded_samples = module->samples.size();
+          unsigned int number_of_loaded_samples = folder->size();
 
           if(module->selected_sample_slot > half_display_location)
           {
@@ -74,7 +78,7 @@ struct WavBankMCReadout : TransparentWidget
 
         for(unsigned int i = window_start; i < window_end; i++)
         {
-          text_to_display = module->samples[i].display_name;
+          text_to_display = folder->getDisplayName(i);
           text_to_display.resize(22);
 
           if(i == module->selected_sample_slot || (show_hover_effect && hover_row == i))
@@ -149,8 +153,7 @@ struct WavBankMCReadout : TransparentWidget
         {
           if((row + window_start) < module->number_of_samples)
           {
-            module->change_selected_sample(row + window_start);
-            module->set_wav_knob_position();
+            module->request_selected_sample(row + window_start);
           }
         }
       }
@@ -20,6 +20,7 @@
 #include "vgLib-2.0/constants.h"
 #include "vgLib-2.0/sample.hpp"
 #include "vgLib-2.0/dsp/DeclickFilter.hpp"
+#include "vgLib-2.0/dsp/ClockTracker.hpp"
 #include "vgLib-2.0/components/VoxglitchComponents.hpp"
 
 using namespace vgLib_v2;
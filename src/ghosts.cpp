@@ -15,6 +15,7 @@
 #include "vgLib-2.0/components/VoxglitchComponents.hpp"
 #include "vgLib-2.0/dsp/Random.hpp"
 #include "vgLib-2.0/dsp/StereoSmooth.hpp"
+#include "vgLib-2.0/Telemetry.hpp"
 #include "vgLib-2.0/widgets/WaveformModel.hpp"
 #include "vgLib-2.0/widgets/WaveformWidget.hpp"
 
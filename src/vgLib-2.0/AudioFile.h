@@ -36,6 +36,9 @@
 #include <iterator>
 #include <algorithm>
 
+#include "dsp/PolyphaseResampler.hpp"
+#include "PcmDecoder.hpp"
+
 
 //=============================================================
 /** The different types of audio file, plus some other types to 
@@ -506,9 +509,14 @@ bool AudioFile<T>::decodeWaveFile (std::vector<uint8_t>& fileData)
     
     int numBytesPerSample = bitDepth / 8;
     
+    // WAVE_FORMAT_EXTENSIBLE files keep the real format in the first two
+    // bytes of the sub-format GUID
+    if ((uint16_t)audioFormat == 0xFFFE && fourBytesToInt (fileData, f + 4) >= 26)
+        audioFormat = twoBytesToInt (fileData, f + 32);
+    
     // Perform validation checks
-    // check that the audio format is PCM
-    if (audioFormat != 1)
+    // check that the audio format is PCM or floating point
+    if (audioFormat != 1 && audioFormat != 3)
     {
         printf("ERROR: this is a compressed .WAV file and this library does not support decoding them at present\n");
         return false;
@@ -528,64 +536,39 @@ bool AudioFile<T>::decodeWaveFile (std::vector<uint8_t>& fileData)
         return false;
     }
     
-    // check bit depth is either 8, 16 or 24 bit
-    if (bitDepth != 8 && bitDepth != 16 && bitDepth != 24)
+    // check bit depth is supported: 8, 16, 24 or 32 bit integer, or 32 bit float
+    PcmDecoder::Encoding encoding;
+    
+    if (audioFormat == 3 && bitDepth == 32)
+        encoding = PcmDecoder::FLOAT_32;
+    else if (audioFormat == 1 && bitDepth == 8)
+        encoding = PcmDecoder::UNSIGNED_8;
+    else if (audioFormat == 1 && bitDepth == 16)
+        encoding = PcmDecoder::SIGNED_16;
+    else if (audioFormat == 1 && bitDepth == 24)
+        encoding = PcmDecoder::SIGNED_24;
+    else if (audioFormat == 1 && bitDepth == 32)
+        encoding = PcmDecoder::SIGNED_32;
+    else
     {
-        printf("ERROR: this file has a bit depth that is not 8, 16 or 24 bits\n");
+        printf("ERROR: this file has a bit depth that is not 8, 16, 24 or 32 bits\n");
         return false;
     }
     
     // -----------------------------------------------------------
     // DATA CHUNK
     int d = indexOfDataChunk;
-    int32_t dataChunkSize = fourBytesToInt (fileData, d + 4);
+    uint32_t dataChunkSize = (uint32_t) fourBytesToInt (fileData, d + 4);
+    size_t samplesStartIndex = indexOfDataChunk + 8;
     
-    int numSamples = dataChunkSize / (numChannels * bitDepth / 8);
-    int samplesStartIndex = indexOfDataChunk + 8;
+    // Never read past the end of the file, even if the data chunk claims to
+    // be longer (some recorders write a placeholder size while streaming)
+    size_t availableBytes = fileData.size() - std::min (samplesStartIndex, fileData.size());
+    size_t numSamples = std::min ((size_t) dataChunkSize, availableBytes) / numBytesPerBlock;
     
-    // Clear any existing data and pre-allocate memory for efficiency
+    // Decode straight into buffers that are sized once, up front
     clearAudioBuffer();
-    samples.resize(numChannels);
-    
-    // Pre-allocate each channel's sample vector to avoid expensive reallocations
-    for (int channel = 0; channel < numChannels; channel++) {
-        samples[channel].reserve(numSamples);
-    }
-    
-    for (int i = 0; i < numSamples; i++)
-    {
-        for (int channel = 0; channel < numChannels; channel++)
-        {
-            int sampleIndex = samplesStartIndex + (numBytesPerBlock * i) + channel * numBytesPerSample;
-            
-            if (bitDepth == 8)
-            {
-                T sample = singleByteToSample (fileData[sampleIndex]);
-                samples[channel].push_back (sample);
-            }
-            else if (bitDepth == 16)
-            {
-                int16_t sampleAsInt = twoBytesToInt (fileData, sampleIndex);
-                T sample = sixteenBitIntToSample (sampleAsInt);
-                samples[channel].push_back (sample);
-            }
-            else if (bitDepth == 24)
-            {
-                int32_t sampleAsInt = 0;
-                sampleAsInt = (fileData[sampleIndex + 2] << 16) | (fileData[sampleIndex + 1] << 8) | fileData[sampleIndex];
-                
-                if (sampleAsInt & 0x800000) //  if the 24th bit is set, this is a negative number in 24-bit world
-                    sampleAsInt = sampleAsInt | ~0xFFFFFF; // so make sure sign is extended to the 32 bit float
-
-                T sample = (T)sampleAsInt / (T)8388608.;
-                samples[channel].push_back (sample);
-            }
-            else
-            {
-                assert (false);
-            }
-        }
-    }
+    PcmDecoder::decode (fileData.data() + samplesStartIndex, numSamples, numChannels, encoding, false, samples);
 
     return true;
 }
@@ -634,10 +617,10 @@ bool AudioFile<T>::decodeAiffFile (std::vector<uint8_t>& fileData)
         return false;
     }
     
-    // check bit depth is either 8, 16 or 24 bit
-    if (bitDepth != 8 && bitDepth != 16 && bitDepth != 24)
+    // check bit depth is either 8, 16, 24 or 32 bit
+    if (bitDepth != 8 && bitDepth != 16 && bitDepth != 24 && bitDepth != 32)
     {
-        // std::cout << "ERROR: this file has a bit depth that is not 8, 16 or 24 bits" << std::endl;
+        // std::cout << "ERROR: this file has a bit depth that is not 8, 16, 24 or 32 bits" << std::endl;
         return false;
     }
     
@@ -649,60 +632,24 @@ bool AudioFile<T>::decodeAiffFile (std::vector<uint8_t>& fileData)
     
     int numBytesPerSample = bitDepth / 8;
     int numBytesPerFrame = numBytesPerSample * numChannels;
-    int totalNumAudioSampleBytes = numSamplesPerChannel * numBytesPerFrame;
-    int samplesStartIndex = s + 16 + (int)offset;
+    int64_t totalNumAudioSampleBytes = (int64_t) numSamplesPerChannel * numBytesPerFrame;
+    int64_t samplesStartIndex = s + 16 + (int64_t) offset;
         
     // sanity check the data
-    if ((soundDataChunkSize - 8) != totalNumAudioSampleBytes || totalNumAudioSampleBytes > (fileData.size() - samplesStartIndex))
+    if (numSamplesPerChannel < 0 || offset < 0 || samplesStartIndex > (int64_t) fileData.size() || (soundDataChunkSize - 8) != totalNumAudioSampleBytes || totalNumAudioSampleBytes > ((int64_t) fileData.size() - samplesStartIndex))
     {
         // std::cout << "ERROR: the metadatafor this file doesn't seem right" << std::endl;
         return false;
     }
     
-    // Clear existing data and pre-allocate for efficiency
-    clearAudioBuffer();
-    samples.resize(numChannels);
-    
-    // Pre-allocate each channel's vector to avoid reallocation
-    for (int channel = 0; channel < numChannels; channel++) {
-        samples[channel].reserve(numSamplesPerChannel);
-    }
+    // Decode straight into buffers that are sized once, up front
+    PcmDecoder::Encoding encoding = PcmDecoder::SIGNED_8;
+    if (bitDepth == 16) encoding = PcmDecoder::SIGNED_16;
+    else if (bitDepth == 24) encoding = PcmDecoder::SIGNED_24;
+    else if (bitDepth == 32) encoding = PcmDecoder::SIGNED_32;
     
-    for (int i = 0; i < numSamplesPerChannel; i++)
-    {
-        for (int channel = 0; channel < numChannels; channel++)
-        {
-            int sampleIndex = samplesStartIndex + (numBytesPerFrame * i) + channel * numBytesPerSample;
-            
-            if (bitDepth == 8)
-            {
-                int8_t sampleAsSigned8Bit = (int8_t)fileData[sampleIndex];
-                T sample = (T)sampleAsSigned8Bit / (T)128.;
-                samples[channel].push_back (sample);
-            }
-            else if (bitDepth == 16)
-            {
-                int16_t sampleAsInt = twoBytesToInt (fileData, sampleIndex, Endianness::BigEndian);
-                T sample = sixteenBitIntToSample (sampleAsInt);
-                samples[channel].push_back (sample);
-            }
-            else if (bitDepth == 24)
-            {
-                int32_t sampleAsInt = 0;
-                sampleAsInt = (fileData[sampleIndex] << 16) | (fileData[sampleIndex + 1] << 8) | fileData[sampleIndex + 2];
-                
-                if (sampleAsInt & 0x800000) //  if the 24th bit is set, this is a negative number in 24-bit world
-                    sampleAsInt = sampleAsInt | ~0xFFFFFF; // so make sure sign is extended to the 32 bit float
-                
-                T sample = (T)sampleAsInt / (T)8388608.;
-                samples[channel].push_back (sample);
-            }
-            else
-            {
-                assert (false);
-            }
-        }
-    }
+    clearAudioBuffer();
+    PcmDecoder::decode (fileData.data() + samplesStartIndex, numSamplesPerChannel, numChannels, encoding, true, samples);
     
     return true;
 }
@@ -1112,11 +1059,9 @@ int AudioFile<T>::getIndexOfString (std::vector<uint8_t>& source, std::string st
     int index = -1;
     int stringLength = (int)stringToSearchFor.length();
     
-    for (int i = 0; i < source.size() - stringLength;i++)
+    for (int i = 0; i + stringLength < (int)source.size(); i++)
     {
-        std::string section (source.begin() + i, source.begin() + i + stringLength);
-        
-        if (section == stringToSearchFor)
+        if (memcmp (source.data() + i, stringToSearchFor.data(), stringLength) == 0)
         {
             index = i;
             break;
@@ -1174,45 +1119,16 @@ bool AudioFile<T>::resampleToTargetRate(uint32_t targetSampleRate)
     if (sampleRate == targetSampleRate || getNumSamplesPerChannel() == 0)
         return true;
             
-    // We would implement the resampler here, but since this is a stub for demonstration, 
-    // let's assume we have the same SampleRateConverter class from waves.cpp
-    
-    // The implementation would be similar to this pseudocode:
-    // 1. For each channel:
-    //    a. Create a new buffer for resampled data
-    //    b. Use the SampleRateConverter to convert the data
-    //    c. Replace the original channel data with the resampled data
-    // 2. Update the sample rate
-    
-    // As a placeholder for this example, we'll resize the buffer by the ratio of rates
-    // In a real implementation, use a proper resampling algorithm
-    double rateRatio = (double)targetSampleRate / (double)sampleRate;
-    int newNumSamples = (int)(getNumSamplesPerChannel() * rateRatio);
-    
-    // Create temporary buffers for each channel 
-    std::vector<std::vector<T>> newSamples(getNumChannels());
-    
-    // Pre-allocate the right size for each channel to avoid reallocations
-    for (int channel = 0; channel < getNumChannels(); channel++) {
-        newSamples[channel].resize(newNumSamples, 0);
-        
-        // Simple linear interpolation (just for demonstration - not high quality)
-        // In a real implementation, use a proper resampling algorithm
-        for (int i = 0; i < newNumSamples; i++) {
-            double sourceIndex = i / rateRatio;
-            int sourceIndex1 = (int)sourceIndex;
-            int sourceIndex2 = std::min(sourceIndex1 + 1, getNumSamplesPerChannel() - 1);
-            double alpha = sourceIndex - sourceIndex1;
-            
-            // Linear interpolation
-            newSamples[channel][i] = (T)((1.0 - alpha) * samples[channel][sourceIndex1] + 
-                                         alpha * samples[channel][sourceIndex2]);
-        }
-    }
-    
-    // Replace the samples with the resampled data
-    for (int channel = 0; channel < getNumChannels(); channel++) {
-        samples[channel] = std::move(newSamples[channel]); // Use move for efficiency
+    // Convert each channel with a windowed-sinc polyphase resampler.  The
+    // filter is designed once per channel, which is cheap compared to the
+    // conversion itself.
+    PolyphaseResampler resampler;
+
+    for (int channel = 0; channel < getNumChannels(); channel++)
+    {
+        std::vector<T> resampled;
+        resampler.process(samples[channel], resampled, (double) sampleRate, (double) targetSampleRate);
+        samples[channel].swap(resampled); // Old data is freed when resampled goes out of scope
     }
     
     // Update the sample rate
@@ -0,0 +1,689 @@
+/*
+  BytebeatExpression.hpp
+
+  A small compiler and interpreter for user-written bytebeat expressions,
+  such as "t*((t>>12|t>>8)&63&t>>4)".
+
+  Expressions use C's integer operators and precedence, on unsigned 32 bit
+  values, with the inputs t, p1, p2 and p3:
+
+    ?:  ||  &&  |  ^  &  == !=  < > <= >=  << >>  + -  * / %  unary - ~ ! +
+
+  A few choices keep every expression safe to run on the audio thread:
+
+  - Division or modulo by zero gives zero, like the div() and mod() helpers
+    that the built-in equations use.
+  - Shift amounts are taken modulo 32, as in JavaScript, where most bytebeat
+    expressions are written.
+  - && and || always evaluate both sides, and ?: evaluates both branches.
+    There are no side effects, so this only matters for speed.
+
+  Compiling parses the expression once, folds any constant sub-expressions,
+  and produces a short list of register-based instructions.  Instead of
+  running the whole program once per value of t, the interpreter runs each
+  instruction over a block of consecutive t values.  The cost of decoding an
+  instruction is paid once per block, and each instruction's inner loop is
+  simple enough for the compiler to vectorize.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <atomic>
+
+#include "PublishedValue.hpp"
+
+struct BytebeatProgram
+{
+  enum Opcode : uint8_t
+  {
+    ADD, SUB, MUL, DIV, MOD,
+    AND, OR, XOR, SHL, SHR,
+    LT, GT, LE, GE, EQ, NE,
+    LOGICAL_AND, LOGICAL_OR,
+    NEG, NOT, LOGICAL_NOT,
+    SELECT
+  };
+
+  struct Instruction
+  {
+    uint8_t opcode;
+    uint8_t destination;
+    uint8_t a;
+    uint8_t b;
+    uint8_t c;   // Only used by SELECT
+  };
+
+  struct Constant
+  {
+    uint8_t destination;
+    uint32_t value;
+  };
+
+  // Registers 0 to 3 hold t, p1, p2 and p3
+  static const unsigned int REGISTER_T = 0;
+  static const unsigned int REGISTER_P1 = 1;
+  static const unsigned int REGISTER_P2 = 2;
+  static const unsigned int REGISTER_P3 = 3;
+  static const unsigned int FIRST_FREE_REGISTER = 4;
+  static const unsigned int MAX_REGISTERS = 48;
+
+  std::string source;
+  std::vector<Constant> constants;
+  std::vector<Instruction> code;
+  unsigned int register_count = FIRST_FREE_REGISTER;
+  unsigned int result = REGISTER_T;
+
+  // Apply an operator to single values.  This defines what each operator
+  // means, and is used both for constant folding and by the interpreter.
+  static inline uint32_t apply(uint8_t opcode, uint32_t a, uint32_t b, uint32_t c = 0)
+  {
+    switch (opcode)
+    {
+      case ADD: return(a + b);
+      case SUB: return(a - b);
+      case MUL: return(a * b);
+      case DIV: return((b == 0) ? 0 : (a / b));
+      case MOD: return((b == 0) ? 0 : (a % b));
+      case AND: return(a & b);
+      case OR: return(a | b);
+      case XOR: return(a ^ b);
+      case SHL: return(a << (b & 31));
+      case SHR: return(a >> (b & 31));
+      case LT: return(a < b);
+      case GT: return(a > b);
+      case LE: return(a <= b);
+      case GE: return(a >= b);
+      case EQ: return(a == b);
+      case NE: return(a != b);
+      case LOGICAL_AND: return((a != 0) && (b != 0));
+      case LOGICAL_OR: return((a != 0) || (b != 0));
+      case NEG: return(0u - a);
+      case NOT: return(~a);
+      case LOGICAL_NOT: return(a == 0);
+      case SELECT: return((a != 0) ? b : c);
+    }
+    return(0);
+  }
+};
+
+//
+// BytebeatCompiler
+//
+// Turns the text of an expression into a BytebeatProgram.  This allocates
+// memory, so it should be called from the UI thread, never from process().
+//
+// The parser and the code generator are recursive, and the text is typed by
+// the user, so both are limited to MAX_DEPTH levels.  Deeper expressions,
+// like a long run of "(", are a compile error instead of a stack overflow.
+//
+
+struct BytebeatCompiler
+{
+  struct Node
+  {
+    bool constant = false;
+    uint32_t value = 0;        // For constants
+    int input = -1;            // For t, p1, p2 and p3, the input's register
+    uint8_t opcode = 0;        // For operators
+    int a = -1;
+    int b = -1;
+    int c = -1;
+    unsigned int depth = 0;    // Operators between this node and the inputs
+  };
+
+  static const unsigned int MAX_DEPTH = 256;
+
+  std::string text;
+  size_t position = 0;
+  unsigned int nesting = 0;   // Parser recursion
+  std::string error;
+  std::vector<Node> nodes;
+
+  // Code generation
+  BytebeatProgram *program = nullptr;
+  std::vector<bool> register_in_use;
+  std::map<uint32_t, unsigned int> constant_registers;
+
+  static bool compile(const std::string &source, BytebeatProgram &program, std::string *error = nullptr)
+  {
+    BytebeatCompiler compiler;
+    bool success = compiler.run(source, program);
+    if (error) *error = compiler.error;
+    return(success);
+  }
+
+  bool run(const std::string &source, BytebeatProgram &output)
+  {
+    text = source;
+    position = 0;
+
+    int root = parseExpression();
+
+    if (error.empty())
+    {
+      skipSpace();
+      if (position < text.size()) fail("unexpected '" + text.substr(position, 1) + "'");
+    }
+
+    if (! error.empty()) return(false);
+
+    BytebeatProgram compiled;
+    compiled.source = source;
+
+    program = &compiled;
+    register_in_use.assign(BytebeatProgram::MAX_REGISTERS, false);
+    for (unsigned int i = 0; i < BytebeatProgram::FIRST_FREE_REGISTER; i++) register_in_use[i] = true;
+
+    // Constants are loaded before the program runs, so they get registers
+    // of their own before any temporaries are handed out.
+    if (! allocateConstants(root)) return(false);
+
+    int result = generate(root);
+    if (result < 0) return(false);
+
+    compiled.result = result;
+    output = compiled;
+
+    return(true);
+  }
+
+  //
+  // Parsing
+  //
+
+  void fail(const std::string &message)
+  {
+    if (error.empty()) error = message + " at position " + std::to_string(position + 1);
+  }
+
+  void skipSpace()
+  {
+    while (position < text.size() && std::isspace((unsigned char) text[position])) position++;
+  }
+
+  bool match(const char *token)
+  {
+    skipSpace();
+    size_t length = std::strlen(token);
+    if (text.compare(position, length, token) != 0) return(false);
+    position += length;
+    return(true);
+  }
+
+  int addNode(const Node &node)
+  {
+    nodes.push_back(node);
+    return(nodes.size() - 1);
+  }
+
+  int makeConstant(uint32_t value)
+  {
+    Node node;
+    node.constant = true;
+    node.value = value;
+    return(addNode(node));
+  }
+
+  // Create an operator node, or fold it into a constant if all of its
+  // operands are constants.
+  int makeOperator(uint8_t opcode, int a, int b = -1, int c = -1)
+  {
+    if (a < 0 || (b < -1) || (c < -1)) return(-1);
+
+    bool constant = nodes[a].constant && (b < 0 || nodes[b].constant) && (c < 0 || nodes[c].constant);
+
+    if (constant)
+    {
+      return(makeConstant(BytebeatProgram::apply(opcode, nodes[a].value, (b < 0) ? 0 : nodes[b].value, (c < 0) ? 0 : nodes[c].value)));
+    }
+
+    Node node;
+    node.opcode = opcode;
+    node.a = a;
+    node.b = b;
+    node.c = c;
+    node.depth = 1 + std::max(nodes[a].depth, std::max((b < 0) ? 0 : nodes[b].depth, (c < 0) ? 0 : nodes[c].depth));
+
+    // Code generation recurses once per level.  Even without any brackets,
+    // a long chain like "t+t+t+..." is one level per operator.
+    if (node.depth > MAX_DEPTH)
+    {
+      fail("expression is too deeply nested");
+      return(-1);
+    }
+
+    return(addNode(node));
+  }
+
+  // Keeps track of the parser's recursion.  Returns false, after reporting
+  // an error, if it has gone too deep.
+  bool enter()
+  {
+    if (++nesting > MAX_DEPTH)
+    {
+      fail("expression is too deeply nested");
+      return(false);
+    }
+    return(true);
+  }
+
+  int parseExpression()
+  {
+    if (! enter()) return(-1);
+    int result = parseConditional();
+    nesting--;
+    return(result);
+  }
+
+  int parseConditional()
+  {
+    int condition = parseBinary(0);
+    if (condition < 0) return(-1);
+
+    if (match("?"))
+    {
+      int if_true = parseExpression();
+      if (! match(":")) { fail("expected ':'"); return(-1); }
+      int if_false = parseExpression();
+      if (if_true < 0 || if_false < 0) return(-1);
+      return(makeOperator(BytebeatProgram::SELECT, condition, if_true, if_false));
+    }
+
+    return(condition);
+  }
+
+  // Binary operators, from lowest to highest precedence.  Longer tokens are
+  // listed before shorter ones that they start with.
+  struct BinaryOperator
+  {
+    const char *token;
+    uint8_t opcode;
+    unsigned int level;
+  };
+
+  static const BinaryOperator *binaryOperators(unsigned int *count)
+  {
+    static const BinaryOperator operators[] = {
+      { "||", BytebeatProgram::LOGICAL_OR, 0 },
+      { "&&", BytebeatProgram::LOGICAL_AND, 1 },
+      { "|", BytebeatProgram::OR, 2 },
+      { "^", BytebeatProgram::XOR, 3 },
+      { "&", BytebeatProgram::AND, 4 },
+      { "==", BytebeatProgram::EQ, 5 },
+      { "!=", BytebeatProgram::NE, 5 },
+      { "<<", BytebeatProgram::SHL, 7 },
+      { ">>", BytebeatProgram::SHR, 7 },
+      { "<=", BytebeatProgram::LE, 6 },
+      { ">=", BytebeatProgram::GE, 6 },
+      { "<", BytebeatProgram::LT, 6 },
+      { ">", BytebeatProgram::GT, 6 },
+      { "+", BytebeatProgram::ADD, 8 },
+      { "-", BytebeatProgram::SUB, 8 },
+      { "*", BytebeatProgram::MUL, 9 },
+      { "/", BytebeatProgram::DIV, 9 },
+      { "%", BytebeatProgram::MOD, 9 }
+    };
+    *count = sizeof(operators) / sizeof(operators[0]);
+    return(operators);
+  }
+
+  static const unsigned int HIGHEST_BINARY_LEVEL = 9;
+
+  // Find the operator at the current position without consuming it
+  const BinaryOperator *peekOperator()
+  {
+    skipSpace();
+
+    unsigned int count = 0;
+    const BinaryOperator *operators = binaryOperators(&count);
+
+    for (unsigned int i = 0; i < count; i++)
+    {
+      size_t length = std::strlen(operators[i].token);
+      if (text.compare(position, length, operators[i].token) != 0) continue;
+
+      // Don't mistake the first half of "||" or "&&" for "|" or "&"
+      if (length == 1 && position + 1 < text.size() && text[position + 1] == operators[i].token[0] && (operators[i].token[0] == '|' || operators[i].token[0] == '&')) continue;
+
+      return(&operators[i]);
+    }
+
+    return(nullptr);
+  }
+
+  int parseBinary(unsigned int level)
+  {
+    if (level > HIGHEST_BINARY_LEVEL) return(parseUnary());
+
+    int left = parseBinary(level + 1);
+
+    while (left >= 0)
+    {
+      const BinaryOperator *op = peekOperator();
+      if (op == nullptr || op->level != level) break;
+
+      position += std::strlen(op->token);
+
+      int right = parseBinary(level + 1);
+      left = makeOperator(op->opcode, left, right);
+    }
+
+    return(left);
+  }
+
+  int parseUnary()
+  {
+    if (! enter()) return(-1);
+
+    int result;
+    if (match("-")) result = makeOperator(BytebeatProgram::NEG, parseUnary());
+    else if (match("~")) result = makeOperator(BytebeatProgram::NOT, parseUnary());
+    else if (match("!")) result = makeOperator(BytebeatProgram::LOGICAL_NOT, parseUnary());
+    else if (match("+")) result = parseUnary();
+    else result = parsePrimary();
+
+    nesting--;
+    return(result);
+  }
+
+  int parsePrimary()
+  {
+    skipSpace();
+
+    if (position >= text.size())
+    {
+      fail("unexpected end of expression");
+      return(-1);
+    }
+
+    if (match("("))
+    {
+      int inner = parseExpression();
+      if (! match(")")) { fail("expected ')'"); return(-1); }
+      return(inner);
+    }
+
+    char character = text[position];
+
+    if (std::isdigit((unsigned char) character))
+    {
+      const char *start = text.c_str() + position;
+      char *end = nullptr;
+      uint32_t value = (uint32_t) std::strtoull(start, &end, 0);
+      position += (end - start);
+      return(makeConstant(value));
+    }
+
+    if (std::isalpha((unsigned char) character))
+    {
+      size_t start = position;
+      while (position < text.size() && std::isalnum((unsigned char) text[position])) position++;
+      std::string name = text.substr(start, position - start);
+
+      Node node;
+      if (name == "t") node.input = BytebeatProgram::REGISTER_T;
+      else if (name == "p1") node.input = BytebeatProgram::REGISTER_P1;
+      else if (name == "p2") node.input = BytebeatProgram::REGISTER_P2;
+      else if (name == "p3") node.input = BytebeatProgram::REGISTER_P3;
+      else
+      {
+        position = start;
+        fail("unknown variable '" + name + "'");
+        return(-1);
+      }
+
+      return(addNode(node));
+    }
+
+    fail("unexpected '" + text.substr(position, 1) + "'");
+    return(-1);
+  }
+
+  //
+  // Code generation
+  //
+  // Each operator's result goes in a free register.  An operand's register
+  // is released as soon as it has been used, so registers are reused and
+  // even long expressions need only a few of them.
+  //
+
+  int allocateRegister()
+  {
+    for (unsigned int i = BytebeatProgram::FIRST_FREE_REGISTER; i < BytebeatProgram::MAX_REGISTERS; i++)
+    {
+      if (! register_in_use[i])
+      {
+        register_in_use[i] = true;
+        if (i + 1 > program->register_count) program->register_count = i + 1;
+        return(i);
+      }
+    }
+
+    error = "expression is too complex";
+    return(-1);
+  }
+
+  bool allocateConstants(int index)
+  {
+    if (index < 0) return(true);
+    const Node node = nodes[index];
+
+    if (node.constant)
+    {
+      if (constant_registers.count(node.value)) return(true);
+
+      int reg = allocateRegister();
+      if (reg < 0) return(false);
+
+      constant_registers[node.value] = reg;
+
+      BytebeatProgram::Constant constant;
+      constant.destination = reg;
+      constant.value = node.value;
+      program->constants.push_back(constant);
+
+      return(true);
+    }
+
+    return(allocateConstants(node.a) && allocateConstants(node.b) && allocateConstants(node.c));
+  }
+
+  bool isTemporary(int reg)
+  {
+    if (reg < (int) BytebeatProgram::FIRST_FREE_REGISTER) return(false);
+    for (auto &constant : constant_registers) if ((int) constant.second == reg) return(false);
+    return(true);
+  }
+
+  void release(int reg)
+  {
+    if (reg >= 0 && isTemporary(reg)) register_in_use[reg] = false;
+  }
+
+  int generate(int index)
+  {
+    if (index < 0) return(-1);
+    const Node node = nodes[index];
+
+    if (node.input >= 0) return(node.input);
+
+    if (node.constant) return(constant_registers[node.value]);
+
+    int a = generate(node.a);
+    int b = (node.b >= 0) ? generate(node.b) : 0;
+    int c = (node.c >= 0) ? generate(node.c) : 0;
+    if (a < 0 || b < 0 || c < 0) return(-1);
+
+    release(a);
+    if (node.b >= 0) release(b);
+    if (node.c >= 0) release(c);
+
+    int destination = allocateRegister();
+    if (destination < 0) return(-1);
+
+    BytebeatProgram::Instruction instruction;
+    instruction.opcode = node.opcode;
+    instruction.destination = destination;
+    instruction.a = a;
+    instruction.b = b;
+    instruction.c = c;
+    program->code.push_back(instruction);
+
+    return(destination);
+  }
+};
+
+//
+// BytebeatInterpreter
+//
+// Runs a BytebeatProgram over a block of consecutive t values.  The
+// interpreter holds the registers, so each thread that runs programs needs
+// its own.  It doesn't allocate, and is safe to use on the audio thread.
+//
+
+struct BytebeatInterpreter
+{
+  static const unsigned int BLOCK_SIZE = 64;
+
+  uint32_t registers[BytebeatProgram::MAX_REGISTERS][BLOCK_SIZE];
+
+  //
+  // run
+  //
+  // Evaluate _program_ for t, t + 1, ... t + count - 1 and write the results
+  // to _output_.  Any count is fine; longer runs are split into blocks.
+  //
+  void run(const BytebeatProgram &program, uint32_t t, uint32_t p1, uint32_t p2, uint32_t p3, uint32_t *output, unsigned int count)
+  {
+    while (count > 0)
+    {
+      unsigned int block = (count < BLOCK_SIZE) ? count : BLOCK_SIZE;
+      runBlock(program, t, p1, p2, p3, output, block);
+
+      t += block;
+      output += block;
+      count -= block;
+    }
+  }
+
+  uint32_t run(const BytebeatProgram &program, uint32_t t, uint32_t p1, uint32_t p2, uint32_t p3)
+  {
+    uint32_t output = 0;
+    runBlock(program, t, p1, p2, p3, &output, 1);
+    return(output);
+  }
+
+  void fill(uint32_t *reg, uint32_t value, unsigned int count)
+  {
+    for (unsigned int i = 0; i < count; i++) reg[i] = value;
+  }
+
+  void runBlock(const BytebeatProgram &program, uint32_t t, uint32_t p1, uint32_t p2, uint32_t p3, uint32_t *output, unsigned int count)
+  {
+    uint32_t *time = registers[BytebeatProgram::REGISTER_T];
+    for (unsigned int i = 0; i < count; i++) time[i] = t + i;
+
+    fill(registers[BytebeatProgram::REGISTER_P1], p1, count);
+    fill(registers[BytebeatProgram::REGISTER_P2], p2, count);
+    fill(registers[BytebeatProgram::REGISTER_P3], p3, count);
+
+    for (const BytebeatProgram::Constant &constant : program.constants)
+    {
+      fill(registers[constant.destination], constant.value, count);
+    }
+
+    for (const BytebeatProgram::Instruction &instruction : program.code)
+    {
+      uint32_t *d = registers[instruction.destination];
+      const uint32_t *a = registers[instruction.a];
+      const uint32_t *b = registers[instruction.b];
+      const uint32_t *c = registers[instruction.c];
+
+      // One loop per opcode, so that the opcode isn't checked per value
+      switch (instruction.opcode)
+      {
+        case BytebeatProgram::ADD: for (unsigned int i = 0; i < count; i++) d[i] = a[i] + b[i]; break;
+        case BytebeatProgram::SUB: for (unsigned int i = 0; i < count; i++) d[i] = a[i] - b[i]; break;
+        case BytebeatProgram::MUL: for (unsigned int i = 0; i < count; i++) d[i] = a[i] * b[i]; break;
+        case BytebeatProgram::DIV: for (unsigned int i = 0; i < count; i++) d[i] = (b[i] == 0) ? 0 : (a[i] / b[i]); break;
+        case BytebeatProgram::MOD: for (unsigned int i = 0; i < count; i++) d[i] = (b[i] == 0) ? 0 : (a[i] % b[i]); break;
+        case BytebeatProgram::AND: for (unsigned int i = 0; i < count; i++) d[i] = a[i] & b[i]; break;
+        case BytebeatProgram::OR: for (unsigned int i = 0; i < count; i++) d[i] = a[i] | b[i]; break;
+        case BytebeatProgram::XOR: for (unsigned int i = 0; i < count; i++) d[i] = a[i] ^ b[i]; break;
+        case BytebeatProgram::SHL: for (unsigned int i = 0; i < count; i++) d[i] = a[i] << (b[i] & 31); break;
+        case BytebeatProgram::SHR: for (unsigned int i = 0; i < count; i++) d[i] = a[i] >> (b[i] & 31); break;
+        case BytebeatProgram::LT: for (unsigned int i = 0; i < count; i++) d[i] = a[i] < b[i]; break;
+        case BytebeatProgram::GT: for (unsigned int i = 0; i < count; i++) d[i] = a[i] > b[i]; break;
+        case BytebeatProgram::LE: for (unsigned int i = 0; i < count; i++) d[i] = a[i] <= b[i]; break;
+        case BytebeatProgram::GE: for (unsigned int i = 0; i < count; i++) d[i] = a[i] >= b[i]; break;
+        case BytebeatProgram::EQ: for (unsigned int i = 0; i < count; i++) d[i] = a[i] == b[i]; break;
+        case BytebeatProgram::NE: for (unsigned int i = 0; i < count; i++) d[i] = a[i] != b[i]; break;
+        case BytebeatProgram::LOGICAL_AND: for (unsigned int i = 0; i < count; i++) d[i] = (a[i] != 0) & (b[i] != 0); break;
+        case BytebeatProgram::LOGICAL_OR: for (unsigned int i = 0; i < count; i++) d[i] = (a[i] != 0) | (b[i] != 0); break;
+        case BytebeatProgram::NEG: for (unsigned int i = 0; i < count; i++) d[i] = 0u - a[i]; break;
+        case BytebeatProgram::NOT: for (unsigned int i = 0; i < count; i++) d[i] = ~a[i]; break;
+        case BytebeatProgram::LOGICAL_NOT: for (unsigned int i = 0; i < count; i++) d[i] = a[i] == 0; break;
+        case BytebeatProgram::SELECT: for (unsigned int i = 0; i < count; i++) d[i] = (a[i] != 0) ? b[i] : c[i]; break;
+      }
+    }
+
+    const uint32_t *result = registers[program.result];
+    for (unsigned int i = 0; i < count; i++) output[i] = result[i];
+  }
+};
+
+//
+// BytebeatExpressionSlot
+//
+// Holds a module's user-written expression and hands its compiled program to
+// the audio thread.
+//
+// setExpression() is called from the UI thread.  It only replaces the
+// program if the new text compiles, so a half-typed expression never
+// silences the module.  The audio thread calls update() once per block, which
+// is cheap unless the program has actually changed.
+//
+// Programs are handed over through a PublishedValue, so the audio thread is
+// never the one to free a program, however quickly the expression changes.
+//
+
+struct BytebeatExpressionSlot
+{
+  std::string expression;
+  std::string error;
+
+  PublishedValue<const BytebeatProgram> program;
+
+  bool setExpression(const std::string &text)
+  {
+    std::shared_ptr<BytebeatProgram> compiled = std::make_shared<BytebeatProgram>();
+    if (! BytebeatCompiler::compile(text, *compiled, &error)) return(false);
+
+    expression = text;
+    program.publish(compiled);
+
+    return(true);
+  }
+
+  // Returns the current program, or nullptr if there isn't one
+  const BytebeatProgram *update()
+  {
+    program.update();
+    return(program.get());
+  }
+
+  // Audio thread.  Changes whenever update() picks up a new program.
+  uint32_t getActiveGeneration()
+  {
+    return(program.active_generation);
+  }
+};
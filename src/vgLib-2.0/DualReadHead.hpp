@@ -0,0 +1,147 @@
+/*
+  DualReadHead.hpp
+
+  Reads a sample at a position that's allowed to jump, without clicking.
+  Breakbeat modules move their read position along steadily, then jump to a
+  new slice whenever their sequencer says so.  Reading straight from the new
+  position cuts the waveform off wherever it happened to be.
+
+  There are two read heads.  The incoming head always reads at the position
+  passed to process().  When that position jumps, the old head carries on
+  from where it was, at the speed it was going, and fades out over the
+  crossfade window while the incoming head fades in.  A jump is any change
+  in position that's more than JUMP_TOLERANCE away from the previous step,
+  so loop wraps, slice jumps, resets and switching samples are all caught
+  without the caller having to say so.
+
+  The old head wraps around the ends of its sample, so a loop wrap fades
+  into the start of the sample instead of into silence.  If the position
+  jumps again before a crossfade has finished, the old head is dropped and
+  the incoming one becomes the old head.  That way it never does more than
+  two reads per sample.
+
+  Both heads read with the module's interpolation setting (see
+  VoxglitchSamplerModule::interpolation): 0 for none, otherwise linear.
+*/
+
+#pragma once
+
+#include <cmath>
+
+struct DualReadHead
+{
+  static constexpr double JUMP_TOLERANCE = 1.0;   // frames
+
+  unsigned int crossfade_frames = 0;
+
+  // The incoming head
+  Sample *sample = nullptr;
+  double position = 0.0;
+  double speed = 0.0;
+  bool speed_known = false;
+
+  // The head being faded out
+  Sample *outgoing_sample = nullptr;
+  double outgoing_position = 0.0;
+  double outgoing_speed = 0.0;
+  unsigned int fade_remaining = 0;
+
+  void setCrossfadeFrames(unsigned int frames)
+  {
+    crossfade_frames = frames;
+  }
+
+  void reset()
+  {
+    sample = nullptr;
+    speed_known = false;
+    outgoing_sample = nullptr;
+    fade_remaining = 0;
+  }
+
+  //
+  // process(new_sample, new_position, interpolation, left, right)
+  //
+  // Call once per sample with the sample and position to read.  Writes the
+  // audio to _left_ and _right_.
+  //
+  void process(Sample *new_sample, double new_position, unsigned int interpolation, float *left, float *right)
+  {
+    if(sample != nullptr)
+    {
+      double movement = new_position - position;
+
+      if(new_sample != sample || (speed_known && std::fabs(movement - speed) > JUMP_TOLERANCE))
+      {
+        startCrossfade();
+      }
+      else
+      {
+        speed = movement;
+        speed_known = true;
+      }
+    }
+
+    sample = new_sample;
+    position = new_position;
+
+    read(sample, position, interpolation, left, right);
+
+    if(fade_remaining == 0) return;
+
+    float outgoing_left = 0.0f;
+    float outgoing_right = 0.0f;
+    read(outgoing_sample, outgoing_position, interpolation, &outgoing_left, &outgoing_right);
+
+    // Smoothstep crossfade.  The two gains always add up to 1.
+    float x = (float) fade_remaining / (float) (crossfade_frames + 1);
+    float outgoing_gain = x * x * (3.0f - (2.0f * x));
+
+    *left += (outgoing_left - *left) * outgoing_gain;
+    *right += (outgoing_right - *right) * outgoing_gain;
+
+    fade_remaining--;
+    outgoing_position = wrap(outgoing_sample, outgoing_position + outgoing_speed);
+  }
+
+  private:
+
+  void startCrossfade()
+  {
+    if(crossfade_frames == 0) return;
+
+    outgoing_sample = sample;
+    outgoing_speed = speed;
+    outgoing_position = wrap(sample, position + speed);
+    fade_remaining = crossfade_frames;
+  }
+
+  double wrap(Sample *from, double frame)
+  {
+    double length = from->size();
+    if(length <= 0.0) return(0.0);
+
+    if(frame >= length) frame -= length;
+    if(frame < 0.0) frame += length;
+    return(frame);
+  }
+
+  void read(Sample *from, double frame, unsigned int interpolation, float *left, float *right)
+  {
+    if(frame < 0.0)
+    {
+      *left = 0.0f;
+      *right = 0.0f;
+      return;
+    }
+
+    if(interpolation == 0)
+    {
+      from->read((unsigned int) frame, left, right);
+    }
+    else
+    {
+      from->readLI(frame, left, right);
+    }
+  }
+};
@@ -1,60 +1,290 @@
+#pragma once
+
 #include <vector>
-#include <unordered_map>
 #include <string>
+#include <cstdint>
+#include <algorithm>
 
-// Define a simple 5x7 monospace font
-const int FONT_WIDTH = 5;
-const int FONT_HEIGHT = 7;
-
-std::unordered_map<char, std::vector<std::vector<bool>>> font = {
-    // Each character is a 5x7 grid (width x height) of on/off pixels
-    // Here's an example for a few characters:
-    {'A', {
-        {0, 1, 1, 1, 0},
-        {1, 0, 0, 0, 1},
-        {1, 0, 0, 0, 1},
-        {1, 1, 1, 1, 1},
-        {1, 0, 0, 0, 1},
-        {1, 0, 0, 0, 1},
-        {1, 0, 0, 0, 1}
-    }},
-    // ... Add other characters ...
-};
+//
+// LCDMatrix
+//
+// A monochrome pixel matrix for dot-matrix style LCD readouts.
+//
+// Pixels are packed one bit each into 32 bit words, one run of words per row,
+// so a glyph row is written with a shift and a couple of word operations
+// rather than pixel by pixel.  The font is a flat atlas of 5x7 glyphs indexed
+// directly by character code (taken from font.h).
+//
+// The matrix remembers which area has changed since the last call to
+// clearDirty().  Writes that don't actually change any pixels leave it
+// untouched, so a widget can redraw every frame with the same text and only
+// repaint when isDirty() says something is different.
+//
 
 class LCDMatrix {
+public:
+    static const int FONT_WIDTH = 5;
+    static const int FONT_HEIGHT = 7;
+
+    struct Rect {
+        int x0 = 0;
+        int y0 = 0;
+        int x1 = 0;   // Exclusive
+        int y1 = 0;   // Exclusive
+
+        bool empty() const { return (x1 <= x0) || (y1 <= y0); }
+    };
+
 private:
     int width, height;
-    std::vector<std::vector<bool>> pixels;
+    int words_per_row;
+    std::vector<uint32_t> pixels;
+    Rect dirty;
+
+    // Glyphs for ' ' to '~'.  Each row's five pixels are in the low five bits,
+    // with the leftmost pixel in bit 4.  Other characters draw as blanks.
+    static const uint8_t *glyph(char c) {
+        static const uint8_t atlas[95][FONT_HEIGHT] = {
+      { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // ' '
+      { 0x10, 0x10, 0x10, 0x10, 0x10, 0x00, 0x10 }, // '!'
+      { 0x14, 0x14, 0x14, 0x00, 0x00, 0x00, 0x00 }, // '"'
+      { 0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A }, // '#'
+      { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '$'
+      { 0x01, 0x09, 0x02, 0x04, 0x08, 0x12, 0x10 }, // '%'
+      { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '&'
+      { 0x10, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00 }, // '\''
+      { 0x04, 0x08, 0x10, 0x10, 0x10, 0x08, 0x04 }, // '('
+      { 0x10, 0x08, 0x04, 0x04, 0x04, 0x08, 0x10 }, // ')'
+      { 0x04, 0x0E, 0x04, 0x0A, 0x00, 0x00, 0x00 }, // '*'
+      { 0x00, 0x00, 0x04, 0x04, 0x1F, 0x04, 0x04 }, // '+'
+      { 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x08 }, // ','
+      { 0x00, 0x00, 0x00, 0x0E, 0x00, 0x00, 0x00 }, // '-'
+      { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10 }, // '.'
+      { 0x01, 0x01, 0x02, 0x04, 0x08, 0x08, 0x10 }, // '/'
+      { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E }, // '0'
+      { 0x18, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08 }, // '1'
+      { 0x0E, 0x11, 0x01, 0x06, 0x08, 0x10, 0x1F }, // '2'
+      { 0x1E, 0x01, 0x01, 0x0E, 0x01, 0x01, 0x1E }, // '3'
+      { 0x11, 0x11, 0x11, 0x1F, 0x01, 0x01, 0x01 }, // '4'
+      { 0x1F, 0x10, 0x10, 0x1E, 0x01, 0x01, 0x1E }, // '5'
+      { 0x0F, 0x10, 0x10, 0x0E, 0x11, 0x11, 0x0E }, // '6'
+      { 0x1F, 0x01, 0x01, 0x06, 0x08, 0x08, 0x08 }, // '7'
+      { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E }, // '8'
+      { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x01, 0x0E }, // '9'
+      { 0x00, 0x08, 0x00, 0x00, 0x08, 0x00, 0x00 }, // ':'
+      { 0x00, 0x08, 0x00, 0x08, 0x08, 0x10, 0x00 }, // ';'
+      { 0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02 }, // '<'
+      { 0x00, 0x1F, 0x00, 0x00, 0x1F, 0x00, 0x00 }, // '='
+      { 0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08 }, // '>'
+      { 0x0C, 0x12, 0x02, 0x04, 0x08, 0x00, 0x08 }, // '?'
+      { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '@'
+      { 0x0E, 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11 }, // 'A'
+      { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E }, // 'B'
+      { 0x0F, 0x10, 0x10, 0x10, 0x10, 0x10, 0x0F }, // 'C'
+      { 0x1E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x1E }, // 'D'
+      { 0x1F, 0x10, 0x10, 0x1F, 0x10, 0x10, 0x1F }, // 'E'
+      { 0x1F, 0x10, 0x10, 0x1F, 0x10, 0x10, 0x10 }, // 'F'
+      { 0x0F, 0x10, 0x10, 0x13, 0x11, 0x11, 0x0F }, // 'G'
+      { 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 }, // 'H'
+      { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10 }, // 'I'
+      { 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x1E }, // 'J'
+      { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 }, // 'K'
+      { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F }, // 'L'
+      { 0x11, 0x1B, 0x15, 0x11, 0x11, 0x11, 0x11 }, // 'M'
+      { 0x11, 0x19, 0x15, 0x13, 0x11, 0x11, 0x11 }, // 'N'
+      { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E }, // 'O'
+      { 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 }, // 'P'
+      { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x13, 0x0F }, // 'Q'
+      { 0x1E, 0x11, 0x11, 0x11, 0x1E, 0x11, 0x11 }, // 'R'
+      { 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E }, // 'S'
+      { 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 }, // 'T'
+      { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E }, // 'U'
+      { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 }, // 'V'
+      { 0x11, 0x11, 0x11, 0x11, 0x15, 0x1B, 0x11 }, // 'W'
+      { 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 }, // 'X'
+      { 0x11, 0x11, 0x11, 0x0E, 0x04, 0x04, 0x04 }, // 'Y'
+      { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F }, // 'Z'
+      { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '['
+      { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '\\'
+      { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // ']'
+      { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '^'
+      { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F }, // '_'
+      { 0x08, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '`'
+      { 0x00, 0x00, 0x0E, 0x01, 0x0F, 0x11, 0x0F }, // 'a'
+      { 0x10, 0x10, 0x1E, 0x11, 0x11, 0x11, 0x1E }, // 'b'
+      { 0x00, 0x00, 0x0E, 0x11, 0x10, 0x11, 0x0E }, // 'c'
+      { 0x01, 0x01, 0x0F, 0x11, 0x11, 0x11, 0x0F }, // 'd'
+      { 0x00, 0x00, 0x0E, 0x11, 0x1F, 0x10, 0x0F }, // 'e'
+      { 0x06, 0x09, 0x08, 0x1C, 0x08, 0x08, 0x08 }, // 'f'
+      { 0x00, 0x0F, 0x11, 0x11, 0x0F, 0x01, 0x1E }, // 'g'
+      { 0x10, 0x10, 0x1E, 0x11, 0x11, 0x11, 0x11 }, // 'h'
+      { 0x10, 0x00, 0x10, 0x10, 0x10, 0x10, 0x10 }, // 'i'
+      { 0x01, 0x00, 0x03, 0x01, 0x01, 0x11, 0x0E }, // 'j'
+      { 0x10, 0x10, 0x11, 0x12, 0x1C, 0x12, 0x11 }, // 'k'
+      { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x18 }, // 'l'
+      { 0x00, 0x00, 0x1E, 0x15, 0x15, 0x15, 0x15 }, // 'm'
+      { 0x00, 0x00, 0x1E, 0x11, 0x11, 0x11, 0x11 }, // 'n'
+      { 0x00, 0x00, 0x0E, 0x11, 0x11, 0x11, 0x0E }, // 'o'
+      { 0x00, 0x0E, 0x09, 0x09, 0x0E, 0x08, 0x08 }, // 'p'
+      { 0x00, 0x00, 0x07, 0x09, 0x07, 0x01, 0x01 }, // 'q'
+      { 0x00, 0x00, 0x17, 0x18, 0x10, 0x10, 0x10 }, // 'r'
+      { 0x00, 0x00, 0x0F, 0x10, 0x0E, 0x01, 0x1E }, // 's'
+      { 0x08, 0x08, 0x1C, 0x08, 0x08, 0x08, 0x06 }, // 't'
+      { 0x00, 0x00, 0x11, 0x11, 0x11, 0x11, 0x0E }, // 'u'
+      { 0x00, 0x00, 0x11, 0x11, 0x11, 0x0A, 0x04 }, // 'v'
+      { 0x00, 0x00, 0x11, 0x11, 0x15, 0x15, 0x0A }, // 'w'
+      { 0x00, 0x00, 0x11, 0x0A, 0x04, 0x0A, 0x11 }, // 'x'
+      { 0x00, 0x00, 0x11, 0x11, 0x0F, 0x01, 0x1E }, // 'y'
+      { 0x00, 0x00, 0x1F, 0x02, 0x04, 0x08, 0x1F }, // 'z'
+      { 0x04, 0x08, 0x08, 0x10, 0x08, 0x08, 0x04 }, // '{'
+      { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '|'
+      { 0x10, 0x08, 0x08, 0x04, 0x08, 0x08, 0x10 }, // '}'
+      { 0x00, 0x00, 0x15, 0x0A, 0x00, 0x00, 0x00 }, // '~'
+        };
+
+        unsigned char code = (unsigned char) c;
+        if (code < 32 || code > 126) code = ' ';
+        return atlas[code - 32];
+    }
+
+    void markDirty(int x0, int y0, int x1, int y1) {
+        if (dirty.empty()) {
+            dirty.x0 = x0; dirty.y0 = y0; dirty.x1 = x1; dirty.y1 = y1;
+        } else {
+            dirty.x0 = std::min(dirty.x0, x0);
+            dirty.y0 = std::min(dirty.y0, y0);
+            dirty.x1 = std::max(dirty.x1, x1);
+            dirty.y1 = std::max(dirty.y1, y1);
+        }
+    }
+
+    // Replace the pixels selected by _mask_ in row y, starting at column x, with
+    // _bits_.  Bit 0 of mask/bits is column x.  Both fit in 32 bits, so they
+    // straddle at most two words.  Returns true if any pixel changed.
+    bool writeBits(int x, int y, uint32_t mask, uint32_t bits) {
+        // Clip to the matrix
+        if (y < 0 || y >= height || mask == 0) return false;
+        if (x < 0) {
+            if (x <= -32) return false;
+            mask >>= -x;
+            bits >>= -x;
+            x = 0;
+        }
+        if (x >= width) return false;
+        if (width - x < 32) {
+            uint32_t visible = (1u << (width - x)) - 1;
+            mask &= visible;
+            bits &= visible;
+        }
+
+        uint32_t *row = &pixels[y * words_per_row];
+        int word = x >> 5;
+        int shift = x & 31;
+        bool changed = false;
+
+        uint32_t low_mask = mask << shift;
+        uint32_t low_bits = (bits << shift) & low_mask;
+        uint32_t updated = (row[word] & ~low_mask) | low_bits;
+        if (updated != row[word]) {
+            row[word] = updated;
+            changed = true;
+        }
+
+        if (shift != 0 && (mask >> (32 - shift)) != 0) {
+            uint32_t high_mask = mask >> (32 - shift);
+            uint32_t high_bits = (bits >> (32 - shift)) & high_mask;
+            updated = (row[word + 1] & ~high_mask) | high_bits;
+            if (updated != row[word + 1]) {
+                row[word + 1] = updated;
+                changed = true;
+            }
+        }
+
+        return changed;
+    }
+
+    // Glyph rows have the leftmost pixel in the high bit, while the matrix
+    // keeps column x in bit x, so the row is mirrored on the way in.
+    static uint32_t glyphRowBits(uint8_t row) {
+        uint32_t bits = 0;
+        for (int i = 0; i < FONT_WIDTH; ++i) {
+            if (row & (1 << (FONT_WIDTH - 1 - i))) bits |= (1u << i);
+        }
+        return bits;
+    }
+
+    void blitText(int x, int y, const std::string& text, bool opaque) {
+        const uint32_t glyph_mask = (1u << FONT_WIDTH) - 1;
+
+        for (char c : text) {
+            const uint8_t *rows = glyph(c);
+            bool changed = false;
+
+            for (int i = 0; i < FONT_HEIGHT; ++i) {
+                uint32_t bits = glyphRowBits(rows[i]);
+
+                // Transparent text only turns pixels on, like the original
+                // drawText, while opaque text replaces the whole cell.
+                changed |= writeBits(x, y + i, opaque ? glyph_mask : bits, bits);
+            }
+
+            if (changed) markDirty(std::max(x, 0), std::max(y, 0), std::min(x + FONT_WIDTH, width), std::min(y + FONT_HEIGHT, height));
+            x += FONT_WIDTH;
+        }
+    }
 
 public:
-    LCDMatrix(int w, int h) : width(w), height(h), pixels(h, std::vector<bool>(w, false)) {}
+    LCDMatrix(int w, int h) : width(w), height(h), words_per_row((w + 31) / 32), pixels(words_per_row * h, 0) {}
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
 
     void setPixel(int x, int y, bool on) {
         if (x >= 0 && x < width && y >= 0 && y < height) {
-            pixels[y][x] = on;
+            if (writeBits(x, y, 1, on ? 1 : 0)) markDirty(x, y, x + 1, y + 1);
         }
     }
 
     bool getPixel(int x, int y) const {
         if (x >= 0 && x < width && y >= 0 && y < height) {
-            return pixels[y][x];
+            return (pixels[(y * words_per_row) + (x >> 5)] >> (x & 31)) & 1;
         }
         return false;
     }
 
+    // Direct access to a row's packed pixels, for renderers that want to skip
+    // runs of empty words.  Column x is bit (x & 31) of word (x >> 5).
+    const uint32_t *getRow(int y) const {
+        return &pixels[y * words_per_row];
+    }
+
+    int getWordsPerRow() const { return words_per_row; }
+
+    // Turn on the pixels of _text_, leaving the pixels around them alone
     void drawText(int x, int y, const std::string& text) {
-        for (char c : text) {
-            if (font.find(c) != font.end()) {
-                const auto& charMap = font[c];
-                for (int i = 0; i < FONT_HEIGHT; ++i) {
-                    for (int j = 0; j < FONT_WIDTH; ++j) {
-                        if (charMap[i][j]) {
-                            setPixel(x + j, y + i, true);
-                        }
-                    }
+        blitText(x, y, text, false);
+    }
+
+    // Write _text_ into its character cells, turning off any pixels in those
+    // cells that aren't part of the glyphs.  Use this for readouts whose text
+    // changes, so that the previous text doesn't need to be cleared first.
+    void setText(int x, int y, const std::string& text) {
+        blitText(x, y, text, true);
+    }
+
+    void clear() {
+        for (int y = 0; y < height; ++y) {
+            uint32_t *row = &pixels[y * words_per_row];
+            for (int word = 0; word < words_per_row; ++word) {
+                if (row[word] != 0) {
+                    row[word] = 0;
+                    markDirty(0, y, width, y + 1);
                 }
             }
-            x += FONT_WIDTH;
         }
     }
+
+    bool isDirty() const { return !dirty.empty(); }
+    Rect getDirtyRect() const { return dirty; }
+    void clearDirty() { dirty = Rect(); }
 };
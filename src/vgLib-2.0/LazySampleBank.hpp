@@ -0,0 +1,441 @@
+/*
+  LazySampleBank.hpp
+
+  A LazySampleBank represents a folder of .wav files without holding all of
+  them in memory.  Scanning a folder only reads the directory listing and the
+  first few bytes of each file, so it's fast even for folders with hundreds of
+  samples.  The audio itself is decoded on a background thread, starting with
+  whichever sample the module asks for and then its neighbours, so that
+  stepping through the bank rarely has to wait.
+
+  Loaded samples are evicted, least recently used first, once the bank goes
+  over its memory budget.  The selected sample and its neighbours are never
+  evicted.
+
+  The bank is a template so that it can hold whatever type a module plays
+  back.  WavBank stores SamplePlayers and WavBankMC stores SampleMCs.  The
+  module sets _loader_, which loads an item from a path, and _measure_, which
+  reports how many bytes a loaded item occupies, before scanning a folder.
+  The loader runs on the worker thread, so it mustn't use APP.
+
+  Threading:
+
+  - scan() is called from the UI thread (or from dataFromJson).  It builds a
+    new Folder and publishes it.  The UI reads the published folder with
+    getFolder().
+  - update(), size(), select() and get() are called from the audio thread
+    and never block.  update() picks up the latest folder, and the others
+    work on that one until the next update().
+  - All loading and freeing of audio happens on the bank's worker thread, or
+    on the UI thread in scan().
+
+  Items are handed to the audio thread as shared_ptrs, so the audio thread
+  could end up holding the last reference to one.  To stop that from freeing
+  audio on the audio thread, nothing is dropped directly.  A replaced folder
+  or an evicted item goes on a retired list, which is only released once
+  nothing else refers to it.  Once a folder has been replaced or an item
+  evicted, nothing can take a new reference to it, so that check is safe.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#ifndef METAMODULE
+#include <thread>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#endif
+
+template <typename T>
+struct LazySampleBank
+{
+  struct Entry
+  {
+    std::string path;
+    std::string filename;
+    std::string display_name;
+    std::shared_ptr<T> item;      // Only written by the worker
+    size_t bytes = 0;             // Only used by the worker
+    uint64_t last_used = 0;       // Only used by the worker
+    bool failed = false;          // Set if the file couldn't be loaded
+  };
+
+  // The contents of one scan.  Once published, the list of entries never
+  // changes.  Only the items in it are loaded and evicted.
+  struct Folder
+  {
+    std::vector<Entry> entries;
+
+    unsigned int size()
+    {
+      return(entries.size());
+    }
+
+    std::string getDisplayName(unsigned int index)
+    {
+      if (index >= entries.size()) return("");
+      return(entries[index].display_name);
+    }
+  };
+
+  std::function<bool(T &, const std::string &)> loader;
+  std::function<size_t(T &)> measure;
+
+  size_t memory_budget = 256 * 1024 * 1024;   // Bytes of audio to keep in memory
+  unsigned int prefetch_radius = 2;           // Neighbours on either side to preload
+  size_t resident_bytes = 0;                  // Only used by the worker
+  uint64_t clock = 0;                         // Only used by the worker
+
+  std::shared_ptr<Folder> folder = std::make_shared<Folder>();   // Published with atomic_store
+  std::atomic<unsigned int> generation {0};
+
+  // The audio thread's copy of the folder, and which one it is
+  std::shared_ptr<Folder> active = folder;
+  unsigned int active_generation = 0;
+
+  std::atomic<int> requested_index {-1};
+
+  // Folders and items that have been replaced, waiting to be freed
+  std::vector<std::shared_ptr<Folder>> retired_folders;
+  std::vector<std::shared_ptr<T>> retired_items;
+
+#ifndef METAMODULE
+  std::mutex retired_mutex;
+  std::thread worker;
+  std::mutex worker_mutex;
+  std::condition_variable worker_condition;
+  std::atomic<bool> running {false};
+#endif
+
+  ~LazySampleBank()
+  {
+    stopWorker();
+  }
+
+  //
+  // scan
+  //
+  // Replace the contents of the bank with the .wav files found in _path_.
+  // Only the file names and RIFF headers are read here.
+  //
+  void scan(std::string path)
+  {
+    stopWorker();
+    resident_bytes = 0;
+
+    std::shared_ptr<Folder> scanned = std::make_shared<Folder>();
+
+    std::vector<std::string> dir_list = system::getEntries(path.c_str());
+
+    // Sort the vector.  This is in response to a user who's samples were being
+    // loaded out of order.  I think it's a mac thing.
+    std::sort(dir_list.begin(), dir_list.end());
+
+    for (auto entry_path : dir_list)
+    {
+      // Something happened in Rack 2 where the extension started to include
+      // the ".", so check for both versions, just in case.
+      std::string extension = rack::string::lowercase(system::getExtension(entry_path));
+
+      if ((extension == "wav" || extension == ".wav") && isWaveFile(entry_path))
+      {
+        Entry entry;
+        entry.path = entry_path;
+        entry.filename = system::getFilename(entry_path);
+        entry.display_name = entry.filename;
+        entry.display_name.erase(entry.display_name.length() - 4); // remove the .wav extension
+        scanned->entries.push_back(entry);
+      }
+    }
+
+#ifdef METAMODULE
+    // There's no worker thread on the MetaModule, so load everything up front
+    for (Entry &entry : scanned->entries) load(entry);
+#endif
+
+    // The audio thread may still be playing from the old folder
+    retireFolder(std::atomic_load(&folder));
+
+    requested_index = -1;
+    std::atomic_store(&folder, scanned);
+    generation++;
+
+    releaseRetired();
+    startWorker();
+  }
+
+  // The latest folder, for the UI thread
+  std::shared_ptr<Folder> getFolder()
+  {
+    return(std::atomic_load(&folder));
+  }
+
+  //
+  // Audio thread side
+  //
+
+  // Switches to the latest folder.  Returns true if there's a new one, in
+  // which case any items from the old one should be let go of.
+  bool update()
+  {
+    unsigned int latest = generation;
+    if (latest == active_generation) return(false);
+
+    // The old folder is on the retired list, so this doesn't free it
+    active = std::atomic_load(&folder);
+    active_generation = latest;
+    return(true);
+  }
+
+  unsigned int size()
+  {
+    return(active->size());
+  }
+
+  // Tell the worker which sample the module wants.  Safe to call from the
+  // audio thread every sample; it's a single atomic store.
+  void select(unsigned int index)
+  {
+    if ((int) index != requested_index.load(std::memory_order_relaxed))
+    {
+      requested_index = index;
+#ifndef METAMODULE
+      worker_condition.notify_one();
+#endif
+    }
+  }
+
+  // Fetch the item at _index_, or nullptr if it hasn't been loaded yet.
+  std::shared_ptr<T> get(unsigned int index)
+  {
+    if (index >= active->entries.size()) return(nullptr);
+    return(std::atomic_load(&active->entries[index].item));
+  }
+
+  bool isLoaded(unsigned int index)
+  {
+    return(get(index) != nullptr);
+  }
+
+  void setMemoryBudget(size_t bytes)
+  {
+    memory_budget = bytes;
+  }
+
+  //
+  // Worker side
+  //
+
+  void startWorker()
+  {
+#ifndef METAMODULE
+    if (running) return;
+    running = true;
+    worker = std::thread(&LazySampleBank::run, this, std::atomic_load(&folder));
+#endif
+  }
+
+  void stopWorker()
+  {
+#ifndef METAMODULE
+    if (! running) return;
+
+    {
+      std::lock_guard<std::mutex> lock(worker_mutex);
+      running = false;
+    }
+    worker_condition.notify_one();
+    if (worker.joinable()) worker.join();
+#endif
+  }
+
+#ifndef METAMODULE
+  // The worker keeps running while the folder is empty so that it can
+  // release whatever the last scan retired.
+  void run(std::shared_ptr<Folder> current)
+  {
+    std::vector<Entry> &entries = current->entries;
+
+    while (running)
+    {
+      int center = requested_index;
+
+      if (center >= 0 && center < (int) entries.size())
+      {
+        clock++;
+
+        // Visit the requested sample first, then fan outward.  If the
+        // request changes part way through, start over at the new sample.
+        for (int offset : prefetchOrder())
+        {
+          if (! running || requested_index != center) break;
+
+          Entry &entry = entries[wrap(center + offset, entries.size())];
+          entry.last_used = clock;
+
+          if (! entry.item && ! entry.failed) load(entry);
+        }
+
+        evict(entries, center);
+      }
+
+      releaseRetired();
+
+      std::unique_lock<std::mutex> lock(worker_mutex);
+      worker_condition.wait_for(lock, std::chrono::milliseconds(20), [this, center]() {
+        return(! running || requested_index != center);
+      });
+    }
+  }
+#endif
+
+  std::vector<int> prefetchOrder()
+  {
+    std::vector<int> order = {0};
+
+    for (int distance = 1; distance <= (int) prefetch_radius; distance++)
+    {
+      order.push_back(distance);
+      order.push_back(-distance);
+    }
+
+    return(order);
+  }
+
+  static unsigned int wrap(int index, int count)
+  {
+    return(((index % count) + count) % count);
+  }
+
+  bool isProtected(unsigned int index, int center, int count)
+  {
+    for (int offset : prefetchOrder())
+    {
+      if (wrap(center + offset, count) == index) return(true);
+    }
+    return(false);
+  }
+
+  void load(Entry &entry)
+  {
+    std::shared_ptr<T> item = std::make_shared<T>();
+
+    if (! loader(*item, entry.path))
+    {
+      entry.failed = true;
+      return;
+    }
+
+    entry.bytes = measure(*item);
+    resident_bytes += entry.bytes;
+    std::atomic_store(&entry.item, item);
+  }
+
+  // Free least recently used samples until the bank is back under budget
+  void evict(std::vector<Entry> &entries, int center)
+  {
+    while (resident_bytes > memory_budget)
+    {
+      Entry *oldest = nullptr;
+
+      for (unsigned int i = 0; i < entries.size(); i++)
+      {
+        Entry &entry = entries[i];
+
+        // Prefer items that only the bank holds.  An item that's playing
+        // would only have to be loaded again.
+        if (! entry.item || entry.item.use_count() > 1 || isProtected(i, center, entries.size())) continue;
+        if (oldest == nullptr || entry.last_used < oldest->last_used) oldest = &entry;
+      }
+
+      if (oldest == nullptr) return;
+
+      // The audio thread may have fetched the item since it was checked, so
+      // it's retired rather than freed here
+      retireItem(oldest->item);
+      std::atomic_store(&oldest->item, std::shared_ptr<T>());
+      resident_bytes -= oldest->bytes;
+      oldest->bytes = 0;
+    }
+  }
+
+  void retireFolder(std::shared_ptr<Folder> old_folder)
+  {
+#ifndef METAMODULE
+    std::lock_guard<std::mutex> lock(retired_mutex);
+#endif
+    retired_folders.push_back(old_folder);
+  }
+
+  void retireItem(std::shared_ptr<T> item)
+  {
+#ifndef METAMODULE
+    std::lock_guard<std::mutex> lock(retired_mutex);
+#endif
+    retired_items.push_back(item);
+  }
+
+  //
+  // releaseRetired
+  //
+  // Frees whatever on the retired lists nothing else refers to.  A retired
+  // folder that only this list refers to can't hand out its items any more,
+  // so its items are moved to the retired items to wait for the audio thread
+  // to let go of them.
+  //
+  void releaseRetired()
+  {
+#ifndef METAMODULE
+    std::lock_guard<std::mutex> lock(retired_mutex);
+#endif
+
+    for (size_t i = 0; i < retired_folders.size(); )
+    {
+      if (retired_folders[i].use_count() > 1)
+      {
+        i++;
+        continue;
+      }
+
+      for (Entry &entry : retired_folders[i]->entries)
+      {
+        if (entry.item) retired_items.push_back(entry.item);
+      }
+
+      retired_folders.erase(retired_folders.begin() + i);
+    }
+
+    for (size_t i = 0; i < retired_items.size(); )
+    {
+      if (retired_items[i].use_count() > 1)
+      {
+        i++;
+        continue;
+      }
+
+      retired_items.erase(retired_items.begin() + i);
+    }
+  }
+
+  // Check for the "RIFF....WAVE" signature without reading the rest of the file
+  static bool isWaveFile(const std::string &path)
+  {
+    char header[12];
+    FILE *file = fopen(path.c_str(), "rb");
+    if (! file) return(false);
+
+    bool valid = (fread(header, 1, 12, file) == 12) && (memcmp(header, "RIFF", 4) == 0) && (memcmp(header + 8, "WAVE", 4) == 0);
+    fclose(file);
+
+    return(valid);
+  }
+};
@@ -0,0 +1,220 @@
+/*
+  OnsetDetector.hpp
+
+  Finds the transients in a sample, such as the hits in a drum loop, so that
+  modules can place markers or jump to them instead of dividing the sample
+  into equal parts.
+
+  This runs once, when the sample is loaded, on whichever thread is loading
+  it.  The result is stored in the sample's SliceTable and cached on disk by
+  the PeakCache, so the audio thread never pays for any of it.
+
+  The method is spectral flux:
+
+  1. The sample is mixed to mono and cut into overlapping, Hann windowed
+     frames of FRAME_SIZE, every HOP_SIZE frames.
+  2. Each frame's magnitude spectrum is log-compressed, so quiet hits count
+     as well as loud ones.
+  3. The onset envelope is the sum of the increases in each frequency bin
+     since the previous frame.  Decreases are ignored, so decays and note
+     releases don't look like onsets.
+  4. Peaks are picked from the envelope.  A frame is an onset if it's the
+     largest in its neighbourhood, stands above the local average by at
+     least _threshold_, and is at least MINIMUM_GAP seconds after the
+     previous onset.
+  5. Each onset is moved to the start of the sharpest rise in energy near
+     it, which is much finer than a hop.
+
+  The FFT is Rack's dsp::RealFFT (pffft).
+*/
+
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+#include "SampleAnalysis.hpp"
+
+struct OnsetDetector
+{
+  static const unsigned int FRAME_SIZE = 1024;
+  static const unsigned int HOP_SIZE = 256;
+  static const unsigned int PEAK_RADIUS = 3;         // Frames on either side of a peak
+  static const unsigned int AVERAGE_FRAMES = 9;      // Frames before a peak in the local average
+  static const unsigned int REFINE_BLOCK = 32;       // Resolution of the onset refinement, in samples
+  static constexpr float COMPRESSION = 100.0f;       // Log compression of the magnitudes
+  static constexpr float DEFAULT_THRESHOLD = 0.07f;  // Above the local average, with the envelope scaled to 0..1
+  static constexpr float MINIMUM_GAP = 0.05f;        // seconds
+
+  float threshold = DEFAULT_THRESHOLD;
+
+  // The onset envelope from the last call to detect(), scaled to 0..1, with
+  // one value per hop.  The TempoEstimator works from this.
+  std::vector<float> envelope;
+
+  rack::dsp::RealFFT fft {FRAME_SIZE};
+  std::vector<float> window;
+
+  OnsetDetector()
+  {
+    window.resize(FRAME_SIZE);
+    for(unsigned int i = 0; i < FRAME_SIZE; i++)
+    {
+      window[i] = 0.5f - (0.5f * std::cos(2.0 * M_PI * i / FRAME_SIZE));
+    }
+  }
+
+  //
+  // detect
+  //
+  // Fills _slices_ with the onsets found in the stereo sample held in _left_
+  // and _right_.
+  //
+  void detect(const std::vector<float> &left, const std::vector<float> &right, float sample_rate, SliceTable *slices)
+  {
+    slices->clear();
+    envelope.clear();
+
+    size_t length = std::min(left.size(), right.size());
+    if(length < FRAME_SIZE || sample_rate <= 0) return;
+
+    computeEnvelope(left, right, length, &envelope);
+
+    float largest = *std::max_element(envelope.begin(), envelope.end());
+    if(largest <= 0)
+    {
+      envelope.clear();
+      return;
+    }
+
+    for(float &value : envelope) value /= largest;
+
+    size_t frame_count = envelope.size();
+    double minimum_gap = MINIMUM_GAP * sample_rate;
+    double previous_onset = -minimum_gap;
+
+    for(size_t frame = 1; frame < frame_count; frame++)
+    {
+      float value = envelope[frame];
+
+      // It must be the largest value around it.  On a plateau, the first
+      // frame wins.
+      size_t first = (frame > PEAK_RADIUS) ? frame - PEAK_RADIUS : 0;
+      size_t last = std::min(frame + PEAK_RADIUS, frame_count - 1);
+
+      bool is_peak = true;
+      for(size_t i = first; i <= last && is_peak; i++)
+      {
+        if(envelope[i] > value || (i < frame && envelope[i] == value)) is_peak = false;
+      }
+      if(! is_peak) continue;
+
+      // It must stand out from the local average
+      size_t average_first = (frame > AVERAGE_FRAMES) ? frame - AVERAGE_FRAMES : 0;
+      float sum = 0.0f;
+      for(size_t i = average_first; i <= last; i++) sum += envelope[i];
+      float average = sum / (float) (last - average_first + 1);
+
+      if(value < average + threshold) continue;
+
+      uint32_t position = refine(left, right, length, frame);
+      if(position < previous_onset + minimum_gap) continue;
+
+      slices->positions.push_back(position);
+      slices->strengths.push_back(value);
+      previous_onset = position;
+    }
+  }
+
+  private:
+
+  // The envelope has one value per hop.  Frame _f_ is centered on sample
+  // f * HOP_SIZE.
+  void computeEnvelope(const std::vector<float> &left, const std::vector<float> &right, size_t length, std::vector<float> *envelope)
+  {
+    const unsigned int bins = FRAME_SIZE / 2;
+    size_t frame_count = (length + HOP_SIZE - 1) / HOP_SIZE;
+
+    // pffft needs both buffers aligned
+    alignas(16) float input[FRAME_SIZE];
+    alignas(16) float output[FRAME_SIZE];
+
+    std::vector<float> magnitudes(bins, 0.0f);
+    std::vector<float> previous(bins, 0.0f);
+
+    envelope->assign(frame_count, 0.0f);
+
+    for(size_t frame = 0; frame < frame_count; frame++)
+    {
+      long start = (long) (frame * HOP_SIZE) - (long) (FRAME_SIZE / 2);
+
+      for(unsigned int i = 0; i < FRAME_SIZE; i++)
+      {
+        long index = start + i;
+        float mono = (index >= 0 && (size_t) index < length) ? (left[index] + right[index]) * 0.5f : 0.0f;
+        input[i] = mono * window[i];
+      }
+
+      // The output is ordered: the real and imaginary parts of bin _k_ are
+      // at 2k and 2k + 1.  Bin 0 holds the DC and Nyquist terms, which are
+      // skipped.
+      fft.rfft(input, output);
+
+      float flux = 0.0f;
+
+      for(unsigned int bin = 1; bin < bins; bin++)
+      {
+        float real = output[2 * bin];
+        float imaginary = output[(2 * bin) + 1];
+        magnitudes[bin] = std::log1p(COMPRESSION * std::sqrt((real * real) + (imaginary * imaginary)));
+        float increase = magnitudes[bin] - previous[bin];
+        if(increase > 0) flux += increase;
+      }
+
+      // Frames that hang off the start of the sample would see the audio
+      // "begin" as an onset.  The start is always a slice boundary anyway.
+      (*envelope)[frame] = (start > 0) ? flux : 0.0f;
+      previous.swap(magnitudes);
+    }
+  }
+
+  //
+  // refine
+  //
+  // The envelope only says which frame an onset is in.  This looks at the
+  // energy in small blocks across that frame and returns the start of the
+  // block where the energy rises the most.
+  //
+  uint32_t refine(const std::vector<float> &left, const std::vector<float> &right, size_t length, size_t frame)
+  {
+    long center = (long) (frame * HOP_SIZE);
+    long start = std::max(0L, center - (long) (FRAME_SIZE / 2));
+    long end = std::min((long) length, center + (long) (FRAME_SIZE / 2));
+
+    long best_position = std::min(std::max(center, 0L), (long) length - 1);
+    float best_rise = 0.0f;
+    float previous_energy = -1.0f;
+
+    for(long block = start; block + (long) REFINE_BLOCK <= end; block += REFINE_BLOCK)
+    {
+      float energy = 0.0f;
+      for(long i = block; i < block + (long) REFINE_BLOCK; i++)
+      {
+        float mono = (left[i] + right[i]) * 0.5f;
+        energy += mono * mono;
+      }
+
+      if(previous_energy >= 0.0f && (energy - previous_energy) > best_rise)
+      {
+        best_rise = energy - previous_energy;
+        best_position = block;
+      }
+
+      previous_energy = energy;
+    }
+
+    return((uint32_t) best_position);
+  }
+};
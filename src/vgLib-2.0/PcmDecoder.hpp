@@ -0,0 +1,254 @@
+/*
+  PcmDecoder.hpp
+
+  Converts interleaved PCM audio, as it's stored in .wav and .aiff files, into
+  one buffer of floating point samples per channel.
+
+  Each combination of sample encoding and channel count gets its own kernel.
+  The encoding is a template parameter, so the inner loop has no branches and
+  no function calls, and reads and writes through plain pointers into buffers
+  that are sized once up front.  Written this way, the loops are simple enough
+  for the compiler to vectorize, which keeps decoding close to the speed of
+  copying memory.  Mono and stereo have dedicated loops; anything else falls
+  back to a generic one.
+
+  Rack's targets (x86-64 and ARM) are all little-endian, so little-endian
+  samples are read with memcpy, which compiles down to a single load.  Big
+  endian samples, found in .aiff files, are assembled from their bytes.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+struct PcmDecoder
+{
+  enum Encoding
+  {
+    UNSIGNED_8,       // .wav 8 bit
+    SIGNED_8,         // .aiff 8 bit
+    SIGNED_16,
+    SIGNED_24,
+    SIGNED_32,
+    FLOAT_32
+  };
+
+  //
+  // Readers
+  //
+  // Each reader converts a single sample, starting at _p_, to a float in the
+  // range of -1 to 1.
+  //
+
+  struct ReadUnsigned8
+  {
+    static const int BYTES = 1;
+    static inline float read(const uint8_t *p) { return((float)((int) p[0] - 128) * (1.0f / 128.0f)); }
+  };
+
+  struct ReadSigned8
+  {
+    static const int BYTES = 1;
+    static inline float read(const uint8_t *p) { return((float)(int8_t) p[0] * (1.0f / 128.0f)); }
+  };
+
+  struct ReadSigned16LE
+  {
+    static const int BYTES = 2;
+    static inline float read(const uint8_t *p)
+    {
+      int16_t value;
+      std::memcpy(&value, p, 2);
+      return((float) value * (1.0f / 32768.0f));
+    }
+  };
+
+  struct ReadSigned16BE
+  {
+    static const int BYTES = 2;
+    static inline float read(const uint8_t *p) { return((float)(int16_t)((p[0] << 8) | p[1]) * (1.0f / 32768.0f)); }
+  };
+
+  // 24 bit samples are placed in the top three bytes of an int32 and then
+  // shifted back down, which sign extends them without a branch.
+  struct ReadSigned24LE
+  {
+    static const int BYTES = 3;
+    static inline float read(const uint8_t *p)
+    {
+      int32_t value = (int32_t)(((uint32_t) p[0] << 8) | ((uint32_t) p[1] << 16) | ((uint32_t) p[2] << 24)) >> 8;
+      return((float) value * (1.0f / 8388608.0f));
+    }
+  };
+
+  struct ReadSigned24BE
+  {
+    static const int BYTES = 3;
+    static inline float read(const uint8_t *p)
+    {
+      int32_t value = (int32_t)(((uint32_t) p[2] << 8) | ((uint32_t) p[1] << 16) | ((uint32_t) p[0] << 24)) >> 8;
+      return((float) value * (1.0f / 8388608.0f));
+    }
+  };
+
+  struct ReadSigned32LE
+  {
+    static const int BYTES = 4;
+    static inline float read(const uint8_t *p)
+    {
+      int32_t value;
+      std::memcpy(&value, p, 4);
+      return((float) value * (1.0f / 2147483648.0f));
+    }
+  };
+
+  struct ReadSigned32BE
+  {
+    static const int BYTES = 4;
+    static inline float read(const uint8_t *p)
+    {
+      int32_t value = (int32_t)(((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) | ((uint32_t) p[2] << 8) | (uint32_t) p[3]);
+      return((float) value * (1.0f / 2147483648.0f));
+    }
+  };
+
+  struct ReadFloat32LE
+  {
+    static const int BYTES = 4;
+    static inline float read(const uint8_t *p)
+    {
+      float value;
+      std::memcpy(&value, p, 4);
+      return(value);
+    }
+  };
+
+  struct ReadFloat32BE
+  {
+    static const int BYTES = 4;
+    static inline float read(const uint8_t *p)
+    {
+      uint32_t bits = ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) | ((uint32_t) p[2] << 8) | (uint32_t) p[3];
+      float value;
+      std::memcpy(&value, &bits, 4);
+      return(value);
+    }
+  };
+
+  //
+  // Kernels
+  //
+
+  template <typename Reader, typename T>
+  static void decodeMono(const uint8_t *source, size_t frame_count, T *destination)
+  {
+    T *__restrict out = destination;
+
+    for (size_t i = 0; i < frame_count; i++)
+    {
+      out[i] = (T) Reader::read(source + (i * Reader::BYTES));
+    }
+  }
+
+  template <typename Reader, typename T>
+  static void decodeStereo(const uint8_t *source, size_t frame_count, T *left_destination, T *right_destination)
+  {
+    T *__restrict left = left_destination;
+    T *__restrict right = right_destination;
+
+    for (size_t i = 0; i < frame_count; i++)
+    {
+      const uint8_t *frame = source + (i * Reader::BYTES * 2);
+      left[i] = (T) Reader::read(frame);
+      right[i] = (T) Reader::read(frame + Reader::BYTES);
+    }
+  }
+
+  template <typename Reader, typename T>
+  static void decodeChannels(const uint8_t *source, size_t frame_count, std::vector<std::vector<T>> &destination)
+  {
+    int channel_count = destination.size();
+
+    if (channel_count == 1)
+    {
+      decodeMono<Reader>(source, frame_count, destination[0].data());
+    }
+    else if (channel_count == 2)
+    {
+      decodeStereo<Reader>(source, frame_count, destination[0].data(), destination[1].data());
+    }
+    else
+    {
+      // Uncommon layouts go one channel at a time, striding over the others
+      size_t frame_bytes = Reader::BYTES * channel_count;
+
+      for (int channel = 0; channel < channel_count; channel++)
+      {
+        T *__restrict out = destination[channel].data();
+        const uint8_t *channel_source = source + (channel * Reader::BYTES);
+
+        for (size_t i = 0; i < frame_count; i++)
+        {
+          out[i] = (T) Reader::read(channel_source + (i * frame_bytes));
+        }
+      }
+    }
+  }
+
+  static int bytesPerSample(Encoding encoding)
+  {
+    switch (encoding)
+    {
+      case UNSIGNED_8:
+      case SIGNED_8: return(1);
+      case SIGNED_16: return(2);
+      case SIGNED_24: return(3);
+      default: return(4);
+    }
+  }
+
+  //
+  // decode
+  //
+  // Decode _frame_count_ interleaved frames from _source_ into _destination_,
+  // which is resized to _channel_count_ buffers of _frame_count_ samples.
+  // The caller is responsible for making sure that _source_ holds at least
+  // frame_count * channel_count * bytesPerSample(encoding) bytes.
+  //
+  template <typename T>
+  static void decode(const uint8_t *source, size_t frame_count, int channel_count, Encoding encoding, bool big_endian, std::vector<std::vector<T>> &destination)
+  {
+    destination.resize(channel_count);
+    for (std::vector<T> &channel : destination) channel.resize(frame_count);
+
+    if (frame_count == 0 || channel_count < 1) return;
+
+    switch (encoding)
+    {
+      case UNSIGNED_8:
+        decodeChannels<ReadUnsigned8>(source, frame_count, destination);
+        break;
+      case SIGNED_8:
+        decodeChannels<ReadSigned8>(source, frame_count, destination);
+        break;
+      case SIGNED_16:
+        if (big_endian) decodeChannels<ReadSigned16BE>(source, frame_count, destination);
+        else decodeChannels<ReadSigned16LE>(source, frame_count, destination);
+        break;
+      case SIGNED_24:
+        if (big_endian) decodeChannels<ReadSigned24BE>(source, frame_count, destination);
+        else decodeChannels<ReadSigned24LE>(source, frame_count, destination);
+        break;
+      case SIGNED_32:
+        if (big_endian) decodeChannels<ReadSigned32BE>(source, frame_count, destination);
+        else decodeChannels<ReadSigned32LE>(source, frame_count, destination);
+        break;
+      case FLOAT_32:
+        if (big_endian) decodeChannels<ReadFloat32BE>(source, frame_count, destination);
+        else decodeChannels<ReadFloat32LE>(source, frame_count, destination);
+        break;
+    }
+  }
+};
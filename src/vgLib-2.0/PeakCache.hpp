@@ -0,0 +1,283 @@
+/*
+  PeakCache.hpp
+
+  The PeakCache keeps PeakPyramids, SampleAnalysis data and SliceTables on
+  disk, in a folder in the Rack user directory, so that they only have to be computed
+  the first time a sample is ever loaded.
+
+  Entries are keyed on the path of the sample, along with its file size and
+  modification time.  If a .wav file is edited, its key changes and the old
+  entry is simply never read again.  The rate that the sample is converted
+  to as it's loaded (0 when it isn't) is part of the key too, because the
+  pyramid and analysis describe the converted audio.  A sample that's loaded
+  both ways has an entry for each, rather than one that's rewritten every
+  time the setting changes.
+
+  Cache files are written to a temporary name and then renamed so that a
+  half-written file is never mistaken for a valid entry.  The temporary name
+  is unique to the writer, because the prefetcher and a module can both be
+  caching the same sample at once.
+
+  The folder is kept under MAX_BYTES.  Reading an entry touches its
+  modification time, and after each write the entries that were used
+  longest ago are deleted until the folder fits again.
+
+  Reading is done on loader threads, where an exception would bring Rack
+  down, so nothing in a cache file is trusted.  Every count is checked
+  against the space left in the file before anything is allocated, and the
+  pyramid has to have exactly the shape that PeakPyramid::build() would
+  give the sample.
+*/
+
+#pragma once
+
+#include <cstdio>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <sys/stat.h>
+#include <utime.h>
+
+#include "PeakPyramid.hpp"
+#include "SampleAnalysis.hpp"
+
+#define PEAK_CACHE_FOLDER_NAME "voxglitch_peak_cache"
+
+struct PeakCache
+{
+  static const uint32_t MAGIC = 0x4B505756; // "VWPK"
+  static const uint32_t VERSION = 4;    // Version 2 added the slice table, 3 the beat grid, and 4 mean_abs
+  static const uint64_t MAX_BYTES = 256ULL * 1024 * 1024;
+
+  static std::string getFolder()
+  {
+    return(asset::user(PEAK_CACHE_FOLDER_NAME));
+  }
+
+  //
+  // getCachePath
+  //
+  // Returns the path of the cache file for the sample at _sample_path_ when
+  // it's loaded at _target_sample_rate_, or an empty string if the sample
+  // can't be found.  The file name is a 64 bit FNV-1a hash of the sample's
+  // path, size, modification time and the target rate.
+  //
+  static std::string getCachePath(const std::string &sample_path, uint32_t target_sample_rate)
+  {
+    struct stat file_info;
+    if(stat(sample_path.c_str(), &file_info) != 0) return("");
+
+    std::string key = sample_path + "|" + std::to_string((long long) file_info.st_size) + "|" + std::to_string((long long) file_info.st_mtime) + "|" + std::to_string((unsigned long) target_sample_rate);
+
+    uint64_t hash = 14695981039346656037ULL;
+    for(unsigned char c : key)
+    {
+      hash ^= c;
+      hash *= 1099511628211ULL;
+    }
+
+    char filename[32];
+    snprintf(filename, sizeof(filename), "%016llx.peaks", (unsigned long long) hash);
+
+    return(system::join(getFolder(), filename));
+  }
+
+  static bool read(const std::string &sample_path, uint32_t target_sample_rate, PeakPyramid *peak_pyramid, SampleAnalysis *analysis, SliceTable *slices)
+  {
+    std::string cache_path = getCachePath(sample_path, target_sample_rate);
+    if(cache_path == "") return(false);
+
+    FILE *file = fopen(cache_path.c_str(), "rb");
+    if(! file) return(false);
+
+    bool success = false;
+    uint32_t header[2] = {0, 0};
+    uint32_t level_count = 0;
+
+    peak_pyramid->clear();
+    slices->clear();
+
+    int64_t remaining = 0;
+    if(fseek(file, 0, SEEK_END) == 0) remaining = ftell(file);
+    rewind(file);
+
+    if((fread(header, sizeof(uint32_t), 2, file) == 2) && (header[0] == MAGIC) && (header[1] == VERSION)
+      && (fread(analysis, sizeof(SampleAnalysis), 1, file) == 1)
+      && (fread(&level_count, sizeof(uint32_t), 1, file) == 1))
+    {
+      remaining -= (int64_t) ((3 * sizeof(uint32_t)) + sizeof(SampleAnalysis));
+
+      // The bin counts have to match the ones that build() would give a
+      // sample of this length, which also rules out nonsense level counts
+      unsigned int frame_count = analysis->frame_count;
+      uint32_t expected_bins = ((uint64_t) frame_count + PeakPyramid::BASE_BLOCK_SIZE - 1) / PeakPyramid::BASE_BLOCK_SIZE;
+
+      success = (remaining >= 0);
+
+      for(uint32_t level = 0; level < level_count && success; level++)
+      {
+        uint32_t bin_count = 0;
+
+        success = (expected_bins > 0)
+          && (fread(&bin_count, sizeof(uint32_t), 1, file) == 1)
+          && (bin_count == expected_bins)
+          && (remaining >= (int64_t) (sizeof(uint32_t) + ((uint64_t) bin_count * sizeof(PeakBin))));
+
+        if(! success) break;
+
+        peak_pyramid->levels.emplace_back(bin_count);
+        success = (fread(peak_pyramid->levels.back().data(), sizeof(PeakBin), bin_count, file) == bin_count);
+
+        remaining -= (int64_t) (sizeof(uint32_t) + ((uint64_t) bin_count * sizeof(PeakBin)));
+        expected_bins = (bin_count > 1) ? (bin_count + 1) / 2 : 0;
+      }
+
+      // Every level down to a single bin has to be there
+      success = success && (expected_bins == 0);
+
+      peak_pyramid->frame_count = frame_count;
+
+      uint32_t slice_count = 0;
+      success = success && (fread(&slice_count, sizeof(uint32_t), 1, file) == 1);
+      remaining -= (int64_t) sizeof(uint32_t);
+
+      success = success && (remaining == (int64_t) ((uint64_t) slice_count * (sizeof(uint32_t) + sizeof(float))));
+
+      if(success)
+      {
+        slices->positions.resize(slice_count);
+        slices->strengths.resize(slice_count);
+        success = (fread(slices->positions.data(), sizeof(uint32_t), slice_count, file) == slice_count)
+          && (fread(slices->strengths.data(), sizeof(float), slice_count, file) == slice_count);
+      }
+
+      for(uint32_t i = 0; i < slice_count && success; i++)
+      {
+        success = (slices->positions[i] < frame_count) && (i == 0 || slices->positions[i] >= slices->positions[i - 1]);
+      }
+    }
+
+    fclose(file);
+
+    if(success)
+    {
+      // Mark the entry as recently used, so that trim() keeps it
+      utime(cache_path.c_str(), NULL);
+    }
+    else
+    {
+      peak_pyramid->clear();
+      analysis->clear();
+      slices->clear();
+    }
+
+    return(success);
+  }
+
+  static bool write(const std::string &sample_path, uint32_t target_sample_rate, PeakPyramid *peak_pyramid, SampleAnalysis *analysis, SliceTable *slices)
+  {
+    std::string cache_path = getCachePath(sample_path, target_sample_rate);
+    if(cache_path == "") return(false);
+
+    system::createDirectories(getFolder());
+
+    std::string temp_path = getTempPath(cache_path);
+    FILE *file = fopen(temp_path.c_str(), "wb");
+    if(! file) return(false);
+
+    uint32_t header[2] = { MAGIC, VERSION };
+    uint32_t level_count = peak_pyramid->levels.size();
+
+    bool success = (fwrite(header, sizeof(uint32_t), 2, file) == 2)
+      && (fwrite(analysis, sizeof(SampleAnalysis), 1, file) == 1)
+      && (fwrite(&level_count, sizeof(uint32_t), 1, file) == 1);
+
+    for(uint32_t level = 0; level < level_count && success; level++)
+    {
+      uint32_t bin_count = peak_pyramid->levels[level].size();
+      success = (fwrite(&bin_count, sizeof(uint32_t), 1, file) == 1)
+        && (fwrite(peak_pyramid->levels[level].data(), sizeof(PeakBin), bin_count, file) == bin_count);
+    }
+
+    uint32_t slice_count = slices->size();
+    success = success && (fwrite(&slice_count, sizeof(uint32_t), 1, file) == 1)
+      && (fwrite(slices->positions.data(), sizeof(uint32_t), slice_count, file) == slice_count)
+      && (fwrite(slices->strengths.data(), sizeof(float), slice_count, file) == slice_count);
+
+    fclose(file);
+
+    if(success)
+    {
+      std::remove(cache_path.c_str());
+      success = (std::rename(temp_path.c_str(), cache_path.c_str()) == 0);
+    }
+
+    if(! success) std::remove(temp_path.c_str());
+
+    if(success) trim();
+
+    return(success);
+  }
+
+  //
+  // trim
+  //
+  // Deletes the least recently used entries until the cache folder is no
+  // bigger than MAX_BYTES.
+  //
+  static void trim()
+  {
+    struct Entry
+    {
+      std::string path;
+      uint64_t bytes;
+      time_t last_used;
+    };
+
+    std::vector<Entry> entries;
+    uint64_t total_bytes = 0;
+
+    for(const std::string &path : system::getEntries(getFolder()))
+    {
+      struct stat file_info;
+      if(system::getExtension(path) != ".peaks" || stat(path.c_str(), &file_info) != 0) continue;
+
+      Entry entry;
+      entry.path = path;
+      entry.bytes = file_info.st_size;
+      entry.last_used = file_info.st_mtime;
+      entries.push_back(entry);
+
+      total_bytes += entry.bytes;
+    }
+
+    if(total_bytes <= MAX_BYTES) return;
+
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+      return(a.last_used < b.last_used);
+    });
+
+    for(const Entry &entry : entries)
+    {
+      if(total_bytes <= MAX_BYTES) break;
+
+      // Another thread may have got to it first
+      std::remove(entry.path.c_str());
+      total_bytes -= entry.bytes;
+    }
+  }
+
+  // A temporary name for writing _path_ that no other thread will be using
+  static std::string getTempPath(const std::string &path)
+  {
+    static std::atomic<unsigned int> counter(0);
+
+    size_t thread_hash = std::hash<std::thread::id>()(std::this_thread::get_id());
+    return(path + "." + std::to_string((unsigned long long) thread_hash) + "." + std::to_string(counter++) + ".tmp");
+  }
+};
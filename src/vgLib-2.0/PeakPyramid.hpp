@@ -0,0 +1,198 @@
+/*
+  PeakPyramid.hpp
+
+  A PeakPyramid is a precomputed, mip-mapped summary of a sample's audio used
+  for drawing waveforms.  It's built once, when the sample is loaded, and then
+  any waveform display, at any zoom level, can ask for the min/max, mean
+  absolute level or rms of an arbitrary range of frames without touching the raw audio.
+
+  Level 0 summarizes blocks of BASE_BLOCK_SIZE frames.  Each level above it
+  summarizes twice as many frames as the one below, so a range query only ever
+  has to look at a handful of bins at the coarsest level that still fits
+  inside the requested range.
+
+  The left and right channels are folded together, which matches the way
+  the waveform displays draw a single, symmetric waveform.
+*/
+
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+struct PeakBin
+{
+  float min = 0.0;
+  float max = 0.0;
+  float mean_abs = 0.0;       // What the waveform displays draw
+  float mean_square = 0.0;
+};
+
+struct PeakPyramid
+{
+  static const unsigned int BASE_BLOCK_SIZE = 16;
+
+  std::vector<std::vector<PeakBin>> levels;
+  unsigned int frame_count = 0;
+
+  void clear()
+  {
+    std::vector<std::vector<PeakBin>>().swap(levels);
+    frame_count = 0;
+  }
+
+  bool isBuilt()
+  {
+    return(! levels.empty());
+  }
+
+  unsigned int blockSize(unsigned int level)
+  {
+    return(BASE_BLOCK_SIZE << level);
+  }
+
+  void build(const std::vector<float> &left, const std::vector<float> &right)
+  {
+    clear();
+
+    frame_count = std::min(left.size(), right.size());
+
+    if(frame_count == 0) return;
+
+    //
+    // Level 0 is computed directly from the audio
+    //
+    unsigned int bin_count = (frame_count + BASE_BLOCK_SIZE - 1) / BASE_BLOCK_SIZE;
+    levels.emplace_back(bin_count);
+    std::vector<PeakBin> &base = levels[0];
+
+    for(unsigned int bin_index = 0; bin_index < bin_count; bin_index++)
+    {
+      unsigned int start = bin_index * BASE_BLOCK_SIZE;
+      unsigned int end = std::min(start + BASE_BLOCK_SIZE, frame_count);
+
+      base[bin_index] = summarize(left, right, start, end);
+    }
+
+    //
+    // Each level above halves the number of bins by merging pairs from the
+    // level below until a single bin covers the whole sample.
+    //
+    while(levels.back().size() > 1)
+    {
+      unsigned int level = levels.size();
+      unsigned int child_block_size = blockSize(level - 1);
+      unsigned int child_count = levels[level - 1].size();
+
+      levels.emplace_back((child_count + 1) / 2);
+
+      std::vector<PeakBin> &children = levels[level - 1];
+      std::vector<PeakBin> &parents = levels[level];
+
+      for(unsigned int i = 0; i < parents.size(); i++)
+      {
+        unsigned int a = i * 2;
+        unsigned int b = a + 1;
+
+        if(b >= child_count)
+        {
+          parents[i] = children[a];
+          continue;
+        }
+
+        // The second child might be a partial bin at the end of the sample,
+        // so weight the means by the frames they actually cover.
+        unsigned int frames_a = child_block_size;
+        unsigned int frames_b = std::min(child_block_size, frame_count - (b * child_block_size));
+
+        parents[i].min = std::min(children[a].min, children[b].min);
+        parents[i].max = std::max(children[a].max, children[b].max);
+        parents[i].mean_abs = ((children[a].mean_abs * frames_a) + (children[b].mean_abs * frames_b)) / (float)(frames_a + frames_b);
+        parents[i].mean_square = ((children[a].mean_square * frames_a) + (children[b].mean_square * frames_b)) / (float)(frames_a + frames_b);
+      }
+    }
+  }
+
+  //
+  // query
+  //
+  // Returns the summary of frames [start, end).  The cost depends only on the
+  // number of bins that need to be visited, which is at most a few per call,
+  // and not on the length of the range.  The audio buffers are only read for
+  // very short ranges, and must be the same ones the pyramid was built from.
+  // If they're empty, because the pyramid came from the PeakCache and the
+  // audio hasn't been loaded yet, short ranges are answered from level 0.
+  //
+
+  PeakBin query(const std::vector<float> &left, const std::vector<float> &right, unsigned int start, unsigned int end)
+  {
+    PeakBin result;
+
+    end = std::min(end, frame_count);
+    if(levels.empty() || start >= end) return(result);
+
+    unsigned int span = end - start;
+
+    // Short ranges are read straight from the audio
+    if(span < (BASE_BLOCK_SIZE * 4) && std::min(left.size(), right.size()) >= end) return(summarize(left, right, start, end));
+
+    // Pick the coarsest level that still gives at least four bins across the
+    // range, which keeps the partial bins at either end from smearing it much.
+    unsigned int level = 0;
+    while((level + 1) < levels.size() && (blockSize(level + 1) * 4) <= span) level++;
+
+    unsigned int block_size = blockSize(level);
+    unsigned int first_bin = start / block_size;
+    unsigned int last_bin = std::min((unsigned int) levels[level].size(), (end + block_size - 1) / block_size);
+
+    std::vector<PeakBin> &bins = levels[level];
+
+    result = bins[first_bin];
+    double abs_sum = 0.0;
+    double square_sum = 0.0;
+    unsigned int frames = 0;
+
+    for(unsigned int i = first_bin; i < last_bin; i++)
+    {
+      unsigned int bin_frames = std::min(block_size, frame_count - (i * block_size));
+
+      result.min = std::min(result.min, bins[i].min);
+      result.max = std::max(result.max, bins[i].max);
+      abs_sum += bins[i].mean_abs * bin_frames;
+      square_sum += bins[i].mean_square * bin_frames;
+      frames += bin_frames;
+    }
+
+    result.mean_abs = (frames > 0) ? (abs_sum / frames) : 0.0;
+    result.mean_square = (frames > 0) ? (square_sum / frames) : 0.0;
+
+    return(result);
+  }
+
+  PeakBin summarize(const std::vector<float> &left, const std::vector<float> &right, unsigned int start, unsigned int end)
+  {
+    PeakBin bin;
+
+    end = std::min(end, (unsigned int) std::min(left.size(), right.size()));
+    if(start >= end) return(bin);
+
+    bin.min = left[start];
+    bin.max = left[start];
+    float abs_sum = 0.0;
+    float square_sum = 0.0;
+
+    for(unsigned int i = start; i < end; i++)
+    {
+      bin.min = std::min(bin.min, std::min(left[i], right[i]));
+      bin.max = std::max(bin.max, std::max(left[i], right[i]));
+      abs_sum += (std::abs(left[i]) + std::abs(right[i])) * 0.5f;
+      square_sum += ((left[i] * left[i]) + (right[i] * right[i])) * 0.5f;
+    }
+
+    bin.mean_abs = abs_sum / (float)(end - start);
+    bin.mean_square = square_sum / (float)(end - start);
+
+    return(bin);
+  }
+};
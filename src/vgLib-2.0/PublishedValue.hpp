@@ -0,0 +1,162 @@
+/*
+  PublishedValue.hpp
+
+  Hands a value, such as a compiled program or a table of markers, from the
+  UI (or a loading thread) to the audio thread without the audio thread ever
+  waiting, allocating or freeing memory.
+
+  The publishing side calls publish() with each new value.  The audio thread
+  calls update(), which picks up the latest value if there's been a new one,
+  and then reads it with get() until the next update().
+
+  The audio thread holds a reference to whichever value it's using, so a
+  replaced value can't simply be dropped by the publisher: the audio thread
+  might then let go of the last reference and free it.  Replaced values go on
+  a retired list instead, tagged with the generation that replaced them.
+  Each update() reports the generation the audio thread has moved on to, and
+  publish() frees every retired value that the audio thread has moved past.
+  However many values are published between two updates, none of them is
+  ever freed on the audio thread.
+
+  While the audio thread isn't running, for instance while a module is
+  bypassed, nothing is freed, and retired values wait for the first publish()
+  or release() after it starts again.  The rest go when the PublishedValue is
+  destroyed.
+
+  T is normally const, as in PublishedValue<const MarkerTable>, since the
+  audio thread only reads the value.  A value that the audio thread changes,
+  such as a SamplePlayer's PendingSample, is published without the const.
+
+  publish() and release() may be called from more than one thread.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+#ifndef METAMODULE
+#include <mutex>
+#endif
+
+template <typename T>
+struct PublishedValue
+{
+  struct Retired
+  {
+    std::shared_ptr<T> value;
+    uint32_t replaced_by = 0;   // The generation that replaced it
+  };
+
+  // Publishing side
+  std::shared_ptr<T> latest;                  // Read and written with atomic_load and atomic_store
+  std::vector<Retired> retired;
+  std::atomic<uint32_t> generation {0};
+  std::atomic<uint32_t> acknowledged {0};     // The generation the audio thread has moved on to
+#ifndef METAMODULE
+  std::mutex publish_mutex;
+#endif
+
+  // Audio thread
+  std::shared_ptr<T> active;
+  uint32_t active_generation = 0;
+
+  PublishedValue()
+  {
+  }
+
+  // The audio thread starts out with _initial_, so get() is never null
+  PublishedValue(std::shared_ptr<T> initial) : latest(initial), active(initial)
+  {
+  }
+
+  void publish(std::shared_ptr<T> value)
+  {
+#ifndef METAMODULE
+    std::lock_guard<std::mutex> lock(publish_mutex);
+#endif
+
+    releaseRetired();
+
+    Retired replaced;
+    replaced.value = std::atomic_load(&latest);
+    replaced.replaced_by = generation.load() + 1;
+
+    std::atomic_store(&latest, value);
+    generation++;
+
+    if(replaced.value) retired.push_back(replaced);
+  }
+
+  // Frees the retired values that the audio thread has moved past, for when
+  // nothing new is being published.  Returns true if none are left.
+  bool release()
+  {
+#ifndef METAMODULE
+    std::lock_guard<std::mutex> lock(publish_mutex);
+#endif
+
+    releaseRetired();
+    return(retired.empty());
+  }
+
+  // The most recently published value, for threads other than the audio
+  // thread
+  std::shared_ptr<T> getLatest()
+  {
+    return(std::atomic_load(&latest));
+  }
+
+  // Audio thread.  Returns true if there's a value that update() would pick
+  // up.
+  bool changed()
+  {
+    return(generation.load() != active_generation);
+  }
+
+  // Audio thread.  Returns true if a new value has been picked up.
+  bool update()
+  {
+    uint32_t newest = generation.load();
+    if(newest == active_generation) return(false);
+
+    // The value being let go of is on the retired list, so this doesn't
+    // free it
+    active = std::atomic_load(&latest);
+    active_generation = newest;
+    acknowledged = newest;
+
+    return(true);
+  }
+
+  // Audio thread.  Null until something has been published, unless there
+  // was an initial value.
+  T *get()
+  {
+    return(active.get());
+  }
+
+  private:
+
+  // The audio thread read the generation before the value, so once it has
+  // acknowledged a generation, it holds nothing that was replaced by that
+  // generation or an earlier one.  Called with the lock held.
+  void releaseRetired()
+  {
+    uint32_t moved_on_to = acknowledged.load();
+
+    for(size_t i = 0; i < retired.size(); )
+    {
+      if(retired[i].replaced_by <= moved_on_to)
+      {
+        retired.erase(retired.begin() + i);
+      }
+      else
+      {
+        i++;
+      }
+    }
+  }
+};
@@ -0,0 +1,106 @@
+/*
+  SampleAnalysis.hpp
+
+  SampleAnalysis holds the facts about a sample that can be worked out once,
+  when the sample is loaded, and are worth remembering between sessions.  It
+  travels alongside the PeakPyramid in the on-disk peak cache so that a patch
+  can know about its samples without decoding them again.
+
+  SliceTable lists the transients (onsets) found in the sample by the
+  OnsetDetector.  It's kept separate from SampleAnalysis because its size
+  varies, but it's stored in the same cache file.
+*/
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+struct SampleAnalysis
+{
+  unsigned int frame_count = 0;
+  float sample_rate = 0.0;
+  unsigned int channels = 0;
+  float peak = 0.0;     // Largest absolute value in either channel
+  float rms = 0.0;      // Root mean square over the entire sample
+
+  // The beat grid, from the TempoEstimator.  _beats_ is 0 if it's unknown.
+  unsigned int beats = 0;     // Beats in the sample, treating it as a loop
+  float beat_length = 0.0;    // Frames per beat
+  float beat_offset = 0.0;    // Frame of the first beat, less than one beat in
+
+  void clear()
+  {
+    frame_count = 0;
+    sample_rate = 0.0;
+    channels = 0;
+    peak = 0.0;
+    rms = 0.0;
+    beats = 0;
+    beat_length = 0.0;
+    beat_offset = 0.0;
+  }
+
+  // Frame at which beat number _beat_ starts
+  float getBeatPosition(unsigned int beat) const
+  {
+    return(beat_offset + (beat * beat_length));
+  }
+
+  // The sample's own tempo, when played at its own rate
+  float getTempo() const
+  {
+    if(beats == 0 || beat_length <= 0) return(0.0);
+    return(60.0 * sample_rate / beat_length);
+  }
+};
+
+struct SliceTable
+{
+  std::vector<uint32_t> positions;  // Onset positions in frames, in ascending order
+  std::vector<float> strengths;     // How pronounced each onset is, from 0 to 1
+
+  void clear()
+  {
+    positions.clear();
+    strengths.clear();
+  }
+
+  size_t size() const
+  {
+    return(positions.size());
+  }
+
+  bool empty() const
+  {
+    return(positions.empty());
+  }
+
+  // Returns the onset closest to _position_, if there's one within
+  // _tolerance_ frames of it.  Otherwise _position_ is returned unchanged.
+  double snap(double position, double tolerance) const
+  {
+    if(positions.empty()) return(position);
+
+    size_t index = std::lower_bound(positions.begin(), positions.end(), position, [](uint32_t onset, double value) {
+      return(onset < value);
+    }) - positions.begin();
+
+    double nearest = position;
+    double nearest_distance = tolerance;
+
+    if(index < positions.size() && (positions[index] - position) <= nearest_distance)
+    {
+      nearest = positions[index];
+      nearest_distance = positions[index] - position;
+    }
+
+    if(index > 0 && (position - positions[index - 1]) < nearest_distance)
+    {
+      nearest = positions[index - 1];
+    }
+
+    return(nearest);
+  }
+};
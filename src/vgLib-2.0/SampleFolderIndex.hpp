@@ -0,0 +1,105 @@
+/*
+  SampleFolderIndex.hpp
+
+  Keeps a sorted list of the .wav files in each folder that has been browsed,
+  so that stepping from one sample to the next doesn't have to list and
+  filter the whole folder every time.
+
+  A folder's list is rebuilt only when the folder's modification time
+  changes, which happens whenever a file is added, removed, or renamed.
+
+  The list is sorted by filename (byte order, so upper case comes first).
+  The raw directory listing that GrooveBox used to step through comes in
+  whatever order the file system keeps, which differs between platforms.
+
+  The index is shared by every module in the plugin and is safe to use from
+  more than one thread, although it's normally only used from the UI thread.
+*/
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <sys/stat.h>
+
+struct SampleFolderIndex
+{
+  struct Folder
+  {
+    time_t modified = 0;
+    std::vector<std::string> paths;       // Sorted by filename
+    std::vector<std::string> filenames;   // Same order as paths
+  };
+
+  //
+  // getFolder
+  //
+  // Returns the list of .wav files in _directory_.  The returned Folder is
+  // never modified, so it's fine to hang on to it while the index changes.
+  //
+  static std::shared_ptr<const Folder> getFolder(const std::string &directory)
+  {
+    time_t modified = getModifiedTime(directory);
+
+    std::lock_guard<std::mutex> lock(getMutex());
+    std::map<std::string, std::shared_ptr<const Folder>> &folders = getFolders();
+
+    auto found = folders.find(directory);
+    if (found != folders.end() && found->second->modified == modified) return(found->second);
+
+    std::shared_ptr<Folder> folder = std::make_shared<Folder>();
+    folder->modified = modified;
+
+    std::vector<std::string> directory_list = rack::system::getEntries(directory);
+    std::sort(directory_list.begin(), directory_list.end());
+
+    for (const std::string &entry : directory_list)
+    {
+      // Something happened in Rack 2 where the extension started to include
+      // the ".", so check for both versions, just in case.
+      std::string extension = rack::string::lowercase(rack::system::getExtension(entry));
+
+      if (extension == "wav" || extension == ".wav")
+      {
+        folder->paths.push_back(entry);
+        folder->filenames.push_back(rack::system::getFilename(entry));
+      }
+    }
+
+    folders[directory] = folder;
+    return(folder);
+  }
+
+  // Returns the position of _filename_ in _folder_, or -1 if it isn't there.
+  // All of the paths share the same directory, so the filenames are sorted
+  // too, and can be binary searched.
+  static int find(const Folder &folder, const std::string &filename)
+  {
+    auto found = std::lower_bound(folder.filenames.begin(), folder.filenames.end(), filename);
+    if (found == folder.filenames.end() || *found != filename) return(-1);
+    return(found - folder.filenames.begin());
+  }
+
+  static time_t getModifiedTime(const std::string &directory)
+  {
+    struct stat directory_info;
+    if (stat(directory.c_str(), &directory_info) != 0) return(0);
+    return(directory_info.st_mtime);
+  }
+
+  static std::map<std::string, std::shared_ptr<const Folder>> &getFolders()
+  {
+    static std::map<std::string, std::shared_ptr<const Folder>> folders;
+    return(folders);
+  }
+
+  static std::mutex &getMutex()
+  {
+    static std::mutex mutex;
+    return(mutex);
+  }
+};
@@ -17,14 +17,338 @@
   SamplePlayer is not multi-timbral, and that might be something that could
   improve it in the future.
 
+  If resample_on_load is set, samples are converted to the engine's sample
+  rate when they're loaded, so that playback at unity pitch is a plain read
+  with no interpolation.  When the engine's sample rate changes, the sample
+  is converted again by the SamplePlayerWorker and swapped in by the audio
+  thread once it's ready.
+
+  A sample that has already been decoded elsewhere, such as by a
+  SamplePrefetcher, can be handed over with swapSample().  The audio thread
+  swaps it in and crossfades from the previous sample, so there's no click.
+
+  Both kinds of job are handed to the audio thread through a PublishedValue,
+  so a job that's been replaced or cancelled is never freed on the audio
+  thread.
+
+  Modules that play a Sample directly, without a SamplePlayer, can use a
+  BackgroundSampleLoad to have the same worker decode their samples.
+
 */
 
+#include <atomic>
+#include <memory>
+#include <list>
+#include <deque>
+#include "PublishedValue.hpp"
+
+#ifndef METAMODULE
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#endif
+
+// A sample waiting to be swapped into a SamplePlayer by the audio thread,
+// either from a background sample rate conversion or from swapSample().  The
+// swap leaves the old audio here so that it can be freed off of the audio
+// thread.
+struct PendingSample
+{
+  Sample sample;
+  std::atomic<bool> ready {false};
+  std::atomic<bool> adopted {false};
+  bool swapped_in = false;    // Only used by the audio thread
+
+  // When set, the old audio fades out over crossfade_frames instead of the
+  // playback position being rescaled to the new sample rate.
+  bool crossfade = false;
+  unsigned int crossfade_frames = 0;
+};
+
+// Shared between a SamplePlayer and the SamplePlayerWorker, so the worker can
+// finish tidying up after a player that's been deleted.
+struct SamplePlayerHandoff
+{
+  PublishedValue<PendingSample> jobs;
+};
+
+//
+// SamplePlayerWorker
+//
+// One thread, shared by every SamplePlayer, that converts samples for
+// resampleInBackground() and frees the audio that the audio thread has
+// swapped out.  The thread is started when there's work for it and stops
+// when there's none left.
+//
+// Once a job has been handed over, the worker checks on it every
+// sweep_interval.  When the audio thread has adopted the job, the old
+// audio that was swapped into it is freed.  When the job has been replaced
+// or cancelled instead, the worker lets go of it, and it's freed by the
+// player's PublishedValue once the audio thread has moved past it.
+//
+struct SamplePlayerWorker
+{
+  struct Task
+  {
+    std::shared_ptr<PendingSample> job;
+    std::shared_ptr<SamplePlayerHandoff> handoff;
+    std::string path;
+    uint32_t target_sample_rate = 0;
+  };
+
+#ifndef METAMODULE
+  std::chrono::milliseconds sweep_interval {20};
+  std::deque<Task> loads;
+  std::list<Task> watched;
+  std::thread worker;
+  std::mutex worker_mutex;
+  std::condition_variable worker_condition;
+  bool running = false;
+  bool stopping = false;
+
+  ~SamplePlayerWorker()
+  {
+    {
+      std::lock_guard<std::mutex> lock(worker_mutex);
+      stopping = true;
+    }
+    worker_condition.notify_one();
+    if(worker.joinable()) worker.join();
+  }
+#endif
+
+  static SamplePlayerWorker &get()
+  {
+    static SamplePlayerWorker instance;
+    return(instance);
+  }
+
+  // Load _path_ into _job_ at _target_sample_rate_, then mark it ready and
+  // keep an eye on it
+  void load(std::shared_ptr<PendingSample> job, std::shared_ptr<SamplePlayerHandoff> handoff, const std::string &path, uint32_t target_sample_rate)
+  {
+    Task task;
+    task.job = job;
+    task.handoff = handoff;
+    task.path = path;
+    task.target_sample_rate = target_sample_rate;
+
+#ifndef METAMODULE
+    {
+      std::lock_guard<std::mutex> lock(worker_mutex);
+      loads.push_back(task);
+      start();
+    }
+    worker_condition.notify_one();
+#else
+    job->sample.load(path, target_sample_rate);
+    job->ready = true;
+#endif
+  }
+
+  // Keep an eye on a job that's ready as it is
+  void watch(std::shared_ptr<PendingSample> job, std::shared_ptr<SamplePlayerHandoff> handoff)
+  {
+#ifndef METAMODULE
+    Task task;
+    task.job = job;
+    task.handoff = handoff;
+
+    {
+      std::lock_guard<std::mutex> lock(worker_mutex);
+      watched.push_back(task);
+      start();
+    }
+    worker_condition.notify_one();
+#endif
+  }
+
+#ifndef METAMODULE
+  // Called with the lock held
+  void start()
+  {
+    if(running || stopping) return;
+
+    // The last thread has finished, or is just about to
+    if(worker.joinable()) worker.join();
+
+    running = true;
+    worker = std::thread(&SamplePlayerWorker::run, this);
+  }
+
+  void run()
+  {
+    std::unique_lock<std::mutex> lock(worker_mutex);
+
+    while(! stopping)
+    {
+      if(! loads.empty())
+      {
+        Task task = loads.front();
+        loads.pop_front();
+        lock.unlock();
+
+        // Skip jobs that were replaced before they were started
+        if(task.handoff->jobs.getLatest() == task.job)
+        {
+          task.job->sample.load(task.path, task.target_sample_rate);
+          task.job->ready = true;
+        }
+
+        lock.lock();
+        watched.push_back(task);
+        continue;
+      }
+
+      if(watched.empty()) break;
+
+      std::list<Task> sweeping;
+      sweeping.swap(watched);
+      lock.unlock();
+
+      sweep(sweeping);
+
+      lock.lock();
+      watched.splice(watched.end(), sweeping);
+
+      if(! watched.empty())
+      {
+        worker_condition.wait_for(lock, sweep_interval, [this]() { return(stopping || ! loads.empty()); });
+      }
+    }
+
+    running = false;
+  }
+
+  void sweep(std::list<Task> &tasks)
+  {
+    for(auto it = tasks.begin(); it != tasks.end();)
+    {
+      if(it->job)
+      {
+        if(it->job->adopted)
+        {
+          it->job->sample.unload();
+          it->job.reset();
+        }
+        else if(it->handoff->jobs.getLatest() != it->job)
+        {
+          it->job.reset();
+        }
+      }
+
+      // Done once the job has been dealt with and the audio thread has moved
+      // past anything it replaced
+      if(! it->job && it->handoff->jobs.release())
+      {
+        it = tasks.erase(it);
+      }
+      else
+      {
+        ++it;
+      }
+    }
+  }
+#endif
+};
+
+//
+// BackgroundSampleLoad
+//
+// Loads a Sample that a module plays directly, rather than through a
+// SamplePlayer, without holding up the thread that asked for it.  load()
+// reads the sample's peaks from the PeakCache right away, so its waveform
+// can be drawn, and has the SamplePlayerWorker decode the audio.  The audio
+// thread calls adopt(), which swaps the audio into the sample once it's
+// ready.  Until then the sample isn't loaded, and the module stays quiet.
+//
+struct BackgroundSampleLoad
+{
+  std::shared_ptr<SamplePlayerHandoff> handoff = std::make_shared<SamplePlayerHandoff>();
+
+  // Called from the UI thread, or from dataFromJson
+  void load(Sample *sample, const std::string &path)
+  {
+    cancel();
+
+    // Stop the audio thread from reading the old audio before it's freed
+    sample->loaded = false;
+    sample->unload();
+    sample->setPath(path);
+    sample->loadPeaks(path);
+    sample->loading = true;
+
+    std::shared_ptr<PendingSample> job = std::make_shared<PendingSample>();
+    job->sample.analyze_on_load = sample->analyze_on_load;
+
+    handoff->jobs.publish(job);
+    SamplePlayerWorker::get().load(job, handoff, path, 0);
+  }
+
+  void cancel()
+  {
+    handoff->jobs.publish(nullptr);
+  }
+
+  // Called on the audio thread.  Returns true if the audio has just been
+  // swapped in.  As in SamplePlayer::adoptPendingSample(), only pointers
+  // are exchanged, so nothing is allocated or freed here.
+  bool adopt(Sample *sample)
+  {
+    PublishedValue<PendingSample> &jobs = handoff->jobs;
+
+    if(jobs.changed()) jobs.update();
+
+    PendingSample *job = jobs.get();
+    if(! job || job->swapped_in || ! job->ready) return(false);
+
+    job->swapped_in = true;
+
+    if(job->sample.loaded)
+    {
+      std::swap(sample->sample_audio_buffer, job->sample.sample_audio_buffer);
+
+      // The peaks that are already being drawn are left alone, unless they
+      // turned out not to match the audio
+      if(sample->peak_pyramid.frame_count != job->sample.sample_length)
+      {
+        std::swap(sample->peak_pyramid, job->sample.peak_pyramid);
+        std::swap(sample->analysis, job->sample.analysis);
+        std::swap(sample->slices, job->sample.slices);
+      }
+
+      sample->sample_rate = job->sample.sample_rate;
+      sample->channels = job->sample.channels;
+      sample->sample_length = job->sample.sample_length;
+      sample->loaded = true;
+    }
+
+    sample->loading = false;
+    job->adopted = true;
+
+    return(sample->loaded);
+  }
+};
+
 struct SamplePlayer
 {
   Sample sample;
   double playback_position = 0.0f;
   bool playing = false;
   double step_amount = 0.0;
+  bool resample_on_load = false;
+
+  // Jobs for the audio thread, from resampleInBackground() and swapSample()
+  std::shared_ptr<SamplePlayerHandoff> handoff = std::make_shared<SamplePlayerHandoff>();
+
+  // The previous sample, while it's being crossfaded out after a swap.  This
+  // is always the job that the audio thread is holding.
+  PendingSample *outgoing = nullptr;
+  double outgoing_position = 0.0;
+  double outgoing_ratio = 1.0;
+  float crossfade_amount = 1.0;
+  float crossfade_rate = 0.0;
 
   // Trigger restarts sample playback by setting the playback position and
   // setting the "playing" boolean to true.
@@ -60,6 +384,8 @@ struct SamplePlayer
 
   void getStereoOutput(float *left_output, float *right_output, unsigned int interpolation)
   {
+    adoptPendingSample();
+
     unsigned int sample_index = playback_position; // convert float to int
 
     if((playing == false) || (sample_index >= this->sample.size()) || (sample.loaded == false))
@@ -69,7 +395,9 @@ struct SamplePlayer
     }
     else
     {
-      if(interpolation == 0)
+      // When the sample is at the engine rate and pitch isn't being changed,
+      // the position never lands between samples, so skip the interpolation.
+      if(interpolation == 0 || playback_position == sample_index)
       {
         // Normal version, using sample index
         this->sample.read(sample_index, left_output, right_output);
@@ -80,6 +408,8 @@ struct SamplePlayer
         this->sample.readLI(playback_position, left_output, right_output);
       }
     }
+
+    if(outgoing) mixOutgoing(left_output, right_output);
   }
 
   // Parameters:
@@ -95,6 +425,7 @@ struct SamplePlayer
       double sample_increment = getSampleIncrement(pitch);
 
       playback_position += sample_increment;
+      if(outgoing) outgoing_position += sample_increment * outgoing_ratio;
 
       // If settings loop is greater than 0 and the sample position is past the
       // selected loop length, then loop.  Note:  If loop is set to 1, then
@@ -122,6 +453,7 @@ struct SamplePlayer
 
       // Step the playback position backward.
       playback_position -= sample_increment;
+      if(outgoing) outgoing_position -= sample_increment * outgoing_ratio;
 
       unsigned int sample_size = sample.size() * sample_end;
 
@@ -149,7 +481,12 @@ struct SamplePlayer
 
   bool loadSample(std::string path)
   {
-    if(sample.load(path))
+    // Any conversion still in progress was for the previous sample
+    cancelPendingSample();
+
+    uint32_t target_sample_rate = resample_on_load ? APP->engine->getSampleRate() : 0;
+
+    if(sample.load(path, target_sample_rate))
     {
       updateStepAmount();
       return(true);
@@ -162,6 +499,7 @@ struct SamplePlayer
 
   void releaseSample()
   {
+    cancelPendingSample();
     sample.unload();
     this->playback_position = 0.0f;
     this->playing = false;
@@ -192,11 +530,181 @@ struct SamplePlayer
   void updateSampleRate()
   {
     updateStepAmount();
+
+    if(resample_on_load && sample.loaded && (sample.sample_rate != APP->engine->getSampleRate()))
+    {
+      resampleInBackground(APP->engine->getSampleRate());
+    }
+  }
+
+  // Turning this on converts the loaded sample to the engine rate.  Turning
+  // it off brings back the sample at its original rate.
+  void setResampleOnLoad(bool resample_on_load)
+  {
+    if(this->resample_on_load == resample_on_load) return;
+
+    this->resample_on_load = resample_on_load;
+
+    if(sample.loaded)
+    {
+      resampleInBackground(resample_on_load ? APP->engine->getSampleRate() : 0);
+    }
+  }
+
+  //
+  // resampleInBackground
+  //
+  // Reload the current sample at _target_sample_rate_ (0 for the file's own
+  // rate) without interrupting playback.  This should be called from the UI
+  // thread or from onSampleRateChange, never from process().
+  //
+  void resampleInBackground(uint32_t target_sample_rate)
+  {
+    std::shared_ptr<PendingSample> job = std::make_shared<PendingSample>();
+    job->sample.analyze_on_load = sample.analyze_on_load;
+
+    handoff->jobs.publish(job);
+    SamplePlayerWorker::get().load(job, handoff, sample.path, target_sample_rate);
+  }
+
+  //
+  // swapSample
+  //
+  // Hand over a sample that's already been loaded, typically on another
+  // thread.  The audio thread swaps it in on its next call to
+  // getStereoOutput() and crossfades from the old sample over
+  // _crossfade_seconds_.  Like loadSample, this is called from the UI thread.
+  //
+  void swapSample(std::shared_ptr<PendingSample> job, float crossfade_seconds = 0.005)
+  {
+    cancelPendingSample();
+
+    // The names are strings, so they're set here rather than on the audio
+    // thread
+    sample.setPath(job->sample.path);
+
+    job->crossfade = true;
+    job->crossfade_frames = std::max(1.0f, crossfade_seconds * APP->engine->getSampleRate());
+    job->ready = true;
+
+    handoff->jobs.publish(job);
+    SamplePlayerWorker::get().watch(job, handoff);
+  }
+
+  void cancelPendingSample()
+  {
+    handoff->jobs.publish(nullptr);
+  }
+
+  // Called on the audio thread.  Swapping vectors only exchanges pointers, so
+  // nothing is allocated or freed here.
+  void adoptPendingSample()
+  {
+    PublishedValue<PendingSample> &jobs = handoff->jobs;
+
+    if(jobs.changed())
+    {
+      // The outgoing audio belongs to the job that update() is about to let
+      // go of
+      finishCrossfade();
+      jobs.update();
+    }
+
+    PendingSample *job = jobs.get();
+
+    // Nothing to do, this job has already been swapped in, or it isn't ready
+    // yet
+    if(! job || job->swapped_in || ! job->ready) return;
+
+    job->swapped_in = true;
+
+    if(job->crossfade && job->sample.loaded)
+    {
+      // Any earlier crossfade is cut short
+      finishCrossfade();
+
+      if(sample.loaded && playing)
+      {
+        outgoing = job;
+        outgoing_position = playback_position;
+        outgoing_ratio = (double) sample.sample_rate / (double) job->sample.sample_rate;
+        crossfade_amount = 0.0;
+        crossfade_rate = 1.0f / (float) job->crossfade_frames;
+      }
+
+      std::swap(sample.sample_audio_buffer, job->sample.sample_audio_buffer);
+      std::swap(sample.peak_pyramid, job->sample.peak_pyramid);
+      std::swap(sample.analysis, job->sample.analysis);
+      std::swap(sample.slices, job->sample.slices);
+      std::swap(sample.sample_rate, job->sample.sample_rate);
+      std::swap(sample.sample_length, job->sample.sample_length);
+      std::swap(sample.channels, job->sample.channels);
+      sample.loaded = true;
+
+      updateStepAmount();
+
+      // The old audio is still needed for the crossfade
+      if(outgoing) return;
+    }
+    else if(job->sample.loaded && sample.sample_rate > 0)
+    {
+      // Keep playing from the same point in time.  Rounding keeps the
+      // position on whole samples so the unity-pitch fast path still applies.
+      playback_position = std::round(playback_position * ((double) job->sample.sample_rate / (double) sample.sample_rate));
+
+      std::swap(sample.sample_audio_buffer, job->sample.sample_audio_buffer);
+      std::swap(sample.peak_pyramid, job->sample.peak_pyramid);
+      std::swap(sample.analysis, job->sample.analysis);
+      std::swap(sample.slices, job->sample.slices);
+      sample.sample_rate = job->sample.sample_rate;
+      sample.sample_length = job->sample.sample_length;
+      sample.channels = job->sample.channels;
+
+      updateStepAmount();
+    }
+
+    job->adopted = true;
+  }
+
+  // Called on the audio thread.  Reads the outgoing sample and fades from it
+  // into the audio that has already been read from the new one.
+  void mixOutgoing(float *left_output, float *right_output)
+  {
+    float outgoing_left = 0.0;
+    float outgoing_right = 0.0;
+
+    if(outgoing_position >= 0 && outgoing_position < outgoing->sample.size())
+    {
+      outgoing->sample.read(outgoing_position, &outgoing_left, &outgoing_right);
+    }
+
+    *left_output = (outgoing_left * (1.0f - crossfade_amount)) + (*left_output * crossfade_amount);
+    *right_output = (outgoing_right * (1.0f - crossfade_amount)) + (*right_output * crossfade_amount);
+
+    crossfade_amount += crossfade_rate;
+    if(crossfade_amount >= 1.0) finishCrossfade();
+  }
+
+  // Let go of the outgoing sample.  Its audio is freed by the
+  // SamplePlayerWorker.
+  void finishCrossfade()
+  {
+    if(! outgoing) return;
+
+    outgoing->adopted = true;
+    outgoing = nullptr;
+    crossfade_amount = 1.0;
   }
 
   void updateStepAmount()
   {
-    step_amount = (sample.sample_rate / APP->engine->getSampleRate());
+    updateStepAmount(APP->engine->getSampleRate());
+  }
+
+  // For threads where APP isn't available
+  void updateStepAmount(float engine_sample_rate)
+  {
+    step_amount = (sample.sample_rate / engine_sample_rate);
   }
 
   unsigned int getSampleRate()
@@ -211,6 +719,7 @@ struct SamplePlayer
 
   void initialize()
   {
+    cancelPendingSample();
     sample.unload();
     this->playback_position = 0.0f;
     this->playing = false;
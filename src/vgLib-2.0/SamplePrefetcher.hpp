@@ -0,0 +1,207 @@
+/*
+  SamplePrefetcher.hpp
+
+  Decodes samples on a background thread before they're asked for, so that a
+  module can switch to one of them instantly.  GrooveBox uses this to decode
+  the samples on either side of each track's current sample, which makes
+  stepping through a folder with the nudge buttons a simple buffer swap.
+
+  The prefetcher has a number of slots (one per track, for example).  Each
+  slot holds the list of paths that it would like to have ready.  Decoded
+  samples that no slot wants any more are freed by the worker thread.
+
+  A finished sample is handed out with take(), as a PendingSample that can be
+  passed straight to SamplePlayer::swapSample().  If the module analyzes its
+  samples, it sets _analyze_on_load_ so that prefetched samples are analyzed
+  too.
+
+  Threading:
+
+  - prefetch() and take() are called from the UI thread.
+  - All decoding and freeing of audio happens on the prefetcher's worker.
+
+  On the MetaModule, which has no worker thread, nothing is prefetched and
+  take() always returns nullptr, so callers fall back to loading directly.
+*/
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#ifndef METAMODULE
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif
+
+struct SamplePrefetcher
+{
+  struct Slot
+  {
+    std::vector<std::string> paths;
+    uint32_t target_sample_rate = 0;
+  };
+
+  struct Entry
+  {
+    std::shared_ptr<PendingSample> pending;
+    uint32_t target_sample_rate = 0;
+  };
+
+  std::vector<Slot> slots;
+  std::map<std::string, Entry> entries;
+  bool analyze_on_load = false;   // Set before the first prefetch()
+
+#ifndef METAMODULE
+  std::thread worker;
+  std::mutex worker_mutex;
+  std::condition_variable worker_condition;
+  bool running = false;
+  bool changed = false;
+#endif
+
+  SamplePrefetcher(unsigned int slot_count)
+  {
+    slots.resize(slot_count);
+  }
+
+  ~SamplePrefetcher()
+  {
+#ifndef METAMODULE
+    {
+      std::lock_guard<std::mutex> lock(worker_mutex);
+      running = false;
+    }
+    worker_condition.notify_one();
+    if (worker.joinable()) worker.join();
+#endif
+  }
+
+  //
+  // prefetch
+  //
+  // Replace the list of samples that _slot_ would like to have ready.  The
+  // samples are decoded at _target_sample_rate_ (0 for the file's own rate).
+  //
+  void prefetch(unsigned int slot, const std::vector<std::string> &paths, uint32_t target_sample_rate = 0)
+  {
+#ifndef METAMODULE
+    if (slot >= slots.size()) return;
+
+    {
+      std::lock_guard<std::mutex> lock(worker_mutex);
+
+      slots[slot].paths = paths;
+      slots[slot].target_sample_rate = target_sample_rate;
+      changed = true;
+
+      // The worker is only started the first time it's needed
+      if (! running)
+      {
+        running = true;
+        worker = std::thread(&SamplePrefetcher::run, this);
+      }
+    }
+
+    worker_condition.notify_one();
+#endif
+  }
+
+  //
+  // take
+  //
+  // Returns the decoded sample at _path_ and removes it from the prefetcher,
+  // or returns nullptr if it hasn't been decoded yet.
+  //
+  std::shared_ptr<PendingSample> take(const std::string &path, uint32_t target_sample_rate = 0)
+  {
+#ifndef METAMODULE
+    std::lock_guard<std::mutex> lock(worker_mutex);
+
+    auto found = entries.find(path);
+    if (found == entries.end() || found->second.target_sample_rate != target_sample_rate) return(nullptr);
+
+    std::shared_ptr<PendingSample> pending = found->second.pending;
+    entries.erase(found);
+
+    return(pending);
+#else
+    return(nullptr);
+#endif
+  }
+
+#ifndef METAMODULE
+  void run()
+  {
+    std::unique_lock<std::mutex> lock(worker_mutex);
+
+    while (running)
+    {
+      worker_condition.wait(lock, [this]() { return(! running || changed); });
+      if (! running) break;
+
+      changed = false;
+
+      // Gather everything that the slots want, keeping the order that each
+      // slot listed its paths in, and drop anything they don't want.
+      std::vector<std::pair<std::string, uint32_t>> wanted;
+
+      for (const Slot &slot : slots)
+      {
+        for (const std::string &path : slot.paths) wanted.push_back(std::make_pair(path, slot.target_sample_rate));
+      }
+
+      std::vector<std::shared_ptr<PendingSample>> unwanted;
+
+      for (auto it = entries.begin(); it != entries.end();)
+      {
+        auto want = std::find(wanted.begin(), wanted.end(), std::make_pair(it->first, it->second.target_sample_rate));
+
+        if (want == wanted.end())
+        {
+          unwanted.push_back(it->second.pending);
+          it = entries.erase(it);
+        }
+        else
+        {
+          ++it;
+        }
+      }
+
+      // Free the unwanted audio without holding up the UI thread
+      lock.unlock();
+      unwanted.clear();
+      lock.lock();
+
+      // Decode whatever isn't ready yet.  If the slots change part way
+      // through, start over with the new list.
+      for (auto &want : wanted)
+      {
+        if (! running || changed) break;
+        if (entries.count(want.first)) continue;
+
+        std::string path = want.first;
+        uint32_t target_sample_rate = want.second;
+
+        lock.unlock();
+        std::shared_ptr<PendingSample> pending = std::make_shared<PendingSample>();
+        pending->sample.analyze_on_load = analyze_on_load;
+        bool loaded = pending->sample.load(path, target_sample_rate);
+        lock.lock();
+
+        if (loaded)
+        {
+          Entry entry;
+          entry.pending = pending;
+          entry.target_sample_rate = target_sample_rate;
+          entries[path] = entry;
+        }
+      }
+    }
+  }
+#endif
+};
@@ -0,0 +1,455 @@
+/*
+  SequenceFile.hpp
+
+  Loads the text files of sequences used by OnePoint and OneZero.  Each line
+  of the file is one sequence.  OnePoint's lines are numbers separated by
+  commas (or spaces), and OneZero's are strings of 1s and 0s.
+
+  Files with hundreds of thousands of lines are common, so:
+
+  - The sequences are stored in a SequenceTable: every value in one array,
+    plus the offset where each sequence starts.  That's two allocations
+    instead of one per line.
+  - The parser streams the file through a fixed buffer and converts numbers
+    itself, without splitting the file into lines or tokens first.  Lines
+    can be any length, and a value that isn't a number is skipped rather
+    than throwing.  Blank lines are skipped too.
+  - The parsed table is cached in a binary file in the Rack user folder,
+    keyed on the file's path, size and modification time, like the
+    PeakCache.  Loading an unchanged file again reads the offsets and values
+    straight into the table, two freads, with no parsing at all.
+  - A SequenceLoader does all of that on a background thread and hands the
+    finished table to the audio thread, so loading a patch doesn't stall.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <sys/stat.h>
+
+#include "PublishedValue.hpp"
+
+#ifndef METAMODULE
+#include <thread>
+#include <mutex>
+#include <functional>
+#endif
+
+#define SEQUENCE_CACHE_FOLDER_NAME "voxglitch_sequence_cache"
+
+template <typename T>
+struct SequenceTable
+{
+  std::vector<T> values;
+  std::vector<uint32_t> offsets {0};   // Sequence _i_ is values[offsets[i]] up to values[offsets[i + 1]]
+
+  // The number of sequences
+  unsigned int size() const
+  {
+    return(offsets.size() - 1);
+  }
+
+  bool empty() const
+  {
+    return(size() == 0);
+  }
+
+  // The number of values in sequence _row_
+  unsigned int length(unsigned int row) const
+  {
+    return(offsets[row + 1] - offsets[row]);
+  }
+
+  T at(unsigned int row, unsigned int step) const
+  {
+    return(values[offsets[row] + step]);
+  }
+
+  void clear()
+  {
+    values.clear();
+    offsets.assign(1, 0);
+  }
+
+  // Ends the current sequence, unless it's empty
+  void endRow()
+  {
+    if(values.size() > offsets.back()) offsets.push_back(values.size());
+  }
+};
+
+struct SequenceFile
+{
+  enum Format
+  {
+    NUMBERS,   // Comma separated numbers, read into floats
+    BITS       // 1s and 0s, read into uint8_t
+  };
+
+  static const uint32_t MAGIC = 0x51535756; // "VWSQ"
+  static const uint32_t VERSION = 1;
+  static const size_t BUFFER_SIZE = 64 * 1024;
+  static const size_t MAXIMUM_TOKEN_LENGTH = 63;
+
+  //
+  // load(path, format, table)
+  //
+  // Fills _table_ from the cache if it's there, otherwise parses the file
+  // and writes the cache.  Returns false if the file couldn't be read.
+  //
+  template <typename T>
+  static bool load(const std::string &path, Format format, SequenceTable<T> *table)
+  {
+    table->clear();
+
+    if(readCache(path, format, table)) return(true);
+
+    FILE *file = fopen(path.c_str(), "rb");
+    if(! file) return(false);
+
+    parse(file, table);
+    fclose(file);
+
+    writeCache(path, format, table);
+    return(true);
+  }
+
+  static void parse(FILE *file, SequenceTable<float> *table)
+  {
+    std::vector<char> buffer(BUFFER_SIZE);
+    char token[MAXIMUM_TOKEN_LENGTH + 1];
+    size_t token_length = 0;
+    size_t count = 0;
+
+    while((count = fread(buffer.data(), 1, BUFFER_SIZE, file)) > 0)
+    {
+      for(size_t i = 0; i < count; i++)
+      {
+        char c = buffer[i];
+
+        if(c == ',' || c == '\n' || c == '\r' || c == ' ' || c == '\t')
+        {
+          if(token_length > 0)
+          {
+            float value;
+            if(parseNumber(token, token + token_length, &value)) table->values.push_back(value);
+            token_length = 0;
+          }
+
+          if(c == '\n') table->endRow();
+        }
+        else if(token_length < MAXIMUM_TOKEN_LENGTH)
+        {
+          token[token_length++] = c;
+        }
+      }
+    }
+
+    float value;
+    if(token_length > 0 && parseNumber(token, token + token_length, &value)) table->values.push_back(value);
+    table->endRow();
+  }
+
+  static void parse(FILE *file, SequenceTable<uint8_t> *table)
+  {
+    std::vector<char> buffer(BUFFER_SIZE);
+    size_t count = 0;
+
+    while((count = fread(buffer.data(), 1, BUFFER_SIZE, file)) > 0)
+    {
+      for(size_t i = 0; i < count; i++)
+      {
+        char c = buffer[i];
+
+        if(c == '1') table->values.push_back(1);
+        else if(c == '0') table->values.push_back(0);
+        else if(c == '\n') table->endRow();
+      }
+    }
+
+    table->endRow();
+  }
+
+  //
+  // parseNumber(begin, end, value)
+  //
+  // Converts a decimal number, with an optional sign, fraction and exponent,
+  // such as "-1.25" or "3e-2".  Returns false if the text isn't a number.
+  //
+  static bool parseNumber(const char *begin, const char *end, float *value)
+  {
+    static const double powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18 };
+
+    const char *c = begin;
+    bool negative = false;
+
+    if(c < end && (*c == '-' || *c == '+')) negative = (*c++ == '-');
+
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    int digits = 0;
+
+    for(; c < end && *c >= '0' && *c <= '9'; c++, digits++)
+    {
+      if(mantissa < 100000000000000000ULL) mantissa = (mantissa * 10) + (*c - '0');
+      else exponent++;
+    }
+
+    if(c < end && *c == '.')
+    {
+      for(c++; c < end && *c >= '0' && *c <= '9'; c++, digits++)
+      {
+        if(mantissa < 100000000000000000ULL)
+        {
+          mantissa = (mantissa * 10) + (*c - '0');
+          exponent--;
+        }
+      }
+    }
+
+    if(digits == 0) return(false);
+
+    if(c < end && (*c == 'e' || *c == 'E'))
+    {
+      c++;
+      bool negative_exponent = false;
+      if(c < end && (*c == '-' || *c == '+')) negative_exponent = (*c++ == '-');
+
+      int written_exponent = 0;
+      if(c >= end || *c < '0' || *c > '9') return(false);
+      for(; c < end && *c >= '0' && *c <= '9'; c++)
+      {
+        if(written_exponent < 1000) written_exponent = (written_exponent * 10) + (*c - '0');
+      }
+
+      exponent += negative_exponent ? -written_exponent : written_exponent;
+    }
+
+    if(c != end) return(false);
+
+    double result = mantissa;
+    int magnitude = exponent < 0 ? -exponent : exponent;
+
+    while(magnitude > 0)
+    {
+      int step = magnitude > 18 ? 18 : magnitude;
+      result = (exponent < 0) ? result / powers[step] : result * powers[step];
+      magnitude -= step;
+    }
+
+    *value = negative ? -result : result;
+    return(true);
+  }
+
+  //
+  // getCachePath
+  //
+  // Returns the path of the cache file for _path_, or an empty string if the
+  // file can't be found.  Like the PeakCache, the name is a 64 bit FNV-1a
+  // hash of the path, size and modification time.
+  //
+  static std::string getCachePath(const std::string &path, Format format)
+  {
+    struct stat file_info;
+    if(stat(path.c_str(), &file_info) != 0) return("");
+
+    std::string key = path + "|" + std::to_string((long long) file_info.st_size) + "|" + std::to_string((long long) file_info.st_mtime) + "|" + std::to_string((int) format);
+
+    uint64_t hash = 14695981039346656037ULL;
+    for(unsigned char c : key)
+    {
+      hash ^= c;
+      hash *= 1099511628211ULL;
+    }
+
+    char filename[32];
+    snprintf(filename, sizeof(filename), "%016llx.seq", (unsigned long long) hash);
+
+    return(system::join(asset::user(SEQUENCE_CACHE_FOLDER_NAME), filename));
+  }
+
+  template <typename T>
+  static bool readCache(const std::string &path, Format format, SequenceTable<T> *table)
+  {
+    std::string cache_path = getCachePath(path, format);
+    if(cache_path == "") return(false);
+
+    FILE *file = fopen(cache_path.c_str(), "rb");
+    if(! file) return(false);
+
+    int64_t file_size = 0;
+    if(fseek(file, 0, SEEK_END) == 0) file_size = ftell(file);
+    rewind(file);
+
+    // magic, version, value size, sequence count, value count
+    uint32_t header[5] = {0, 0, 0, 0, 0};
+
+    bool success = (fread(header, sizeof(uint32_t), 5, file) == 5)
+      && (header[0] == MAGIC) && (header[1] == VERSION) && (header[2] == sizeof(T));
+
+    // The counts have to account for the file exactly before anything is
+    // allocated from them
+    uint64_t expected_size = (5 * sizeof(uint32_t)) + (((uint64_t) header[3] + 1) * sizeof(uint32_t)) + ((uint64_t) header[4] * sizeof(T));
+    success = success && (file_size == (int64_t) expected_size);
+
+    if(success)
+    {
+      table->offsets.resize((uint64_t) header[3] + 1);
+      table->values.resize(header[4]);
+
+      success = (fread(table->offsets.data(), sizeof(uint32_t), table->offsets.size(), file) == table->offsets.size())
+        && (fread(table->values.data(), sizeof(T), table->values.size(), file) == table->values.size())
+        && (table->offsets.front() == 0) && (table->offsets.back() == header[4]);
+
+      // Every sequence has to start where the last one ended, or after it,
+      // so that at() stays inside _values_
+      for(size_t i = 1; i < table->offsets.size() && success; i++)
+      {
+        success = (table->offsets[i] >= table->offsets[i - 1]);
+      }
+    }
+
+    fclose(file);
+
+    if(! success) table->clear();
+    return(success);
+  }
+
+  template <typename T>
+  static bool writeCache(const std::string &path, Format format, SequenceTable<T> *table)
+  {
+    std::string cache_path = getCachePath(path, format);
+    if(cache_path == "") return(false);
+
+    system::createDirectories(asset::user(SEQUENCE_CACHE_FOLDER_NAME));
+
+    std::string temp_path = getTempPath(cache_path);
+    FILE *file = fopen(temp_path.c_str(), "wb");
+    if(! file) return(false);
+
+    uint32_t header[5] = { MAGIC, VERSION, (uint32_t) sizeof(T), table->size(), (uint32_t) table->values.size() };
+
+    bool success = (fwrite(header, sizeof(uint32_t), 5, file) == 5)
+      && (fwrite(table->offsets.data(), sizeof(uint32_t), table->offsets.size(), file) == table->offsets.size())
+      && (fwrite(table->values.data(), sizeof(T), table->values.size(), file) == table->values.size());
+
+    fclose(file);
+
+    if(success)
+    {
+      std::remove(cache_path.c_str());
+      success = (std::rename(temp_path.c_str(), cache_path.c_str()) == 0);
+    }
+
+    if(! success) std::remove(temp_path.c_str());
+
+    return(success);
+  }
+
+  // Two modules can load the same file at once, so each write goes to its
+  // own temporary file before being renamed into place
+  static std::string getTempPath(const std::string &path)
+  {
+    static std::atomic<unsigned int> counter(0);
+
+#ifndef METAMODULE
+    size_t thread_hash = std::hash<std::thread::id>()(std::this_thread::get_id());
+    return(path + "." + std::to_string((unsigned long long) thread_hash) + "." + std::to_string(counter++) + ".tmp");
+#else
+    return(path + "." + std::to_string(counter++) + ".tmp");
+#endif
+  }
+};
+
+//
+// SequenceLoader
+//
+// Loads a SequenceFile on a background thread and hands the table to the
+// audio thread.  The table is published through a PublishedValue, the same
+// way the MarkerSchedule publishes markers: the audio thread calls update()
+// and picks up the new table, and replaced tables are never freed on the
+// audio thread.
+//
+// The state shared with the loading thread lives in its own shared_ptr, so
+// a load that finishes after the module has been removed is harmless.
+//
+template <typename T>
+struct SequenceLoader
+{
+  struct Shared
+  {
+    // Starts out with an empty table, so get() is never null
+    PublishedValue<const SequenceTable<T>> table { std::make_shared<SequenceTable<T>>() };
+    std::atomic<uint32_t> latest_request {0};
+    std::atomic<unsigned int> size {0};
+#ifndef METAMODULE
+    std::mutex request_mutex;   // Keeps the check for a newer request and the publish together
+#endif
+  };
+
+  std::shared_ptr<Shared> shared;
+  SequenceFile::Format format;
+
+  SequenceLoader(SequenceFile::Format format) : format(format)
+  {
+    shared = std::make_shared<Shared>();
+  }
+
+  // Called from the UI thread, or from dataFromJson
+  void load(const std::string &path)
+  {
+    std::shared_ptr<Shared> state = shared;
+    SequenceFile::Format file_format = format;
+    uint32_t request = ++state->latest_request;
+
+#ifndef METAMODULE
+    std::thread([state, path, file_format, request]() {
+      finish(state, path, file_format, request);
+    }).detach();
+#else
+    finish(state, path, file_format, request);
+#endif
+  }
+
+  // Audio thread.  Returns true when a newly loaded table has been picked up.
+  bool update()
+  {
+    return(shared->table.update());
+  }
+
+  // Audio thread.  Never null.
+  const SequenceTable<T> *get()
+  {
+    return(shared->table.get());
+  }
+
+  // The number of sequences in the most recently loaded table.  Safe to
+  // call from any thread.
+  unsigned int size()
+  {
+    return(shared->size.load());
+  }
+
+  private:
+
+  static void finish(std::shared_ptr<Shared> state, std::string path, SequenceFile::Format file_format, uint32_t request)
+  {
+    std::shared_ptr<SequenceTable<T>> loaded = std::make_shared<SequenceTable<T>>();
+    SequenceFile::load(path, file_format, loaded.get());
+
+#ifndef METAMODULE
+    std::lock_guard<std::mutex> lock(state->request_mutex);
+#endif
+
+    // A newer load has been asked for since this one started
+    if(request != state->latest_request.load()) return;
+
+    state->size = loaded->size();
+    state->table.publish(loaded);
+  }
+};
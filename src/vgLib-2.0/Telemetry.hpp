@@ -0,0 +1,92 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+//
+// TelemetryChannel
+//
+// Carries a small value, such as a playhead position or a level, from the
+// audio thread to the UI.
+//
+// The audio thread calls process() every sample.  Only one call in every
+// _interval_ actually publishes, so most samples cost just a counter.  Call
+// publish() directly when a change has to show up right away, such as after
+// a reset.  Widgets call read() from step(), once per frame, and always get
+// the latest complete value.
+//
+// The value is stored in one slot, guarded by a sequence number (a
+// "seqlock").  The writer never waits.  A reader that overlaps a write sees
+// the sequence number change and tries again.  The slot is made of atomic
+// words, so a torn read is thrown away rather than being undefined.
+//
+// T must be trivially copyable.  There should be a single writer.
+//
+
+template <typename T>
+struct TelemetryChannel
+{
+    static_assert(std::is_trivially_copyable<T>::value, "TelemetryChannel values must be trivially copyable");
+
+    static const unsigned int DEFAULT_INTERVAL = 64;   // samples
+    static const size_t WORDS = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+    std::atomic<uint32_t> sequence{0};
+    std::atomic<uint32_t> words[WORDS];
+
+    // Audio thread
+    unsigned int interval = DEFAULT_INTERVAL;
+    unsigned int counter = 0;
+
+    TelemetryChannel()
+    {
+        for (size_t i = 0; i < WORDS; i++) words[i].store(0, std::memory_order_relaxed);
+    }
+
+    // Audio thread.  Publishes once every _interval_ calls.
+    void process(const T &value)
+    {
+        if (++counter < interval) return;
+        counter = 0;
+        publish(value);
+    }
+
+    // Audio thread.  Publishes now.
+    void publish(const T &value)
+    {
+        uint32_t buffer[WORDS] = {};
+        std::memcpy(buffer, &value, sizeof(T));
+
+        uint32_t start = sequence.load(std::memory_order_relaxed);
+        sequence.store(start + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (size_t i = 0; i < WORDS; i++) words[i].store(buffer[i], std::memory_order_relaxed);
+
+        sequence.store(start + 2, std::memory_order_release);
+    }
+
+    // UI thread.  Copies the latest value into _value_ and returns true if
+    // anything has been published yet.
+    bool read(T &value) const
+    {
+        uint32_t buffer[WORDS];
+        uint32_t before;
+        uint32_t after;
+
+        do
+        {
+            before = sequence.load(std::memory_order_acquire);
+            for (size_t i = 0; i < WORDS; i++) buffer[i] = words[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = sequence.load(std::memory_order_relaxed);
+        }
+        while ((before & 1) || (before != after));
+
+        if (before == 0) return(false);
+
+        std::memcpy(&value, buffer, sizeof(T));
+        return(true);
+    }
+};
@@ -0,0 +1,165 @@
+/*
+  TempoEstimator.hpp
+
+  Works out how many beats long a sample is, and where its beats fall, from
+  the onset envelope that the OnsetDetector computes at load time.  Like the
+  onset detection, this runs once on the loading thread and is cached on
+  disk with the rest of the SampleAnalysis.
+
+  Samples played by the breakbeat modules are loops, so the beat length is
+  assumed to divide the sample evenly.  Every whole number of beats that
+  gives a tempo between MINIMUM_BPM and MAXIMUM_BPM is a candidate:
+
+  1. Each candidate's beat length is scored by the circular autocorrelation
+     of the envelope at that lag and its multiples, up to half the loop (a
+     comb filter), so that a steady pulse scores higher than a single
+     repeat.  Lags past half the loop would only repeat the same values.
+  2. Scores are weighted by how plausible the tempo is, using a log-normal
+     curve centred on PREFERRED_BPM.  Doubling or halving the beat length
+     often scores almost the same, and this settles it the way a listener
+     usually would.
+  3. The beat grid's phase is the offset, within one beat, where the
+     envelope summed over every beat is largest.  The envelope is squared
+     first, so that a few strong hits outweigh many weak ones.  The onset
+     detector can't see a hit right at the start of the sample, so a phase
+     in the second half of a beat is taken to mean the first beat is at the
+     very start, and the offset is 0.  A phase in the first half is kept.
+     That happens when a sample is trimmed a little early, or starts with a
+     pickup.
+
+  If the sample is too short to hold a beat at MAXIMUM_BPM, or has no onsets
+  at all, the beat count is left at 0, meaning "unknown".
+*/
+
+#pragma once
+
+#include <vector>
+#include <cmath>
+
+#include "SampleAnalysis.hpp"
+
+struct TempoEstimator
+{
+  static constexpr float MINIMUM_BPM = 60.0f;
+  static constexpr float MAXIMUM_BPM = 200.0f;
+  static constexpr float PREFERRED_BPM = 125.0f;
+  static constexpr float PREFERENCE_WIDTH = 0.8f;   // Standard deviation, in octaves
+  static const unsigned int MAXIMUM_BEATS = 64;
+
+  //
+  // estimate
+  //
+  // _envelope_ has one value per _hop_size_ frames.  _length_ is the sample
+  // length in frames.  Fills in the beat fields of _analysis_.
+  //
+  static void estimate(const std::vector<float> &envelope, unsigned int hop_size, unsigned int length, float sample_rate, SampleAnalysis *analysis)
+  {
+    analysis->beats = 0;
+    analysis->beat_length = 0.0;
+    analysis->beat_offset = 0.0;
+
+    size_t frame_count = envelope.size();
+    if(frame_count < 4 || hop_size == 0 || length == 0 || sample_rate <= 0) return;
+
+    // Work with the envelope's variation around its mean
+    double mean = 0.0;
+    for(float value : envelope) mean += value;
+    mean /= frame_count;
+
+    std::vector<float> centered(frame_count);
+    for(size_t i = 0; i < frame_count; i++) centered[i] = envelope[i] - mean;
+
+    double seconds = length / sample_rate;
+    unsigned int fewest_beats = std::max(1.0, std::ceil(seconds * MINIMUM_BPM / 60.0));
+    unsigned int most_beats = std::min((double) MAXIMUM_BEATS, std::floor(seconds * MAXIMUM_BPM / 60.0));
+
+    double best_score = 0.0;
+    unsigned int best_beats = 0;
+
+    for(unsigned int beats = fewest_beats; beats <= most_beats; beats++)
+    {
+      double lag = (double) frame_count / beats;
+      double score = 0.0;
+      unsigned int harmonics = std::max(1u, beats / 2);
+
+      for(unsigned int harmonic = 1; harmonic <= harmonics; harmonic++)
+      {
+        score += autocorrelation(centered, lag * harmonic);
+      }
+      score /= harmonics;
+
+      double bpm = beats * 60.0 / seconds;
+      double octaves = std::log2(bpm / PREFERRED_BPM) / PREFERENCE_WIDTH;
+      score *= std::exp(-0.5 * octaves * octaves);
+
+      if(score > best_score)
+      {
+        best_score = score;
+        best_beats = beats;
+      }
+    }
+
+    if(best_beats == 0) return;
+
+    analysis->beats = best_beats;
+    analysis->beat_length = (float) length / best_beats;
+
+    double phase = findPhase(envelope, analysis->beat_length / hop_size, best_beats) * hop_size;
+    if(phase >= analysis->beat_length / 2.0) phase = 0.0;
+    analysis->beat_offset = phase;
+  }
+
+  private:
+
+  // Circular autocorrelation at a fractional lag, normalized by length
+  static double autocorrelation(const std::vector<float> &values, double lag)
+  {
+    size_t count = values.size();
+    lag = std::fmod(lag, (double) count);
+
+    size_t whole = (size_t) lag;
+    double fraction = lag - whole;
+    double sum = 0.0;
+
+    for(size_t i = 0; i < count; i++)
+    {
+      float a = values[(i + whole) % count];
+      float b = values[(i + whole + 1) % count];
+      sum += values[i] * (a + ((b - a) * fraction));
+    }
+
+    return(sum / count);
+  }
+
+  // Returns the offset, in envelope frames and less than one beat, where the
+  // envelope summed over every beat is largest
+  static double findPhase(const std::vector<float> &envelope, double beat_frames, unsigned int beats)
+  {
+    size_t count = envelope.size();
+    unsigned int offsets = std::max(1.0, std::floor(beat_frames));
+
+    double best_sum = -1.0;
+    unsigned int best_offset = 0;
+
+    for(unsigned int offset = 0; offset < offsets; offset++)
+    {
+      double sum = 0.0;
+
+      // An onset can land a hop either side of the exact grid position
+      for(unsigned int beat = 0; beat < beats; beat++)
+      {
+        size_t frame = (size_t) std::lround(offset + (beat * beat_frames)) % count;
+        float value = std::max(envelope[frame], std::max(envelope[(frame + 1) % count], envelope[(frame + count - 1) % count]));
+        sum += value * value;
+      }
+
+      if(sum > best_sum)
+      {
+        best_sum = sum;
+        best_offset = offset;
+      }
+    }
+
+    return(best_offset);
+  }
+};
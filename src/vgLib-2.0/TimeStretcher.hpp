@@ -0,0 +1,355 @@
+/*
+  TimeStretcher.hpp
+
+  Plays a sample at its original pitch while following a read position that
+  moves at any speed.  A breakbeat module that plays its loop at the patch's
+  tempo reads through the sample faster or slower than 1 frame per sample,
+  which also changes the pitch.  Passing that read position here instead
+  keeps the pitch and only changes the tempo.
+
+  It works by WSOLA (waveform similarity overlap-add).  Playback is made of
+  grains, two at a time.  Each grain lasts 2 * HOP_SIZE output samples and
+  is played forward (or backward) at the sample's own rate, with a raised
+  cosine fade in and fade out, and a new one starts every HOP_SIZE samples,
+  so the fades always add up to 1.  A sample recorded at a different rate
+  than the engine's is read at the ratio of the two rates, with Hermite
+  interpolation, so it keeps its pitch too.  A new grain should start at
+  the current read position.  To avoid the phase cancellation that would
+  cause, it starts at whichever point within SEARCH_RADIUS of the read
+  position best lines up with what the previous grain is playing.
+
+  The search is the only costly part, so it's kept to a fixed amount of
+  work.  It's coarse (every SEARCH_STEP frames, comparing every
+  CORRELATION_STEP frames), then refined around the best coarse match, for
+  SEARCH_CANDIDATES candidates in all.  The search isn't done all at once
+  when the grain starts.  It begins SEARCH_CANDIDATES samples earlier, aimed
+  at where the read position and the playing grain will be by then, and
+  scores one candidate per sample.  No sample costs more than one
+  correlation of CORRELATION_LENGTH / CORRELATION_STEP points.  If the read
+  position strays from the prediction by more than SEARCH_STEP frames, the
+  grain starts unaligned at the read position instead.
+
+  When the read position jumps, such as when a breakbeat module jumps to a
+  new slice, waiting for the next grain would make the jump late.  Instead
+  a grain starts right away, exactly at the new position and at full
+  volume, and the grain that was playing fades out over JUMP_FADE frames.
+  The older grain is dropped, so there are never more than two.
+*/
+
+#pragma once
+
+#include <cmath>
+
+struct TimeStretcher
+{
+  static const unsigned int HOP_SIZE = 1024;            // frames
+  static const unsigned int SEARCH_RADIUS = 384;        // frames
+  static const unsigned int SEARCH_STEP = 8;            // frames
+  static const unsigned int CORRELATION_LENGTH = 512;   // frames
+  static const unsigned int CORRELATION_STEP = 4;       // frames
+  static const unsigned int JUMP_FADE = 64;             // frames
+  static constexpr double JUMP_DISTANCE = 32.0;         // A change in read position bigger than this is a jump
+
+  static const unsigned int COARSE_CANDIDATES = ((2 * SEARCH_RADIUS) / SEARCH_STEP) + 1;
+  static const unsigned int FINE_CANDIDATES = 2 * (SEARCH_STEP - 1);
+  static const unsigned int SEARCH_CANDIDATES = 1 + COARSE_CANDIDATES + FINE_CANDIDATES;   // The target itself comes first
+
+  struct Grain
+  {
+    double start = 0.0;
+    int direction = 1;
+    double rate = 1.0;         // Frames per output sample
+    unsigned int age = 0;      // Output samples
+    unsigned int fade_in = HOP_SIZE;
+    unsigned int fade_out_start = HOP_SIZE;
+    unsigned int length = 0;   // 0 when the grain isn't playing
+    float release_gain = 1.0f;
+
+    // Where the grain will be reading _ahead_ samples from now
+    double position(unsigned int ahead = 0)
+    {
+      return(start + ((double) (age + ahead) * rate * direction));
+    }
+  };
+
+  // A search for the next grain's start, one candidate per sample
+  struct Search
+  {
+    bool active = false;
+    long target = 0;           // The predicted read position
+    long reference = 0;        // Where the playing grain is predicted to be
+    int direction = 1;
+    unsigned int candidate = 0;
+    long best = 0;
+    float best_score = 0.0f;
+    long coarse = 0;
+
+    bool finished()
+    {
+      return(active && candidate == SEARCH_CANDIDATES);
+    }
+  };
+
+  Grain grains[2];
+  unsigned int newest = 0;
+  unsigned int hop_counter = 0;
+  Search search;
+
+  Sample *previous_sample = nullptr;
+  double previous_position = 0.0;
+  int direction = 1;
+  bool started = false;
+
+  float rise[HOP_SIZE];   // Raised cosine fade in.  The fade out is 1 - rise.
+
+  TimeStretcher()
+  {
+    for(unsigned int i = 0; i < HOP_SIZE; i++)
+    {
+      float x = (float) i / HOP_SIZE;
+      rise[i] = 0.5f - (0.5f * std::cos(M_PI * x));
+    }
+  }
+
+  void reset()
+  {
+    grains[0].length = 0;
+    grains[1].length = 0;
+    hop_counter = 0;
+    search.active = false;
+    started = false;
+    previous_sample = nullptr;
+  }
+
+  //
+  // process(sample, position, rate, left, right)
+  //
+  // Call once per sample with the position that a plain sample player would
+  // be reading from.  _rate_ is the sample's rate divided by the engine's,
+  // the number of frames a grain moves forward per sample.  Writes the
+  // stretched audio to _left_ and _right_.
+  //
+  void process(Sample *sample, double position, double rate, float *left, float *right)
+  {
+    *left = 0.0f;
+    *right = 0.0f;
+
+    if(sample->size() == 0) return;
+
+    // A new sample has nothing to crossfade from
+    if(sample != previous_sample) reset();
+
+    // The direction only changes when the read position moves steadily the
+    // other way, not when it jumps backward
+    double movement = position - previous_position;
+    bool jumped = (! started || std::fabs(movement) > JUMP_DISTANCE);
+    if(! jumped && movement != 0.0) direction = (movement < 0.0) ? -1 : 1;
+
+    if(jumped)
+    {
+      jump(position, rate);
+    }
+    else if(hop_counter == 0)
+    {
+      startGrain(position, rate);
+    }
+
+    // Get the next grain's start ready in time for it
+    if(hop_counter == SEARCH_CANDIDATES) beginSearch(position, jumped ? 0.0 : movement);
+    if(search.active && ! search.finished()) searchStep(sample);
+
+    started = true;
+    previous_sample = sample;
+    previous_position = position;
+    hop_counter--;
+
+    for(unsigned int i = 0; i < 2; i++)
+    {
+      Grain &grain = grains[i];
+      if(grain.length == 0) continue;
+
+      float gain = grainGain(grain);
+      double frame = grain.position();
+
+      if(frame >= 0.0)
+      {
+        float grain_left = 0.0f;
+        float grain_right = 0.0f;
+        sample->readHermite(frame, &grain_left, &grain_right);
+
+        *left += grain_left * gain;
+        *right += grain_right * gain;
+      }
+
+      if(++grain.age >= grain.length) grain.length = 0;
+    }
+  }
+
+  private:
+
+  // Starts a grain exactly at _position_, without a fade in, and fades out
+  // whatever was playing
+  void jump(double position, double rate)
+  {
+    Grain &playing = grains[newest];
+
+    if(started && playing.length > 0)
+    {
+      playing.release_gain = grainGain(playing);
+      playing.fade_out_start = playing.age;
+      playing.length = playing.age + JUMP_FADE;
+    }
+
+    newest = 1 - newest;
+
+    Grain &grain = grains[newest];
+    grain.start = position;
+    grain.direction = direction;
+    grain.rate = rate;
+    grain.age = 0;
+    grain.fade_in = 0;
+    grain.fade_out_start = HOP_SIZE;
+    grain.length = 2 * HOP_SIZE;
+    grain.release_gain = 1.0f;
+
+    hop_counter = HOP_SIZE;
+    search.active = false;
+  }
+
+  // Starts the next overlapping grain near _position_, where the search
+  // found the best match if it's still valid
+  void startGrain(double position, double rate)
+  {
+    long target = std::lround(position);
+    Grain &playing = grains[newest];
+
+    bool aligned = search.finished()
+      && (playing.length > 0)
+      && (playing.direction == direction)
+      && (search.direction == direction)
+      && (std::labs(target - search.target) <= (long) SEARCH_STEP);
+
+    if(aligned) target = search.best;
+    search.active = false;
+
+    newest = 1 - newest;
+
+    Grain &grain = grains[newest];
+    grain.start = target;
+    grain.direction = direction;
+    grain.rate = rate;
+    grain.age = 0;
+    grain.fade_in = HOP_SIZE;
+    grain.fade_out_start = HOP_SIZE;
+    grain.length = 2 * HOP_SIZE;
+    grain.release_gain = 1.0f;
+
+    hop_counter = HOP_SIZE;
+  }
+
+  float grainGain(Grain &grain)
+  {
+    if(grain.age < grain.fade_in)
+    {
+      return(rise[(grain.age * HOP_SIZE) / grain.fade_in]);
+    }
+
+    if(grain.age >= grain.fade_out_start)
+    {
+      unsigned int fade_length = grain.length - grain.fade_out_start;
+      unsigned int index = ((grain.age - grain.fade_out_start) * HOP_SIZE) / fade_length;
+      if(index >= HOP_SIZE) return(0.0f);
+      return((1.0f - rise[index]) * grain.release_gain);
+    }
+
+    return(1.0f);
+  }
+
+  //
+  // beginSearch
+  //
+  // Sets up the search for the start, within SEARCH_RADIUS of where the read
+  // position will be when the next grain starts, whose audio looks most like
+  // the audio the playing grain will carry on from.  Both are predicted
+  // hop_counter samples ahead, with the read position moving _movement_
+  // frames per sample.
+  //
+  void beginSearch(double position, double movement)
+  {
+    Grain &playing = grains[newest];
+
+    search.active = (playing.length > 0);
+    if(! search.active) return;
+
+    search.target = std::lround(position + (movement * hop_counter));
+    search.reference = std::lround(playing.position(hop_counter));
+    search.direction = direction;
+    search.candidate = 0;
+  }
+
+  // Scores the next candidate: first the target itself, then the coarse
+  // grid, then every frame around the best coarse match
+  void searchStep(Sample *sample)
+  {
+    long start;
+
+    if(search.candidate == 0)
+    {
+      start = search.target;
+    }
+    else if(search.candidate <= COARSE_CANDIDATES)
+    {
+      start = search.target - (long) SEARCH_RADIUS + ((long) (search.candidate - 1) * SEARCH_STEP);
+    }
+    else
+    {
+      if(search.candidate == COARSE_CANDIDATES + 1) search.coarse = search.best;
+
+      // -7 to -1, then 1 to 7
+      long offset = (long) (search.candidate - COARSE_CANDIDATES) - (long) SEARCH_STEP;
+      if(offset >= 0) offset++;
+      start = search.coarse + offset;
+    }
+
+    float score = similarity(sample, start, search.reference, search.direction);
+
+    if(search.candidate == 0 || score > search.best_score)
+    {
+      search.best_score = score;
+      search.best = start;
+    }
+
+    search.candidate++;
+  }
+
+  // Normalized cross-correlation of the mono audio starting at _candidate_
+  // with the audio starting at _reference_
+  float similarity(Sample *sample, long candidate, long reference, int direction)
+  {
+    float sum = 0.0f;
+    float energy = 0.0f;
+
+    for(unsigned int i = 0; i < CORRELATION_LENGTH; i += CORRELATION_STEP)
+    {
+      long offset = (long) i * direction;
+      float a = mono(sample, candidate + offset);
+      float b = mono(sample, reference + offset);
+
+      sum += a * b;
+      energy += a * a;
+    }
+
+    if(energy <= 0.0f) return(0.0f);
+    return(sum / std::sqrt(energy));
+  }
+
+  float mono(Sample *sample, long frame)
+  {
+    if(frame < 0) return(0.0f);
+
+    float left = 0.0f;
+    float right = 0.0f;
+    sample->read((unsigned int) frame, &left, &right);
+    return(left + right);
+  }
+};
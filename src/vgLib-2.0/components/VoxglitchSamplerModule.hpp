@@ -1,6 +1,7 @@
 struct VoxglitchSamplerModule : VoxglitchModule
 {
     unsigned int interpolation = 1;
+    bool resample_on_load = false;
     float sample_rate = 44100;
     std::string samples_root_dir = "";
 
@@ -12,6 +13,7 @@ struct VoxglitchSamplerModule : VoxglitchModule
     void saveSamplerData(json_t *root)
     {
         json_object_set_new(root, "interpolation", json_integer(interpolation));
+        json_object_set_new(root, "resample_on_load", json_boolean(resample_on_load));
         json_object_set_new(root, "samples_root_dir", json_string(samples_root_dir.c_str()));
     }
 
@@ -22,6 +24,11 @@ struct VoxglitchSamplerModule : VoxglitchModule
         if (interpolation_json)
             interpolation = json_integer_value(interpolation_json);
 
+        // Load resample on load setting
+        json_t *resample_on_load_json = json_object_get(root, ("resample_on_load"));
+        if (resample_on_load_json)
+            setResampleOnLoad(json_boolean_value(resample_on_load_json));
+
         // Load root directory
         json_t *samples_root_dir_json = json_object_get(root, ("samples_root_dir"));
         if (samples_root_dir_json)
@@ -68,6 +75,13 @@ struct VoxglitchSamplerModule : VoxglitchModule
     }
 #endif
 
+    // Modules that support converting samples to the engine's sample rate
+    // override this to pass the setting on to their sample players.
+    virtual void setResampleOnLoad(bool resample_on_load)
+    {
+        this->resample_on_load = resample_on_load;
+    }
+
     void setSamplesRootDirectory(std::string samples_root_directory)
     {
         this->samples_root_dir = samples_root_directory;
@@ -41,5 +41,15 @@ namespace vgLib_v2
                 return menu;
             }
         };
+
+        struct ResampleOnLoadMenuItem : MenuItem
+        {
+            VoxglitchSamplerModule *module;
+
+            void onAction(const event::Action &e) override
+            {
+                module->setResampleOnLoad(! module->resample_on_load);
+            }
+        };
     };
 } // namespace vgLib_v2
\ No newline at end of file
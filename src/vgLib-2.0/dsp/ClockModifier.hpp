@@ -21,7 +21,9 @@ private:
 
 public:
 
-  bool clock(double time_now, float rate_factor)
+  // When _period_ is given, such as from a ClockTracker, it's used to space
+  // out multiplied clocks instead of the time since the last clock.
+  bool clock(double time_now, float rate_factor, double period = 0.0)
   {
     if(previous_clock_time == 0.0)
     {
@@ -33,6 +35,8 @@ public:
       previous_clock_time = time_now;
     }
 
+    if(period > 0.0) time_between_clocks_ms = period;
+
     this->rate_factor = rate_factor;
 
     if(rate_factor == 0.0f) return(true);
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <cmath>
+
+//
+// ClockTracker
+//
+// Follows an incoming clock and reports a steady period, tempo and phase,
+// even when the clock jitters (MIDI clock, humanized sequencers, clocks
+// derived from audio).  Measuring the time between the two most recent
+// pulses passes every bit of that jitter straight through to playback speed.
+//
+// This is a second order phase-locked loop, in the form of a delay-locked
+// loop on the pulse times.  Each pulse is compared with the time the loop
+// predicted for it.  A fraction of the error corrects the phase, and a
+// smaller fraction corrects the period:
+//
+//   error = pulse_time - predicted
+//   predicted += period + (b * error)
+//   period += c * error
+//
+// b and c come from the loop's bandwidth, a fraction of the clock rate.  A
+// low bandwidth smooths out more jitter but takes longer to settle on a new
+// tempo.  The default is critically damped, and settles within about ten
+// pulses.
+//
+// Real tempo changes shouldn't wait that long.  When pulses keep arriving
+// at an interval more than _change_threshold_ away from the tracked period,
+// and those intervals agree with each other, the loop jumps straight to the
+// new period.  A single odd pulse, such as a dropped or doubled clock, only
+// realigns the phase.  If no pulses arrive for a few periods, the clock is
+// taken to have stopped, and the next pulse restarts the phase without
+// being measured.
+//
+// getPhase() runs from 0 at one predicted pulse to 1 at the next, and moves
+// every sample, so it's much finer than the pulse's own sample position.
+//
+
+struct ClockTracker
+{
+  static constexpr float DEFAULT_BANDWIDTH = 0.05f;        // Fraction of the clock rate
+  static constexpr float DEFAULT_CHANGE_THRESHOLD = 0.10f; // Fraction of the period
+  static const unsigned int DEFAULT_CHANGE_CONFIRMATIONS = 2;
+  static const unsigned int STOPPED_AFTER_PERIODS = 4;
+
+  double time = 0.0;
+  double last_pulse = -1.0;     // Actual time of the last pulse, or -1 if there's been none
+  double previous_predicted = 0.0;
+  double predicted = 0.0;
+  double period = 0.0;          // seconds, or 0 if unknown
+
+  double candidate_period = 0.0;
+  unsigned int mismatches = 0;
+  bool tempo_changed = false;
+
+  float bandwidth = DEFAULT_BANDWIDTH;
+  float change_threshold = DEFAULT_CHANGE_THRESHOLD;
+  unsigned int change_confirmations = DEFAULT_CHANGE_CONFIRMATIONS;
+  double phase_gain = 0.0;
+  double period_gain = 0.0;
+
+  ClockTracker()
+  {
+    setBandwidth(DEFAULT_BANDWIDTH);
+  }
+
+  // Call once per sample.  _pulse_ is true on the sample where the clock
+  // input triggered.
+  void process(double sample_time, bool pulse)
+  {
+    time += sample_time;
+    tempo_changed = false;
+
+    if(last_pulse >= 0.0 && period > 0.0 && (time - last_pulse) > (period * STOPPED_AFTER_PERIODS))
+    {
+      resync();
+    }
+
+    if(! pulse) return;
+
+    // The first pulse after starting only sets the phase
+    if(last_pulse < 0.0)
+    {
+      last_pulse = time;
+      align(time);
+      return;
+    }
+
+    double interval = time - last_pulse;
+    last_pulse = time;
+
+    if(interval <= 0.0) return;
+
+    if(period == 0.0)
+    {
+      period = interval;
+      align(time);
+      return;
+    }
+
+    if(std::fabs(interval - period) > (period * change_threshold))
+    {
+      if(mismatches > 0 && std::fabs(interval - candidate_period) <= (candidate_period * change_threshold))
+      {
+        mismatches++;
+      }
+      else
+      {
+        mismatches = 1;
+      }
+      candidate_period = interval;
+
+      if(mismatches >= change_confirmations)
+      {
+        period = interval;
+        tempo_changed = true;
+        mismatches = 0;
+      }
+
+      align(time);
+      return;
+    }
+
+    mismatches = 0;
+
+    double error = time - predicted;
+    previous_predicted = predicted;
+    predicted += period + (phase_gain * error);
+    period += period_gain * error;
+  }
+
+  // Forgets the timing of the last pulse, but not the period, so the next
+  // pulse restarts the phase.  Use this after a reset.
+  void resync()
+  {
+    last_pulse = -1.0;
+    mismatches = 0;
+  }
+
+  void reset()
+  {
+    resync();
+    period = 0.0;
+    previous_predicted = 0.0;
+    predicted = 0.0;
+  }
+
+  //
+  // setBandwidth(bandwidth)
+  //
+  // _bandwidth_ is a fraction of the clock rate, from about 0.01 (heavy
+  // smoothing) to 0.25 (follows almost every pulse).
+  //
+  void setBandwidth(float new_bandwidth)
+  {
+    bandwidth = new_bandwidth;
+
+    double omega = 2.0 * M_PI * bandwidth;
+    phase_gain = std::sqrt(2.0) * omega;
+    period_gain = omega * omega;
+  }
+
+  // Pulses more than _threshold_ (a fraction of the period) early or late,
+  // _confirmations_ times in a row, are taken as a new tempo
+  void setTempoChangeDetection(float threshold, unsigned int confirmations)
+  {
+    change_threshold = threshold;
+    change_confirmations = confirmations > 0 ? confirmations : 1;
+  }
+
+  // The smoothed time between pulses, in seconds, or 0 until two pulses
+  // have arrived
+  double getPeriod()
+  {
+    return(period);
+  }
+
+  // The tempo, or 0 if it isn't known yet
+  double getBPM(double pulses_per_beat = 1.0)
+  {
+    if(period <= 0.0) return(0.0);
+    return(60.0 / (period * pulses_per_beat));
+  }
+
+  // How far through the current period, from 0 to 1.  Holds at 1 if the
+  // next pulse is late.
+  double getPhase()
+  {
+    double length = predicted - previous_predicted;
+    if(period <= 0.0 || length <= 0.0) return(0.0);
+
+    double phase = (time - previous_predicted) / length;
+    if(phase < 0.0) return(0.0);
+    if(phase > 1.0) return(1.0);
+    return(phase);
+  }
+
+  // True while pulses are arriving and the period is known
+  bool isLocked()
+  {
+    return(period > 0.0 && last_pulse >= 0.0);
+  }
+
+  // True for the sample where a tempo change was detected
+  bool tempoChanged()
+  {
+    return(tempo_changed);
+  }
+
+  private:
+
+  void align(double pulse_time)
+  {
+    previous_predicted = pulse_time;
+    predicted = pulse_time + period;
+  }
+};
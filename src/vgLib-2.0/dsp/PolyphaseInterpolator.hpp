@@ -0,0 +1,134 @@
+#pragma once
+
+//
+// PolyphaseInterpolator
+//
+// Streaming, band-limited rate conversion for signals that are generated at
+// their own rate, such as a bytebeat equation running at 8kHz, and need to
+// be played at the engine's sample rate.
+//
+// It uses the same windowed sinc table as PolyphaseResampler, designed for a
+// cutoff just below the generated signal's Nyquist frequency.  Each call to
+// process() produces one output sample, asking the generator for new input
+// samples as they're needed.  The input rate can change from one sample to
+// the next without redesigning the filter, which allows pitch modulation.
+//
+// The input rate should be no higher than the output rate.  Above that, the
+// filter no longer removes everything above the output's Nyquist frequency
+// and some aliasing comes back.
+//
+// The output is delayed by PolyphaseResampler::BASE_HALF_WIDTH input samples.
+//
+// process() can also be done in three steps, with advance(), push() and
+// output().  This lets a polyphonic module find out which voices need new
+// input samples, generate them all together, and then push them.
+//
+
+#include "PolyphaseResampler.hpp"
+
+struct PolyphaseInterpolator
+{
+  static const int HISTORY_SIZE = 64;   // Must be at least the filter's taps
+
+  const PolyphaseResampler &filter = getFilter();
+
+  // The input history is written twice, HISTORY_SIZE apart, so that the
+  // newest _taps_ samples can always be read as one contiguous block.
+  float history[HISTORY_SIZE * 2] = {};
+  int write_index = 0;
+
+  // Position between the two newest input samples, from 0 to 1
+  double phase = 0.0;
+
+  // Every interpolator uses the same filter, so they share one table
+  static const PolyphaseResampler &getFilter()
+  {
+    static PolyphaseResampler filter = designFilter();
+    return(filter);
+  }
+
+  static PolyphaseResampler designFilter()
+  {
+    PolyphaseResampler filter;
+    filter.design(1.0);
+    return(filter);
+  }
+
+  void push(float sample)
+  {
+    history[write_index] = sample;
+    history[write_index + HISTORY_SIZE] = sample;
+    write_index = (write_index + 1) % HISTORY_SIZE;
+  }
+
+  void reset()
+  {
+    for (int i = 0; i < HISTORY_SIZE * 2; i++) history[i] = 0.0f;
+    phase = 0.0;
+  }
+
+  //
+  // process
+  //
+  // Produce the next output sample.  _step_ is the input rate divided by the
+  // output rate.  _generator_ is called with no arguments whenever a new
+  // input sample is needed, and should return it.
+  //
+  template <typename Generator>
+  float process(double step, Generator &&generator)
+  {
+    unsigned int needed = advance(step);
+    for (unsigned int i = 0; i < needed; i++) push(generator());
+    return(output());
+  }
+
+  // Move the output position forward by _step_ and return the number of new
+  // input samples that must be pushed before calling output().
+  unsigned int advance(double step)
+  {
+    phase += step;
+
+    unsigned int needed = 0;
+
+    while (phase >= 1.0)
+    {
+      phase -= 1.0;
+      needed++;
+    }
+
+    return(needed);
+  }
+
+  float output()
+  {
+    int taps = filter.taps;
+
+    // In double, like PolyphaseResampler::process.  A phase just under 1.0
+    // rounds up to exactly 1.0 as a float, which would pick the row past the
+    // last branch.
+    double position = phase * PolyphaseResampler::PHASES;
+    int branch = (int) position;
+    if (branch > PolyphaseResampler::PHASES - 1) branch = PolyphaseResampler::PHASES - 1;
+    float blend = (float) (position - branch);
+
+    // The window holds the newest _taps_ samples, oldest first.  The output
+    // is _phase_ samples past the middle of the window, which is exactly how
+    // PolyphaseResampler lays out its taps.
+    const float *coefficients_a = &filter.table[branch * taps];
+    const float *coefficients_b = &filter.table[(branch + 1) * taps];
+    const float *source = &history[write_index + HISTORY_SIZE - taps];
+
+    // Filtering with both branches and blending the two results is the same
+    // as blending the coefficients first, but costs less per tap.
+    float sum_a = 0.0f;
+    float sum_b = 0.0f;
+
+    for (int tap = 0; tap < taps; tap++)
+    {
+      sum_a += source[tap] * coefficients_a[tap];
+      sum_b += source[tap] * coefficients_b[tap];
+    }
+
+    return(sum_a + ((sum_b - sum_a) * blend));
+  }
+};
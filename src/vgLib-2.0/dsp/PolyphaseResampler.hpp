@@ -0,0 +1,147 @@
+#pragma once
+
+//
+// PolyphaseResampler
+//
+// Offline sample rate conversion using a Kaiser-windowed sinc filter stored as
+// a table of polyphase branches.  Fractional positions between branches are
+// linearly interpolated, which keeps the table small while leaving the
+// interpolation error well below the filter's stopband.
+//
+// This is meant for converting whole samples at load time, not for running
+// on the audio thread.  When downsampling, the cutoff is lowered to the new
+// Nyquist frequency and the filter is lengthened to match, so that the
+// result doesn't alias.
+//
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+struct PolyphaseResampler
+{
+  static const int PHASES = 256;        // Number of polyphase branches
+  static const int BASE_HALF_WIDTH = 16; // Zero crossings on each side at unity cutoff
+
+  double kaiser_beta = 8.0;            // About 80dB of stopband attenuation
+  double passband = 0.95;              // Fraction of the lower Nyquist to keep
+
+  std::vector<float> table;
+  int half_width = BASE_HALF_WIDTH;
+  int taps = BASE_HALF_WIDTH * 2;
+
+  // Modified Bessel function of the first kind, order zero
+  static double besselI0(double x)
+  {
+    double sum = 1.0;
+    double term = 1.0;
+    double quarter_x_squared = (x * x) / 4.0;
+
+    for (int k = 1; k < 32; k++)
+    {
+      term *= quarter_x_squared / (double)(k * k);
+      sum += term;
+      if (term < (sum * 1e-12)) break;
+    }
+
+    return(sum);
+  }
+
+  // Build the filter table for converting with the given ratio of
+  // output rate to input rate.
+  void design(double ratio)
+  {
+    double cutoff = std::min(1.0, ratio) * passband;
+
+    half_width = (int) std::ceil(BASE_HALF_WIDTH / std::min(1.0, ratio));
+    taps = half_width * 2;
+
+    table.assign((PHASES + 1) * taps, 0.0f);
+
+    const double pi = 3.14159265358979323846;
+    double window_denominator = besselI0(kaiser_beta);
+
+    for (int phase = 0; phase <= PHASES; phase++)
+    {
+      double fraction = (double) phase / (double) PHASES;
+
+      for (int tap = 0; tap < taps; tap++)
+      {
+        // Distance, in input samples, from the output position to this tap
+        double x = (double)(tap - half_width + 1) - fraction;
+        double window_position = x / (double) half_width;
+
+        double window = 0.0;
+        if (std::abs(window_position) < 1.0)
+        {
+          window = besselI0(kaiser_beta * std::sqrt(1.0 - (window_position * window_position))) / window_denominator;
+        }
+
+        double sinc = (x == 0.0) ? 1.0 : std::sin(pi * cutoff * x) / (pi * cutoff * x);
+
+        table[(phase * taps) + tap] = (float)(cutoff * sinc * window);
+      }
+    }
+  }
+
+  //
+  // process
+  //
+  // Resample _input_ (recorded at input_rate) into _output_ (at output_rate).
+  // The output vector is resized to fit.
+  //
+  template <typename T>
+  void process(const std::vector<T> &input, std::vector<T> &output, double input_rate, double output_rate)
+  {
+    double ratio = output_rate / input_rate;
+    int input_length = input.size();
+    int output_length = (int)(input_length * ratio);
+
+    output.assign(std::max(output_length, 0), (T) 0);
+    if (input_length == 0 || output_length <= 0) return;
+
+    design(ratio);
+
+    double step = 1.0 / ratio;
+
+    for (int n = 0; n < output_length; n++)
+    {
+      double position = n * step;
+      int index = (int) position;
+      double phase = (position - index) * PHASES;
+      int branch = (int) phase;
+      float blend = (float)(phase - branch);
+
+      const float *coefficients_a = &table[branch * taps];
+      const float *coefficients_b = &table[(branch + 1) * taps];
+
+      int first = index - half_width + 1;
+      float sum = 0.0f;
+
+      if (first >= 0 && (first + taps) <= input_length)
+      {
+        // Fast path, entirely inside the input
+        const T *source = &input[first];
+        for (int tap = 0; tap < taps; tap++)
+        {
+          float coefficient = coefficients_a[tap] + ((coefficients_b[tap] - coefficients_a[tap]) * blend);
+          sum += (float) source[tap] * coefficient;
+        }
+      }
+      else
+      {
+        // Near the edges, treat anything outside the input as silence
+        for (int tap = 0; tap < taps; tap++)
+        {
+          int source_index = first + tap;
+          if (source_index < 0 || source_index >= input_length) continue;
+
+          float coefficient = coefficients_a[tap] + ((coefficients_b[tap] - coefficients_a[tap]) * blend);
+          sum += (float) input[source_index] * coefficient;
+        }
+      }
+
+      output[n] = (T) sum;
+    }
+  }
+};
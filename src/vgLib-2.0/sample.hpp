@@ -1,6 +1,11 @@
 #pragma once
 
 #include "AudioFile.h"
+#include "PeakPyramid.hpp"
+#include "SampleAnalysis.hpp"
+#include "OnsetDetector.hpp"
+#include "TempoEstimator.hpp"
+#include "PeakCache.hpp"
 
 struct SampleAudioBuffer
 {
@@ -63,6 +68,40 @@ struct SampleAudioBuffer
       *right_audio_ptr = right_buffer[index] + ((right_buffer[index + 1] - right_buffer[index]) * distance);
     }
   }
+
+  // Read sample using 4-point cubic Hermite interpolation.  This is smoother
+  // than linear interpolation when the read speed keeps changing, such as
+  // while scrubbing.  Samples past either end are read as the end sample.
+  void readHermite(double position, float *left_audio_ptr, float *right_audio_ptr)
+  {
+    size_t buf_size = left_buffer.size();
+
+    if(position < 0 || buf_size == 0 || position >= buf_size)
+    {
+      *left_audio_ptr = 0;
+      *right_audio_ptr = 0;
+      return;
+    }
+
+    unsigned int index = std::floor(position);
+    float distance = position - (double) index;
+    unsigned int last = buf_size - 1;
+
+    unsigned int i0 = (index > 0) ? index - 1 : 0;
+    unsigned int i2 = std::min(index + 1, last);
+    unsigned int i3 = std::min(index + 2, last);
+
+    *left_audio_ptr = hermite(left_buffer[i0], left_buffer[index], left_buffer[i2], left_buffer[i3], distance);
+    *right_audio_ptr = hermite(right_buffer[i0], right_buffer[index], right_buffer[i2], right_buffer[i3], distance);
+  }
+
+  static float hermite(float y0, float y1, float y2, float y3, float x)
+  {
+    float c1 = 0.5f * (y2 - y0);
+    float c2 = y0 - (2.5f * y1) + (2.0f * y2) - (0.5f * y3);
+    float c3 = (0.5f * (y3 - y0)) + (1.5f * (y1 - y2));
+    return(((((c3 * x) + c2) * x) + c1) * x + y1);
+  }
 };
 
 struct Sample
@@ -79,6 +118,10 @@ struct Sample
   float sample_rate = 44100.0;                // This is the sample rate in which the sample was recorded
   unsigned int channels = 0;
   AudioFile<float> audioFile;                 // For loading samples and saving samples
+  PeakPyramid peak_pyramid;                   // Waveform summary used by the waveform displays
+  SampleAnalysis analysis;                    // Facts about the sample, cached on disk with the peak pyramid
+  SliceTable slices;                          // Transients in the sample, also cached with the peak pyramid
+  bool analyze_on_load = false;               // Set by modules that use the transients and beat grid
 
   Sample()
   {
@@ -100,7 +143,9 @@ struct Sample
     sample_audio_buffer.clear();
   }
 
-  bool load(const std::string& path)
+  // If target_sample_rate is non-zero, the audio is converted to that rate
+  // as it's loaded, and sample_rate will report the new rate.
+  bool load(const std::string& path, uint32_t target_sample_rate = 0)
   {
     // Set loading flags
     this->loading = true;
@@ -112,11 +157,18 @@ struct Sample
 
     printf("path: %s\n", path.c_str());
 
+    // If this file has been seen before, its waveform can be drawn from the
+    // cache while the audio is decoded
+    bool cached = loadPeaks(path, target_sample_rate);
+
     // Load the audio file
-    if(! audioFile.load(path))
+    if(! audioFile.load(path, target_sample_rate))
     {
       
       printf("audioFile.load(path) failed\n");
+      peak_pyramid.clear();
+      analysis.clear();
+      slices.clear();
       this->loading = false;
       this->loaded = false;
       return(false);
@@ -160,10 +212,32 @@ struct Sample
     // Store sample length and file information to this object for the rest
     // of the patch to reference.
     this->sample_length = sample_audio_buffer.size();
-    this->filename = system::getFilename(path);
-    this->display_name = filename;
-    this->display_name.erase(this->display_name.length()-4); // remove the .wav extension
-    this->path = path;
+
+    // Summarize the waveform once here so that displays never have to
+    // rescan the audio, no matter how far they zoom in or out.  If this
+    // exact file has been seen before at this rate, the summary came from
+    // the cache.  The same goes for the transients.
+    //
+    // Finding the transients and the beat grid takes an FFT over the whole
+    // sample, so it's only done for modules that ask for it.  Only complete
+    // entries are written to the cache, so any module can use what it finds
+    // there.
+    if(! cached || (analysis.frame_count != this->sample_length))
+    {
+      peak_pyramid.build(sample_audio_buffer.left_buffer, sample_audio_buffer.right_buffer);
+
+      if(analyze_on_load)
+      {
+        analyze();
+        PeakCache::write(path, target_sample_rate, &peak_pyramid, &analysis, &slices);
+      }
+      else
+      {
+        summarize();
+      }
+    }
+
+    setPath(path);
 
     this->loading = false;
     this->loaded = true;
@@ -179,6 +253,61 @@ struct Sample
     return(this->loaded);
   }
 
+  //
+  // loadPeaks
+  //
+  // Fetch the peak pyramid, analysis and transients for a sample from the
+  // PeakCache without decoding the audio, so that its waveform can be drawn
+  // before the audio has been loaded.  Returns false if the sample hasn't
+  // been cached at _target_sample_rate_ yet.
+  //
+  bool loadPeaks(const std::string& path, uint32_t target_sample_rate = 0)
+  {
+    return(PeakCache::read(path, target_sample_rate, &peak_pyramid, &analysis, &slices));
+  }
+
+  // Set the path, along with the names shown for it
+  void setPath(const std::string& path)
+  {
+    this->filename = system::getFilename(path);
+    this->display_name = filename;
+    if(this->display_name.length() >= 4) this->display_name.erase(this->display_name.length()-4); // remove the .wav extension
+    this->path = path;
+  }
+
+  // Fill in the parts of the analysis that come straight from the peak
+  // pyramid.  The transients and beat grid are left empty.
+  void summarize()
+  {
+    analysis.clear();
+    slices.clear();
+
+    analysis.frame_count = this->sample_length;
+    analysis.sample_rate = this->sample_rate;
+    analysis.channels = this->channels;
+
+    if(peak_pyramid.isBuilt())
+    {
+      PeakBin &summary = peak_pyramid.levels.back()[0];
+      analysis.peak = std::max(std::abs(summary.min), std::abs(summary.max));
+      analysis.rms = std::sqrt(summary.mean_square);
+    }
+  }
+
+  void analyze()
+  {
+    summarize();
+
+    OnsetDetector onset_detector;
+    onset_detector.detect(sample_audio_buffer.left_buffer, sample_audio_buffer.right_buffer, this->sample_rate, &slices);
+
+    // The beat grid comes from the same onset envelope.  Its phase is only
+    // as fine as the analysis frames, so it's moved onto a transient if
+    // there's one within a frame.
+    TempoEstimator::estimate(onset_detector.envelope, OnsetDetector::HOP_SIZE, this->sample_length, this->sample_rate, &analysis);
+    if(analysis.beats > 0) analysis.beat_offset = slices.snap(analysis.beat_offset, OnsetDetector::FRAME_SIZE);
+  }
+
   // Where to put recording code and how to save it?
   void initialize_recording()
   {
@@ -189,6 +318,9 @@ struct Sample
 
     // Also clear out the sample audio information
     sample_audio_buffer.clear();
+    peak_pyramid.clear();
+    analysis.clear();
+    slices.clear();
     sample_length = 0;
   }
 
@@ -228,6 +360,30 @@ struct Sample
     sample_audio_buffer.readLI(position, left_audio_ptr, right_audio_ptr);
   }
 
+  // Read sample, applying cubic Hermite interpolation
+  void readHermite(double position, float *left_audio_ptr, float *right_audio_ptr)
+  {
+    sample_audio_buffer.readHermite(position, left_audio_ptr, right_audio_ptr);
+  }
+
+  // Read the min, max, and mean square of the audio between two positions
+  PeakBin readPeaks(unsigned int start, unsigned int end)
+  {
+    return(peak_pyramid.query(sample_audio_buffer.left_buffer, sample_audio_buffer.right_buffer, start, end));
+  }
+
+  bool hasPeaks()
+  {
+    return(peak_pyramid.isBuilt());
+  }
+
+  // How many frames a waveform display should span.  While the audio is
+  // still loading, this comes from the peaks, if they were in the cache.
+  unsigned int getDisplayLength()
+  {
+    return(loaded ? sample_length : peak_pyramid.frame_count);
+  }
+
   unsigned int size()
   {
     return(sample_length);
@@ -246,6 +402,9 @@ struct Sample
   void unload()
   {
     this->sample_audio_buffer.clear();
+    this->peak_pyramid.clear();
+    this->analysis.clear();
+    this->slices.clear();
     this->sample_length = 0;
     this->filename = "";
     this->display_name = "";
@@ -1,4 +1,5 @@
 #include <iomanip>
+#include <array>
 
 namespace vgLib_v2
 {
@@ -28,7 +29,13 @@ namespace vgLib_v2
         double unipolar_default_value = 0.0;
         double bipolar_default_value = 0.0;
 
-        std::vector<double> sequence;
+        // The steps are stored in a fixed-size array of floats, so copying,
+        // shifting and randomizing are plain loops over one block of memory.
+        // Only the first _length_ steps are in use.
+        static const unsigned int MAX_STEPS = 32;
+
+        std::array<float, MAX_STEPS> sequence;
+        unsigned int length = 0;
         bool sample_and_hold = false;
         Polarity polarity = UNIPOLAR;
         unsigned int snap_division = 0;
@@ -38,32 +45,20 @@ namespace vgLib_v2
         // constructor
         VoltageSequencer(unsigned int sequence_length = 32, float default_value = 0.0)
         {
-            sequence.assign(sequence_length, default_value);
+            assign(sequence_length, default_value);
         }
 
-        // Sets the size of the vector and initializes it with "value"
+        // Sets the number of steps, up to MAX_STEPS, and initializes them
+        // with "value"
         void assign(unsigned int length, double value)
         {
-            sequence.assign(length, value);
-        }
-
-        // Returns the 'raw' output from the sequencer, which ranges from 0 to 1.
-        // To get the value with the selected range applied, see getOutput()
-        double getValue(int index)
-        {
-            return sequence[index];
-        }
-
-        // Same as GetValue(int index), but if no index is provided, returns the value at the current playback position.
-        double getValue()
-        {
-            return getValue(getPlaybackPosition());
+            this->length = (length < MAX_STEPS) ? length : MAX_STEPS;
+            sequence.fill(value);
         }
 
-        void setValue(int index, double value)
+        // Clamps _value_ to the 0 to 1 range and applies the snap division
+        float quantize(double value)
         {
-            float old_value = sequence[index];
-
             // clamp voltage to be within range
             if (value < 0.0)
             {
@@ -76,20 +71,40 @@ namespace vgLib_v2
 
             if (snap_division > 0)
             {
-                sequence[index] = round(value * snap_division) / snap_division;
+                return round(value * snap_division) / snap_division;
             }
             else
             {
-                sequence[index] = value;
+                return value;
             }
+        }
+
+        // Returns the 'raw' output from the sequencer, which ranges from 0 to 1.
+        // To get the value with the selected range applied, see getOutput()
+        double getValue(int index)
+        {
+            return sequence[index];
+        }
+
+        // Same as GetValue(int index), but if no index is provided, returns the value at the current playback position.
+        double getValue()
+        {
+            return getValue(getPlaybackPosition());
+        }
+
+        void setValue(int index, double value)
+        {
+            float old_value = sequence[index];
+
+            sequence[index] = quantize(value);
 
             // Record the action in the history manager
-            history_manager.recordAction(index, old_value, value);
+            history_manager.recordAction(index, old_value, sequence[index]);
         }
 
         void fill(double value)
         {
-            sequence.assign(sequence.size(), value);
+            sequence.fill(value);
         }
 
         void fill()
@@ -137,21 +152,23 @@ namespace vgLib_v2
 
         void shiftLeftInWindow()
         {
-            double temp = sequence[this->window_start];
+            float temp = sequence[this->window_start];
+
             for (int i = this->window_start; i < this->window_end; i++)
             {
-                this->setValue(i, this->getValue(i + 1));
+                sequence[i] = sequence[i + 1];
             }
+
             sequence[this->window_end] = temp;
         }
 
         void shiftRightInWindow()
         {
-            double temp = sequence[this->window_end];
+            float temp = sequence[this->window_end];
 
             for (int i = this->window_end; i > window_start; i--)
             {
-                this->setValue(i, this->getValue(i - 1));
+                sequence[i] = sequence[i - 1];
             }
 
             sequence[window_start] = temp;
@@ -168,7 +185,9 @@ namespace vgLib_v2
 
             for (int i = window_start; i <= this->window_end; i++)
             {
-                this->setValue(i, rand() / double(RAND_MAX));
+                float old_value = sequence[i];
+                sequence[i] = quantize(rand() / double(RAND_MAX));
+                history_manager.recordAction(i, old_value, sequence[i]);
             }
 
             history_manager.endSession();
@@ -222,7 +241,7 @@ namespace vgLib_v2
 
             while (i < j)
             {
-                double temp = sequence[i];
+                float temp = sequence[i];
                 sequence[i] = sequence[j];
                 sequence[j] = temp;
                 i++;
@@ -239,7 +258,7 @@ namespace vgLib_v2
             for (int i = window_start; i <= this->window_end; i++)
             {
                 int j = rand() % (this->window_end - this->window_start + 1) + this->window_start;
-                double temp = sequence[i];
+                float temp = sequence[i];
                 sequence[i] = sequence[j];
                 sequence[j] = temp;
             }
@@ -275,7 +294,7 @@ namespace vgLib_v2
         {
             // this->sample_and_hold = false;
             // this->polarity = UNIPOLAR;
-            sequence.assign(sequence.size(), getDefault());
+            sequence.fill(getDefault());
 
             // Call base class initialize
             Sequencer::initialize();
@@ -283,44 +302,18 @@ namespace vgLib_v2
 
         void undo()
         {
-            if (history_manager.undo_stack.empty())
-            {
-                return;
-            }
-
-            // Get the last session from the undo stack
-            Session session = history_manager.undo_stack.top();
-            history_manager.undo_stack.pop();
-
-            // Add the session to the redo stack
-            history_manager.redo_stack.push(session);
-
-            // Process the actions in reverse order
-            for (auto action = session.getActions().rbegin(); action != session.getActions().rend(); ++action)
-            {
-                sequence[action->index] = action->oldValue;
-            }
+            // The actions are processed in reverse order
+            history_manager.undo([this](const Action &action) {
+                if (action.index < (int) length) sequence[action.index] = action.oldValue;
+            });
         }
 
         void redo()
         {
-            if (history_manager.redo_stack.empty())
-            {
-                return;
-            }
-
-            // Get the last session from the redo stack
-            Session session = history_manager.redo_stack.top();
-            history_manager.redo_stack.pop();
-
-            // Add the session to the undo stack
-            history_manager.undo_stack.push(session);
-
-            // Process the actions in order
-            for (auto action = session.getActions().begin(); action != session.getActions().end(); ++action)
-            {
-                sequence[action->index] = action->newValue;
-            }
+            // The actions are processed in order
+            history_manager.redo([this](const Action &action) {
+                if (action.index < (int) length) sequence[action.index] = action.newValue;
+            });
         }
 
         int getWindowStart()
@@ -335,14 +328,16 @@ namespace vgLib_v2
 
         void copy(VoltageSequencer *src_sequence)
         {
-            // We will be replacing this code with the standardized copy/paste code
-            /*
-            this->sequence = src_sequence->sequence;
+            for (unsigned int i = 0; i < MAX_STEPS; i++)
+            {
+                this->sequence[i] = src_sequence->sequence[i];
+            }
+
+            this->length = src_sequence->length;
             this->window_start = src_sequence->window_start;
             this->window_end = src_sequence->window_end;
             this->snap_division = src_sequence->snap_division;
             this->sample_and_hold = src_sequence->sample_and_hold;
-            */
         }
     };
 
@@ -1,5 +1,35 @@
 #include <vector>
-#include <stack>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+
+//
+// VoltageSequencerHistory
+//
+// Undo and redo for sequencer edits.  Edits are grouped into sessions, such
+// as one mouse drag or one "randomize", and each session is undone as a whole.
+//
+// The history lives in a fixed-size ring of bytes, so it never grows no
+// matter how long the patch has been open.  When a new session doesn't fit,
+// the oldest sessions are forgotten to make room.  The size of the ring is
+// the undo budget, in bytes, and can be changed with setBudget().  The ring
+// isn't allocated until the first session is kept, so a module with many
+// sequencers only pays for the ones that are actually edited.
+//
+// Only the net change to each step is stored.  If a drag passes over the same
+// step fifty times, the session remembers the value before the drag and the
+// value after it, and steps that end up where they started aren't stored at
+// all.
+//
+// Each session is laid out in the ring as:
+//
+//   [ count ][ action ] ... [ action ][ count ]
+//
+// The count at both ends makes it possible to step over a session in either
+// direction.  Sessions between the tail and undo_head can be undone.  Those
+// between undo_head and redo_head have been undone and can be redone, until
+// a new session is pushed over them.
+//
 
 struct Action {
     int index;      // Sequencer step index
@@ -10,47 +40,71 @@ struct Action {
         : index(idx), oldValue(oldVal), newValue(newVal) {}
 };
 
-class Session {
-    std::vector<Action> actions;
+class HistoryManager
+{
+    public:
+
+    static const size_t DEFAULT_BUDGET = 32768;   // bytes
+
+    // Actions are packed into the ring as a 16 bit index and two floats
+    static const size_t ACTION_SIZE = sizeof(uint16_t) + (2 * sizeof(float));
+    static const size_t COUNT_SIZE = sizeof(uint32_t);
+
+    size_t budget = DEFAULT_BUDGET;
+    std::vector<uint8_t> ring;   // Empty until the first push()
+
+    // Positions in the ring only ever increase, and are wrapped when used
+    uint64_t tail = 0;
+    uint64_t undo_head = 0;
+    uint64_t redo_head = 0;
+
+    std::vector<Action> current_session;
+    bool session_open = false;
 
-public:
-    // Add an action to the session
-    void addAction(int index, float oldValue, float newValue) 
+    HistoryManager(size_t budget = DEFAULT_BUDGET)
     {
-        actions.emplace_back(index, oldValue, newValue);
+        setBudget(budget);
     }
 
-    // Get all actions in the session (for undo/redo purposes)
-    const std::vector<Action>& getActions() const 
+    // Change the size of the history.  This forgets everything in it.  A
+    // budget too small to hold even a one step session is rejected, and
+    // leaves the history as it was.
+    bool setBudget(size_t new_budget)
     {
-        return actions;
+        if (new_budget < sessionSize(1)) return(false);
+
+        budget = new_budget;
+        std::vector<uint8_t>().swap(ring);
+        clear();
+        return(true);
     }
 
-    // Check if the session is empty
-    bool isEmpty() const 
+    size_t getBudget()
     {
-        return actions.empty();
+        return(budget);
     }
 
-    // Clear the session
-    void clear() 
+    void clear()
     {
-        actions.clear();
+        tail = 0;
+        undo_head = 0;
+        redo_head = 0;
+        current_session.clear();
+        session_open = false;
     }
-};
 
-class HistoryManager 
-{
-    public:
-
-    std::stack<Session> undo_stack;
-    std::stack<Session> redo_stack;
-    Session current_session;
-    bool session_open = false;
+    bool canUndo()
+    {
+        return(undo_head > tail);
+    }
 
+    bool canRedo()
+    {
+        return(redo_head > undo_head);
+    }
 
     // Start a new session
-    void startSession() 
+    void startSession()
     {
         if (session_open) {
             endSession(); // Close any existing session first
@@ -59,56 +113,175 @@ class HistoryManager
         session_open = true;
     }
 
-    // End the current session and add it to the undo stack
-    void endSession() 
+    // End the current session and add it to the history
+    void endSession()
     {
-        if (!current_session.isEmpty()) 
+        // Steps that ended up back where they started don't need to be kept
+        size_t count = 0;
+
+        for (size_t i = 0; i < current_session.size(); i++)
         {
-            undo_stack.push(current_session);
-            current_session.clear();
+            if (current_session[i].oldValue != current_session[i].newValue)
+            {
+                current_session[count++] = current_session[i];
+            }
         }
+
+        current_session.erase(current_session.begin() + count, current_session.end());
+
+        if (count > 0)
+        {
+            push();
+        }
+
+        current_session.clear();
         session_open = false;
     }
 
     // Record an action in the current session
-    void recordAction(int index, float old_value, float new_value) 
+    void recordAction(int index, float old_value, float new_value)
     {
-        if (session_open) 
+        if (! session_open) return;
+
+        // Keep the first old value and the latest new value for each step
+        for (Action &action : current_session)
         {
-            current_session.addAction(index, old_value, new_value);
+            if (action.index == index)
+            {
+                action.newValue = new_value;
+                return;
+            }
         }
+
+        current_session.emplace_back(index, old_value, new_value);
     }
 
-    // Undo the last session
-    void undo() 
+    //
+    // undo(apply) and redo(apply)
+    //
+    // Move one session back or forward, calling apply(action) for each of its
+    // actions.  Undo visits them newest first, and redo oldest first.  Returns
+    // false if there was nothing to undo or redo.
+    //
+
+    template <typename Apply>
+    bool undo(Apply &&apply)
     {
-        if (!undo_stack.empty()) 
+        if (! canUndo()) return(false);
+
+        uint32_t count = readCount(undo_head - COUNT_SIZE);
+        uint64_t start = undo_head - sessionSize(count);
+
+        for (uint32_t i = count; i > 0; i--)
         {
-            Session lastSession = undo_stack.top();
-            undo_stack.pop();
+            apply(readAction(start + COUNT_SIZE + ((i - 1) * ACTION_SIZE)));
+        }
+
+        undo_head = start;
+        return(true);
+    }
 
-            // Here, you should apply the inverse of each action in lastSession
-            // to your VoltageSequencer instance
+    template <typename Apply>
+    bool redo(Apply &&apply)
+    {
+        if (! canRedo()) return(false);
+
+        uint32_t count = readCount(undo_head);
 
-            redo_stack.push(lastSession);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            apply(readAction(undo_head + COUNT_SIZE + (i * ACTION_SIZE)));
         }
+
+        undo_head += sessionSize(count);
+        return(true);
     }
 
-    // Redo the last undone session
-    // NOTE AND WARNING: This function is not called yet.  The undo is being
-    // done within the VoltageSequencer instead.
-    void redo() 
+    private:
+
+    static uint64_t sessionSize(uint32_t count)
     {
-        /*
-        if (!redo_stack.empty()) {
-            Session sessionToRedo = redo_stack.top();
-            redo_stack.pop();
+        return((2 * COUNT_SIZE) + (count * ACTION_SIZE));
+    }
+
+    void push()
+    {
+        uint32_t count = current_session.size();
+        uint64_t size = sessionSize(count);
+
+        // Anything that had been undone can no longer be redone
+        redo_head = undo_head;
 
-            // Here, reapply each action in sessionToRedo
-            // to your VoltageSequencer instance
+        // A session larger than the whole budget can't be kept at all
+        if (size > budget)
+        {
+            tail = undo_head = redo_head;
+            return;
+        }
+
+        if (ring.empty()) ring.assign(budget, 0);
 
-            undo_stack.push(sessionToRedo);
+        // Forget the oldest sessions until there's room
+        while ((redo_head + size) - tail > ring.size())
+        {
+            tail += sessionSize(readCount(tail));
+        }
+
+        uint64_t position = redo_head;
+
+        write(position, &count, COUNT_SIZE);
+        position += COUNT_SIZE;
+
+        for (const Action &action : current_session)
+        {
+            uint16_t index = action.index;
+            write(position, &index, sizeof(index));
+            write(position + sizeof(index), &action.oldValue, sizeof(float));
+            write(position + sizeof(index) + sizeof(float), &action.newValue, sizeof(float));
+            position += ACTION_SIZE;
         }
-        */
+
+        write(position, &count, COUNT_SIZE);
+
+        undo_head = redo_head = redo_head + size;
+    }
+
+    uint32_t readCount(uint64_t position)
+    {
+        uint32_t count;
+        read(position, &count, COUNT_SIZE);
+        return(count);
+    }
+
+    Action readAction(uint64_t position)
+    {
+        uint16_t index;
+        float old_value;
+        float new_value;
+
+        read(position, &index, sizeof(index));
+        read(position + sizeof(index), &old_value, sizeof(float));
+        read(position + sizeof(index) + sizeof(float), &new_value, sizeof(float));
+
+        return(Action(index, old_value, new_value));
+    }
+
+    // Copy bytes in and out of the ring, wrapping around its end
+    void write(uint64_t position, const void *source, size_t length)
+    {
+        size_t offset = position % ring.size();
+        size_t first = std::min(length, ring.size() - offset);
+
+        std::memcpy(&ring[offset], source, first);
+        std::memcpy(&ring[0], (const uint8_t *) source + first, length - first);
+    }
+
+    void read(uint64_t position, void *destination, size_t length)
+    {
+        size_t offset = position % ring.size();
+        size_t first = std::min(length, ring.size() - offset);
+
+        std::memcpy(destination, &ring[offset], first);
+        std::memcpy((uint8_t *) destination + first, &ring[0], length - first);
     }
 };
@@ -0,0 +1,61 @@
+// Context menu entry for editing a BytebeatExpressionSlot, shared by the
+// modules that have a custom expression.  The expression is recompiled as
+// it's typed, and only replaces the running one once it compiles.
+
+struct ExpressionTextField : TextField
+{
+    BytebeatExpressionSlot *expression_slot;
+    Label *status_label;
+
+    ExpressionTextField()
+    {
+        this->box.pos.x = 0;
+        this->box.size.x = 300;
+        this->multiline = false;
+    }
+
+    void onChange(const event::Change &e) override
+    {
+        if (expression_slot->setExpression(text))
+        {
+            status_label->text = "OK";
+        }
+        else
+        {
+            status_label->text = expression_slot->error;
+        }
+    };
+};
+
+struct ExpressionMenu : MenuItem
+{
+    BytebeatExpressionSlot *expression_slot;
+    std::string description = "Variables: t p1 p2 p3";
+
+    Menu *createChildMenu() override
+    {
+        Menu *menu = new Menu;
+
+        menu->addChild(createMenuLabel(description));
+
+        auto holder = new rack::Widget;
+        holder->box.size.x = 300;
+        holder->box.size.y = 20;
+
+        auto status_label = new rack::Label;
+
+        auto textfield = new ExpressionTextField();
+        textfield->expression_slot = expression_slot;
+        textfield->status_label = status_label;
+        textfield->text = expression_slot->expression;
+        holder->addChild(textfield);
+
+        menu->addChild(holder);
+
+        status_label->box.size.x = 300;
+        status_label->text = expression_slot->error.empty() ? "OK" : expression_slot->error;
+        menu->addChild(status_label);
+
+        return menu;
+    }
+};
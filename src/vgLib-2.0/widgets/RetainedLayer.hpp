@@ -0,0 +1,96 @@
+#pragma once
+#include <rack.hpp>
+#include <functional>
+
+using namespace rack;
+
+//
+// RetainedLayer
+//
+// Keeps the static part of a display, such as a sequencer's bars or an LCD's
+// labels, in an offscreen framebuffer so that it doesn't have to be rebuilt
+// with nanovg paths on every frame.  Only the parts that move, like the
+// playhead, need to be drawn live on top of it.
+//
+// The owner describes everything that the static part depends on with a
+// RetainedLayerKey, and passes it to update() before drawing.  The layer is
+// only rendered again when the key changes (or when the zoom level changes,
+// which the framebuffer already takes care of).
+//
+// A RetainedLayer is added as a child of the display it belongs to, but it
+// doesn't draw itself.  The display calls drawRetained() from its own
+// drawLayer(), at the point where the static part should appear.  This keeps
+// it in the light layer (layer 1) with the rest of the display, which a plain
+// FramebufferWidget wouldn't do.
+//
+
+struct RetainedLayerKey
+{
+    uint64_t hash = 14695981039346656037ULL;
+
+    template <typename T>
+    void add(const T &value)
+    {
+        const unsigned char *bytes = (const unsigned char *) &value;
+        for (size_t i = 0; i < sizeof(T); i++)
+        {
+            hash = (hash ^ bytes[i]) * 1099511628211ULL;
+        }
+    }
+
+    void add(const std::string &text)
+    {
+        add(text.size());
+        for (unsigned char character : text)
+        {
+            hash = (hash ^ character) * 1099511628211ULL;
+        }
+    }
+};
+
+struct RetainedLayer : widget::FramebufferWidget
+{
+    // Paints the static part of the display into the framebuffer
+    struct Content : widget::Widget
+    {
+        std::function<void(NVGcontext *vg)> paint;
+
+        void draw(const DrawArgs &args) override
+        {
+            if (paint) paint(args.vg);
+        }
+    };
+
+    Content *content;
+    uint64_t key = 0;
+    bool has_key = false;
+
+    RetainedLayer(Vec size, std::function<void(NVGcontext *vg)> paint)
+    {
+        box.size = size;
+
+        content = new Content;
+        content->box.size = size;
+        content->paint = paint;
+        addChild(content);
+    }
+
+    void update(const RetainedLayerKey &new_key)
+    {
+        if (has_key && (new_key.hash == key)) return;
+
+        key = new_key.hash;
+        has_key = true;
+        setDirty();
+    }
+
+    void drawRetained(const DrawArgs &args)
+    {
+        FramebufferWidget::draw(args);
+    }
+
+    // Drawn only through drawRetained()
+    void draw(const DrawArgs &args) override
+    {
+    }
+};
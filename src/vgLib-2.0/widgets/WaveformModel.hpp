@@ -10,6 +10,9 @@ struct WaveformModel
     float playback_percentage = 0.0f;  // Keep for compatibility. Remove after updating autobreak.
     unsigned int playhead_position = 0;  // Changed from percentage to position
     bool scrubber_dragging = false;
+
+    // Written by the audio thread, and read by the widget once per frame
+    TelemetryChannel<unsigned int> playhead_telemetry;
    
     // Optional section highlighting
     bool highlight_section = false;
@@ -35,7 +38,17 @@ struct WaveformModel
         marker_positions.clear();
     }
    
+    // Called from the audio thread, every sample if need be.  The position
+    // reaches the display the next time the widget calls pollPlayheadPosition().
     void updatePlayheadPosition(unsigned int position) {
+        playhead_telemetry.process(position);
+    }
+
+    // Called from the widget's step()
+    void pollPlayheadPosition() {
+        unsigned int position;
+        if (! playhead_telemetry.read(position)) return;
+
         if (position != playhead_position) {
             playhead_position = position;
             playback_percentage = sample ? 
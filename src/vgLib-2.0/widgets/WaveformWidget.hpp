@@ -48,12 +48,7 @@ struct WaveformWidget : TransparentWidget
         sample_filename = waveform_model->sample->filename;
 
         // Use horizontal padding for width calculation
-        averages.reserve((unsigned int)(width - (container_padding_left + container_padding_right)));
-
-        for (unsigned int i = 0; i < width - (container_padding_left + container_padding_right); i++)
-        {
-            averages[i] = 0.0;
-        }
+        averages.assign((unsigned int)(width - (container_padding_left + container_padding_right)), 0.0);
     }
 
     // Constructor with position
@@ -68,12 +63,7 @@ struct WaveformWidget : TransparentWidget
 
         sample_filename = waveform_model->sample->filename;
 
-        averages.reserve((unsigned int)(width - (container_padding_left + container_padding_right)));
-
-        for (unsigned int i = 0; i < width - (container_padding_left + container_padding_right); i++)
-        {
-            averages[i] = 0.0;
-        }
+        averages.assign((unsigned int)(width - (container_padding_left + container_padding_right)), 0.0);
     }
 
     void drawLayer(const DrawArgs &args, int layer) override
@@ -87,17 +77,21 @@ struct WaveformWidget : TransparentWidget
             if (draw_container_background)
                 drawContainerBackground(vg);
 
-            if (waveform_model->sample && waveform_model->sample->loaded)
+            // The waveform can be drawn from cached peaks before the audio
+            // has loaded, but everything on top of it needs the audio
+            unsigned int display_length = waveform_model->sample ? waveform_model->sample->getDisplayLength() : 0;
+
+            if (display_length > 0)
             {
                 if (refresh)
                 {
                     max_average = 0.0;
 
-                    if (waveform_model->sample->size() > (width - (container_padding_left + container_padding_right)))
+                    if (display_length > (width - (container_padding_left + container_padding_right)))
                     {
                         for (unsigned int x = 0; x < (width - (container_padding_left + container_padding_right)); x++)
                         {
-                            computeAverages(x, waveform_model->sample->size());
+                            computeAverages(x, display_length);
                         }
                     }
 
@@ -105,7 +99,10 @@ struct WaveformWidget : TransparentWidget
                 }
 
                 drawWaveform(vg);
+            }
 
+            if (waveform_model->sample && waveform_model->sample->loaded)
+            {
                 if (waveform_model->draw_position_indicator)
                     drawPositionIndicator(vg);
                 if (waveform_model->highlight_section)
@@ -122,6 +119,8 @@ struct WaveformWidget : TransparentWidget
     {
         TransparentWidget::step();
 
+        waveform_model->pollPlayheadPosition();
+
         if (sample_filename != waveform_model->sample->filename)
         {
             sample_filename = waveform_model->sample->filename;
@@ -140,31 +139,13 @@ struct WaveformWidget : TransparentWidget
 
     void computeAverages(unsigned int x, unsigned int sample_size)
     {
-        float left_sum = 0.0;
-        float right_sum = 0.0;
-        unsigned int count = 0;
-
-        float left, right;
-
         float chunk_size = (float)sample_size / (float)(width - (container_padding_left + container_padding_right));
         unsigned int chunk_start = (x * chunk_size);
         unsigned int chunk_end = chunk_start + chunk_size;
 
-        for (unsigned int i = chunk_start; i < chunk_end; i++)
-        {
-            if (i < sample_size)
-            {
-                waveform_model->sample->read(i, &left, &right);
-                left_sum += std::abs(left);
-                right_sum += std::abs(right);
-                count++;
-            }
-        }
-
-        float left_average = left_sum / (float)count;
-        float right_average = right_sum / (float)count;
-
-        averages[x] = (left_average + right_average) / 2.0;
+        // The sample's peak pyramid answers this in a few lookups instead of
+        // a scan over every frame in the chunk.
+        averages[x] = waveform_model->sample->readPeaks(chunk_start, chunk_end).mean_abs;
 
         if (averages[x] > max_average)
             max_average = clamp(averages[x], 0.0, 1.0);
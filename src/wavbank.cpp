@@ -17,6 +17,7 @@
 
 #include "vgLib-2.0/components/VoxglitchComponents.hpp"
 #include "vgLib-2.0/SamplePlayer.hpp"
+#include "vgLib-2.0/LazySampleBank.hpp"
 
 using namespace vgLib_v2;
 
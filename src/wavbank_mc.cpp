@@ -13,6 +13,7 @@
 
 #include "vgLib-2.0/components/VoxglitchComponents.hpp"
 #include "vgLib-2.0/sample_mc.hpp"
+#include "vgLib-2.0/LazySampleBank.hpp"
 
 using namespace vgLib_v2;
 